@@ -2,26 +2,30 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
-// The code in GetErrorMessage can't handle some systems having the
-// GNU version of strerror_r and other systems having the XSI version,
-// so we undefine _GNU_SOURCE here in an attempt to always get the XSI version.
-// We include cstring before all other headers in case cstring is included
-// indirectly (without undefining _GNU_SOURCE) by some other header.
-#ifdef _GNU_SOURCE
-#undef _GNU_SOURCE
-#include <cstring>
-#define _GNU_SOURCE
-#else
-#include <cstring>
-#endif
-
 #include <cstddef>
+#include <cstring>
 #include <errno.h>
 
 #include "Common/CommonFuncs.h"
 
 #ifdef _WIN32
 #include <windows.h>
+#else
+namespace
+{
+// glibc provides the GNU version of strerror_r (returns char*) whenever _GNU_SOURCE is defined,
+// which g++ always does, and other C libraries provide the XSI version (returns int). Overloading
+// on the return type handles both without depending on the include order.
+inline const char* StrErrorResult(int result, const char* buffer)
+{
+  return result == 0 ? buffer : nullptr;
+}
+
+inline const char* StrErrorResult(const char* result, const char* buffer)
+{
+  return result;
+}
+}  // Anonymous namespace
 #endif
 
 // Generic function to get last error message.
@@ -35,14 +39,11 @@ std::string GetLastErrorMsg()
 #ifdef _WIN32
   FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM, nullptr, GetLastError(),
                  MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), err_str, buff_size, nullptr);
+  return std::string(err_str);
 #else
-  // We assume that the XSI-compliant version of strerror_r (returns int) is used
-  // rather than the GNU version (returns char*). The returned value is stored to
-  // an int variable to get a compile-time check that the return type is not char*.
-  const int result = strerror_r(errno, err_str, buff_size);
-  if (result != 0)
+  const char* result = StrErrorResult(strerror_r(errno, err_str, buff_size), err_str);
+  if (!result)
     return "";
+  return std::string(result);
 #endif
-
-  return std::string(err_str);
 }
@@ -2,18 +2,39 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
 #include <mbedtls/aes.h>
+#include <thread>
 
+#include "Common/CPUDetect.h"
 #include "Common/Crypto/AES.h"
+#include "Common/Intrinsics.h"
+#include "Common/Thread.h"
+
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
 
 namespace Common
 {
 namespace AES
 {
-std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size, Mode mode)
+namespace
+{
+constexpr size_t BLOCK_SIZE = 16;
+constexpr size_t ROUND_KEY_COUNT = 11;
+
+// Decrypting a buffer on several threads only pays off for pieces of at least this size.
+constexpr size_t PARALLEL_CHUNK_SIZE = 1024 * 1024;
+constexpr unsigned int MAX_THREADS = 8;
+
+void CryptMbedTLS(const u8* key, u8* iv, const u8* src, u8* dst, size_t size, Mode mode)
 {
   mbedtls_aes_context aes_ctx;
-  std::vector<u8> buffer(size);
+  mbedtls_aes_init(&aes_ctx);
 
   if (mode == Mode::Encrypt)
     mbedtls_aes_setkey_enc(&aes_ctx, key, 128);
@@ -21,8 +42,255 @@ std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size
     mbedtls_aes_setkey_dec(&aes_ctx, key, 128);
 
   mbedtls_aes_crypt_cbc(&aes_ctx, mode == Mode::Encrypt ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT,
-                        size, iv, src, buffer.data());
+                        size, iv, src, dst);
+
+  mbedtls_aes_free(&aes_ctx);
+}
+
+#ifdef _M_X86_64
+FUNCTION_TARGET_AES __m128i ExpandKeyStep(__m128i key, __m128i generated)
+{
+  generated = _mm_shuffle_epi32(generated, 0xff);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, generated);
+}
+
+FUNCTION_TARGET_AES void ExpandKeyAESNI(const u8* key, __m128i* keys)
+{
+  // The round constants have to be immediates.
+  keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+  keys[1] = ExpandKeyStep(keys[0], _mm_aeskeygenassist_si128(keys[0], 0x01));
+  keys[2] = ExpandKeyStep(keys[1], _mm_aeskeygenassist_si128(keys[1], 0x02));
+  keys[3] = ExpandKeyStep(keys[2], _mm_aeskeygenassist_si128(keys[2], 0x04));
+  keys[4] = ExpandKeyStep(keys[3], _mm_aeskeygenassist_si128(keys[3], 0x08));
+  keys[5] = ExpandKeyStep(keys[4], _mm_aeskeygenassist_si128(keys[4], 0x10));
+  keys[6] = ExpandKeyStep(keys[5], _mm_aeskeygenassist_si128(keys[5], 0x20));
+  keys[7] = ExpandKeyStep(keys[6], _mm_aeskeygenassist_si128(keys[6], 0x40));
+  keys[8] = ExpandKeyStep(keys[7], _mm_aeskeygenassist_si128(keys[7], 0x80));
+  keys[9] = ExpandKeyStep(keys[8], _mm_aeskeygenassist_si128(keys[8], 0x1b));
+  keys[10] = ExpandKeyStep(keys[9], _mm_aeskeygenassist_si128(keys[9], 0x36));
+}
+
+FUNCTION_TARGET_AES void CryptAESNI(const u8* key, u8* iv, const u8* src, u8* dst, size_t size,
+                                    Mode mode)
+{
+  __m128i keys[ROUND_KEY_COUNT];
+  ExpandKeyAESNI(key, keys);
+
+  const auto load = [](const u8* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  };
+  const auto store = [](u8* p, __m128i v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+  };
+
+  const size_t blocks = size / BLOCK_SIZE;
+  __m128i chain = load(iv);
+  if (mode == Mode::Encrypt)
+  {
+    for (size_t i = 0; i < blocks; ++i)
+    {
+      __m128i block = _mm_xor_si128(_mm_xor_si128(load(src + i * BLOCK_SIZE), chain), keys[0]);
+      for (size_t round = 1; round < ROUND_KEY_COUNT - 1; ++round)
+        block = _mm_aesenc_si128(block, keys[round]);
+      chain = _mm_aesenclast_si128(block, keys[ROUND_KEY_COUNT - 1]);
+      store(dst + i * BLOCK_SIZE, chain);
+    }
+    store(iv, chain);
+    return;
+  }
+
+  // The equivalent inverse cipher uses the round keys backwards, with InvMixColumns applied to
+  // all but the first and the last.
+  __m128i decryption_keys[ROUND_KEY_COUNT];
+  decryption_keys[0] = keys[ROUND_KEY_COUNT - 1];
+  for (size_t round = 1; round < ROUND_KEY_COUNT - 1; ++round)
+    decryption_keys[round] = _mm_aesimc_si128(keys[ROUND_KEY_COUNT - 1 - round]);
+  decryption_keys[ROUND_KEY_COUNT - 1] = keys[0];
+
+  // Blocks don't depend on each other when decrypting, so several are in flight at a time.
+  constexpr size_t INTERLEAVE = 4;
+  size_t i = 0;
+  for (; i + INTERLEAVE <= blocks; i += INTERLEAVE)
+  {
+    __m128i input[INTERLEAVE];
+    __m128i block[INTERLEAVE];
+    for (size_t j = 0; j < INTERLEAVE; ++j)
+    {
+      input[j] = load(src + (i + j) * BLOCK_SIZE);
+      block[j] = _mm_xor_si128(input[j], decryption_keys[0]);
+    }
+    for (size_t round = 1; round < ROUND_KEY_COUNT - 1; ++round)
+    {
+      for (size_t j = 0; j < INTERLEAVE; ++j)
+        block[j] = _mm_aesdec_si128(block[j], decryption_keys[round]);
+    }
+    for (size_t j = 0; j < INTERLEAVE; ++j)
+    {
+      block[j] = _mm_aesdeclast_si128(block[j], decryption_keys[ROUND_KEY_COUNT - 1]);
+      store(dst + (i + j) * BLOCK_SIZE, _mm_xor_si128(block[j], j == 0 ? chain : input[j - 1]));
+    }
+    chain = input[INTERLEAVE - 1];
+  }
+  for (; i < blocks; ++i)
+  {
+    const __m128i input = load(src + i * BLOCK_SIZE);
+    __m128i block = _mm_xor_si128(input, decryption_keys[0]);
+    for (size_t round = 1; round < ROUND_KEY_COUNT - 1; ++round)
+      block = _mm_aesdec_si128(block, decryption_keys[round]);
+    block = _mm_aesdeclast_si128(block, decryption_keys[ROUND_KEY_COUNT - 1]);
+    store(dst + i * BLOCK_SIZE, _mm_xor_si128(block, chain));
+    chain = input;
+  }
+  store(iv, chain);
+}
+#endif
+
+#ifdef _M_ARM_64
+u32 SubWord(u32 word)
+{
+  // With the same word in every column, ShiftRows doesn't move anything, so AESE with a zero
+  // round key is just SubBytes.
+  const uint8x16_t state = vreinterpretq_u8_u32(vdupq_n_u32(word));
+  return vgetq_lane_u32(vreinterpretq_u32_u8(vaeseq_u8(state, vdupq_n_u8(0))), 0);
+}
+
+void ExpandKeyARMv8(const u8* key, uint8x16_t* keys)
+{
+  static constexpr u8 round_constants[] = {0x01, 0x02, 0x04, 0x08, 0x10,
+                                           0x20, 0x40, 0x80, 0x1b, 0x36};
+  // The words are in memory order, so RotWord is a rotation to the right.
+  u32 words[ROUND_KEY_COUNT * 4];
+  std::memcpy(words, key, BLOCK_SIZE);
+  for (size_t i = 4; i < ROUND_KEY_COUNT * 4; ++i)
+  {
+    u32 temp = words[i - 1];
+    if (i % 4 == 0)
+      temp = SubWord((temp >> 8) | (temp << 24)) ^ round_constants[i / 4 - 1];
+    words[i] = words[i - 4] ^ temp;
+  }
+  for (size_t round = 0; round < ROUND_KEY_COUNT; ++round)
+    keys[round] = vreinterpretq_u8_u32(vld1q_u32(&words[round * 4]));
+}
 
+void CryptARMv8(const u8* key, u8* iv, const u8* src, u8* dst, size_t size, Mode mode)
+{
+  uint8x16_t keys[ROUND_KEY_COUNT];
+  ExpandKeyARMv8(key, keys);
+
+  const size_t blocks = size / BLOCK_SIZE;
+  uint8x16_t chain = vld1q_u8(iv);
+  if (mode == Mode::Encrypt)
+  {
+    for (size_t i = 0; i < blocks; ++i)
+    {
+      uint8x16_t block = veorq_u8(vld1q_u8(src + i * BLOCK_SIZE), chain);
+      for (size_t round = 0; round < ROUND_KEY_COUNT - 2; ++round)
+        block = vaesmcq_u8(vaeseq_u8(block, keys[round]));
+      block = vaeseq_u8(block, keys[ROUND_KEY_COUNT - 2]);
+      chain = veorq_u8(block, keys[ROUND_KEY_COUNT - 1]);
+      vst1q_u8(dst + i * BLOCK_SIZE, chain);
+    }
+    vst1q_u8(iv, chain);
+    return;
+  }
+
+  // The equivalent inverse cipher uses the round keys backwards, with InvMixColumns applied to
+  // all but the first and the last.
+  uint8x16_t decryption_keys[ROUND_KEY_COUNT];
+  decryption_keys[0] = keys[ROUND_KEY_COUNT - 1];
+  for (size_t round = 1; round < ROUND_KEY_COUNT - 1; ++round)
+    decryption_keys[round] = vaesimcq_u8(keys[ROUND_KEY_COUNT - 1 - round]);
+  decryption_keys[ROUND_KEY_COUNT - 1] = keys[0];
+
+  for (size_t i = 0; i < blocks; ++i)
+  {
+    const uint8x16_t input = vld1q_u8(src + i * BLOCK_SIZE);
+    uint8x16_t block = input;
+    for (size_t round = 0; round < ROUND_KEY_COUNT - 2; ++round)
+      block = vaesimcq_u8(vaesdq_u8(block, decryption_keys[round]));
+    block = vaesdq_u8(block, decryption_keys[ROUND_KEY_COUNT - 2]);
+    block = veorq_u8(block, decryption_keys[ROUND_KEY_COUNT - 1]);
+    vst1q_u8(dst + i * BLOCK_SIZE, veorq_u8(block, chain));
+    chain = input;
+  }
+  vst1q_u8(iv, chain);
+}
+#endif
+
+using CryptFunction = void (*)(const u8* key, u8* iv, const u8* src, u8* dst, size_t size,
+                               Mode mode);
+
+CryptFunction GetCryptFunction()
+{
+#if defined(_M_X86_64)
+  if (cpu_info.bAES)
+    return CryptAESNI;
+#elif defined(_M_ARM_64)
+  if (cpu_info.bAES)
+    return CryptARMv8;
+#endif
+  return CryptMbedTLS;
+}
+
+void Crypt(const u8* key, u8* iv, const u8* src, u8* dst, size_t size, Mode mode)
+{
+  static const CryptFunction crypt = GetCryptFunction();
+  crypt(key, iv, src, dst, size, mode);
+}
+
+// Calls function with every index below count, on up to max_threads threads.
+void ParallelFor(size_t count, size_t max_threads, const std::function<void(size_t)>& function)
+{
+  const size_t thread_count = std::min<size_t>(
+      {std::max(1u, std::thread::hardware_concurrency()), max_threads, count});
+  std::atomic<size_t> next{0};
+  const auto work = [&] {
+    for (size_t i = next++; i < count; i = next++)
+      function(i);
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < thread_count; ++i)
+  {
+    workers.emplace_back([&work] {
+      Common::SetCurrentThreadName("AES worker");
+      work();
+    });
+  }
+  work();
+  for (std::thread& worker : workers)
+    worker.join();
+}
+}  // Anonymous namespace
+
+std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size, Mode mode)
+{
+  std::vector<u8> buffer(size);
+  // Like mbedtls, leave everything alone if the size isn't a multiple of the block size.
+  if (size % BLOCK_SIZE != 0)
+    return buffer;
+
+  // When decrypting, every block only depends on the block before it in the ciphertext, so the
+  // buffer can be split in chunks which are decrypted independently.
+  if (mode == Mode::Decrypt && size >= 2 * PARALLEL_CHUNK_SIZE)
+  {
+    std::vector<BatchEntry> chunks;
+    for (size_t offset = 0; offset < size; offset += PARALLEL_CHUNK_SIZE)
+    {
+      BatchEntry chunk{src + offset, buffer.data() + offset,
+                       std::min(PARALLEL_CHUNK_SIZE, size - offset)};
+      std::memcpy(chunk.iv.data(), offset == 0 ? iv : src + offset - BLOCK_SIZE, BLOCK_SIZE);
+      chunks.push_back(chunk);
+    }
+    DecryptEncryptBatch(key, &chunks, mode);
+    std::memcpy(iv, chunks.back().iv.data(), BLOCK_SIZE);
+    return buffer;
+  }
+
+  Crypt(key, iv, src, buffer.data(), size, mode);
   return buffer;
 }
 
@@ -35,5 +303,19 @@ std::vector<u8> Encrypt(const u8* key, u8* iv, const u8* src, size_t size)
 {
   return DecryptEncrypt(key, iv, src, size, Mode::Encrypt);
 }
+
+void DecryptEncryptBatch(const u8* key, std::vector<BatchEntry>* entries, Mode mode)
+{
+  size_t total_size = 0;
+  for (const BatchEntry& entry : *entries)
+    total_size += entry.size;
+  const size_t max_threads =
+      std::min<size_t>(MAX_THREADS, std::max<size_t>(1, total_size / PARALLEL_CHUNK_SIZE));
+
+  ParallelFor(entries->size(), max_threads, [&](size_t i) {
+    BatchEntry& entry = (*entries)[i];
+    Crypt(key, entry.iv.data(), entry.src, entry.dst, entry.size, mode);
+  });
+}
 }  // namespace AES
 }  // namespace Common
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <vector>
 
@@ -18,10 +19,27 @@ enum class Mode
   Decrypt,
   Encrypt,
 };
+
+// AES-128-CBC. Uses the AES instructions of the CPU when it has them (AES-NI on x86-64, the ARMv8
+// crypto extensions on AArch64), and mbedtls otherwise. Big buffers are decrypted on several
+// threads. Like with mbedtls, iv is updated so that it can be used to continue the stream.
 std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size, Mode mode);
 
 // Convenience functions
 std::vector<u8> Decrypt(const u8* key, u8* iv, const u8* src, size_t size);
 std::vector<u8> Encrypt(const u8* key, u8* iv, const u8* src, size_t size);
+
+// A buffer of a batch, with its own IV. size must be a multiple of the block size.
+struct BatchEntry
+{
+  const u8* src;
+  u8* dst;
+  size_t size;
+  std::array<u8, 16> iv;
+};
+
+// Processes independent buffers which use the same key, such as the contents of a title, at the
+// same time on several threads.
+void DecryptEncryptBatch(const u8* key, std::vector<BatchEntry>* entries, Mode mode);
 }  // namespace AES
 }  // namespace Common
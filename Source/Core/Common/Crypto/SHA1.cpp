@@ -0,0 +1,188 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/Crypto/SHA1.h"
+
+#include <array>
+#include <cstring>
+#include <utility>
+#include <mbedtls/sha1.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
+#include "Common/Swap.h"
+
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
+namespace Common
+{
+namespace SHA1
+{
+namespace
+{
+constexpr size_t BLOCK_SIZE = 64;
+
+using State = std::array<u32, 5>;
+
+#ifdef _M_X86_64
+// Four of the 80 rounds. The groups are unrolled at compile time, because the round function
+// is an immediate and the message words have to stay in registers.
+template <int G>
+FUNCTION_TARGET_SHA inline void RoundsSHANI(__m128i* abcd, __m128i* abcd_previous, __m128i* e,
+                                            __m128i* message)
+{
+  // message[k % 4] holds the words of group k.
+  if (G >= 4)
+  {
+    message[G % 4] = _mm_sha1msg2_epu32(
+        _mm_xor_si128(_mm_sha1msg1_epu32(message[G % 4], message[(G + 1) % 4]),
+                      message[(G + 2) % 4]),
+        message[(G + 3) % 4]);
+  }
+  if (G > 0)
+    *e = _mm_sha1nexte_epu32(*abcd_previous, message[G % 4]);
+  *abcd_previous = *abcd;
+  *abcd = _mm_sha1rnds4_epu32(*abcd, *e, G / 5);
+}
+
+template <size_t... G>
+FUNCTION_TARGET_SHA inline void AllRoundsSHANI(std::index_sequence<G...>, __m128i* abcd,
+                                               __m128i* abcd_previous, __m128i* e,
+                                               __m128i* message)
+{
+  // The elements of a braced list are evaluated in order.
+  const int expand[] = {(RoundsSHANI<G>(abcd, abcd_previous, e, message), 0)...};
+  static_cast<void>(expand);
+}
+
+FUNCTION_TARGET_SHA void ProcessBlocksSHANI(State* state, const u8* data, size_t blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  const __m128i state_abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state->data()));
+  __m128i abcd = _mm_shuffle_epi32(state_abcd, 0x1b);
+  __m128i e0 = _mm_set_epi32(static_cast<int>((*state)[4]), 0, 0, 0);
+
+  for (; blocks > 0; --blocks, data += BLOCK_SIZE)
+  {
+    const __m128i abcd_save = abcd;
+    const __m128i e0_save = e0;
+
+    __m128i message[4];
+    for (int i = 0; i < 4; ++i)
+    {
+      message[i] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)), byte_swap);
+    }
+
+    __m128i e = _mm_add_epi32(e0, message[0]);
+    __m128i abcd_previous;
+    AllRoundsSHANI(std::make_index_sequence<20>(), &abcd, &abcd_previous, &e, message);
+
+    e0 = _mm_sha1nexte_epu32(abcd_previous, e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state->data()), _mm_shuffle_epi32(abcd, 0x1b));
+  (*state)[4] = static_cast<u32>(_mm_extract_epi32(e0, 3));
+}
+#endif
+
+#ifdef _M_ARM_64
+void ProcessBlocksARMv8(State* state, const u8* data, size_t blocks)
+{
+  const uint32x4_t constants[] = {vdupq_n_u32(0x5a827999), vdupq_n_u32(0x6ed9eba1),
+                                  vdupq_n_u32(0x8f1bbcdc), vdupq_n_u32(0xca62c1d6)};
+  uint32x4_t abcd = vld1q_u32(state->data());
+  u32 e0 = (*state)[4];
+
+  for (; blocks > 0; --blocks, data += BLOCK_SIZE)
+  {
+    const uint32x4_t abcd_save = abcd;
+    const u32 e0_save = e0;
+
+    // message[k % 4] holds the words of group k.
+    uint32x4_t message[4];
+    for (int i = 0; i < 4; ++i)
+      message[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+
+    u32 e = e0;
+    for (int g = 0; g < 20; ++g)
+    {
+      if (g >= 4)
+      {
+        message[g % 4] = vsha1su1q_u32(
+            vsha1su0q_u32(message[g % 4], message[(g + 1) % 4], message[(g + 2) % 4]),
+            message[(g + 3) % 4]);
+      }
+      const uint32x4_t words = vaddq_u32(message[g % 4], constants[g / 5]);
+      const u32 e_next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      if (g < 5)
+        abcd = vsha1cq_u32(abcd, e, words);
+      else if (g < 10 || g >= 15)
+        abcd = vsha1pq_u32(abcd, e, words);
+      else
+        abcd = vsha1mq_u32(abcd, e, words);
+      e = e_next;
+    }
+
+    e0 = e + e0_save;
+    abcd = vaddq_u32(abcd, abcd_save);
+  }
+
+  vst1q_u32(state->data(), abcd);
+  (*state)[4] = e0;
+}
+#endif
+
+using ProcessBlocksFunction = void (*)(State* state, const u8* data, size_t blocks);
+
+ProcessBlocksFunction GetAcceleratedFunction()
+{
+#if defined(_M_X86_64)
+  if (cpu_info.bSHA1 && cpu_info.bSSE4_1)
+    return ProcessBlocksSHANI;
+#elif defined(_M_ARM_64)
+  if (cpu_info.bSHA1)
+    return ProcessBlocksARMv8;
+#endif
+  return nullptr;
+}
+}  // Anonymous namespace
+
+Digest CalculateDigest(const u8* data, size_t size)
+{
+  static const ProcessBlocksFunction process_blocks = GetAcceleratedFunction();
+
+  Digest digest;
+  if (!process_blocks)
+  {
+    mbedtls_sha1(data, size, digest.data());
+    return digest;
+  }
+
+  State state = {{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0}};
+  const size_t full_blocks = size / BLOCK_SIZE;
+  process_blocks(&state, data, full_blocks);
+
+  // The rest of the data, the end marker and the length in bits take one or two more blocks.
+  std::array<u8, 2 * BLOCK_SIZE> tail{};
+  const size_t rest = size % BLOCK_SIZE;
+  std::memcpy(tail.data(), data + full_blocks * BLOCK_SIZE, rest);
+  tail[rest] = 0x80;
+  const size_t tail_size = rest + 1 + sizeof(u64) <= BLOCK_SIZE ? BLOCK_SIZE : 2 * BLOCK_SIZE;
+  const u64 bit_count = Common::swap64(static_cast<u64>(size) * 8);
+  std::memcpy(&tail[tail_size - sizeof(u64)], &bit_count, sizeof(u64));
+  process_blocks(&state, tail.data(), tail_size / BLOCK_SIZE);
+
+  for (size_t i = 0; i < state.size(); ++i)
+  {
+    const u32 word = Common::swap32(state[i]);
+    std::memcpy(&digest[i * sizeof(u32)], &word, sizeof(u32));
+  }
+  return digest;
+}
+}  // namespace SHA1
+}  // namespace Common
@@ -0,0 +1,22 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+namespace SHA1
+{
+using Digest = std::array<u8, 20>;
+
+// Uses the SHA instructions of the CPU when it has them (SHA-NI on x86-64, the ARMv8 crypto
+// extensions on AArch64), and mbedtls otherwise.
+Digest CalculateDigest(const u8* data, size_t size);
+}  // namespace SHA1
+}  // namespace Common
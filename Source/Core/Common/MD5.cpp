@@ -2,17 +2,128 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <mbedtls/md5.h>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Common/MD5.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "DiscIO/Blob.h"
 
 namespace MD5
 {
+namespace
+{
+using Hash = std::array<u8, 16>;
+
+// Leaves and inner nodes are hashed with different prefixes, so that a node can't be passed off
+// as the data of a chunk.
+constexpr u8 LEAF_PREFIX = 0;
+constexpr u8 NODE_PREFIX = 1;
+
+constexpr unsigned int MAX_TREE_THREADS = 8;
+
+std::string HashToString(const Hash& hash)
+{
+  std::string output_string;
+  for (u8 n : hash)
+    output_string += StringFromFormat("%02x", n);
+  return output_string;
+}
+
+Hash HashNode(const Hash& left, const Hash& right)
+{
+  mbedtls_md5_context ctx;
+  mbedtls_md5_init(&ctx);
+  mbedtls_md5_starts(&ctx);
+  mbedtls_md5_update(&ctx, &NODE_PREFIX, 1);
+  mbedtls_md5_update(&ctx, left.data(), left.size());
+  mbedtls_md5_update(&ctx, right.data(), right.size());
+
+  Hash output;
+  mbedtls_md5_finish(&ctx, output.data());
+  mbedtls_md5_free(&ctx);
+  return output;
+}
+
+// Pairs up the nodes of each level until one is left. An odd node at the end of a level is moved
+// up unchanged.
+Hash HashTree(std::vector<Hash> level)
+{
+  while (level.size() > 1)
+  {
+    std::vector<Hash> next_level;
+    next_level.reserve((level.size() + 1) / 2);
+    for (size_t i = 0; i + 1 < level.size(); i += 2)
+      next_level.push_back(HashNode(level[i], level[i + 1]));
+    if (level.size() % 2)
+      next_level.push_back(level.back());
+    level = std::move(next_level);
+  }
+  return level.front();
+}
+
+struct TreeJob
+{
+  std::string file_path;
+  u64 data_size;
+  std::vector<Hash> leaves;
+  std::atomic<u64> next_chunk{0};
+  std::atomic<u64> chunks_done{0};
+  std::atomic<bool> stop{false};
+  std::atomic<bool> failed{false};
+};
+
+// Every worker has its own reader, so that compressed formats are also decompressed in parallel.
+void HashChunks(TreeJob* job, const std::function<void()>& chunk_done)
+{
+  std::unique_ptr<DiscIO::BlobReader> file(DiscIO::CreateBlobReader(job->file_path));
+  if (!file)
+  {
+    job->failed = true;
+    job->stop = true;
+    return;
+  }
+
+  std::vector<u8> data(TREE_CHUNK_SIZE);
+  while (!job->stop)
+  {
+    const u64 chunk = job->next_chunk++;
+    if (chunk >= job->leaves.size())
+      return;
+
+    const u64 offset = chunk * TREE_CHUNK_SIZE;
+    const size_t size = static_cast<size_t>(std::min(TREE_CHUNK_SIZE, job->data_size - offset));
+    if (!file->Read(offset, size, data.data()))
+    {
+      job->failed = true;
+      job->stop = true;
+      return;
+    }
+
+    mbedtls_md5_context ctx;
+    mbedtls_md5_init(&ctx);
+    mbedtls_md5_starts(&ctx);
+    mbedtls_md5_update(&ctx, &LEAF_PREFIX, 1);
+    mbedtls_md5_update(&ctx, data.data(), size);
+    mbedtls_md5_finish(&ctx, job->leaves[chunk].data());
+    mbedtls_md5_free(&ctx);
+
+    job->chunks_done++;
+    if (chunk_done)
+      chunk_done();
+  }
+}
+}  // Anonymous namespace
+
 std::string MD5Sum(const std::string& file_path, std::function<bool(int)> report_progress)
 {
   std::string output_string;
@@ -40,13 +151,56 @@ std::string MD5Sum(const std::string& file_path, std::function<bool(int)> report
       return output_string;
   }
 
-  std::array<u8, 16> output;
+  Hash output;
   mbedtls_md5_finish(&ctx, output.data());
 
-  // Convert to hex
-  for (u8 n : output)
-    output_string += StringFromFormat("%02x", n);
+  return HashToString(output);
+}
 
-  return output_string;
+std::string MD5TreeSum(const std::string& file_path, std::function<bool(int)> report_progress)
+{
+  TreeJob job;
+  job.file_path = file_path;
+  {
+    std::unique_ptr<DiscIO::BlobReader> file(DiscIO::CreateBlobReader(file_path));
+    if (!file)
+      return "";
+    job.data_size = file->GetDataSize();
+  }
+  // Even no data has one (empty) chunk.
+  job.leaves.resize(std::max<u64>(1, (job.data_size + TREE_CHUNK_SIZE - 1) / TREE_CHUNK_SIZE));
+
+  const unsigned int thread_count = static_cast<unsigned int>(std::min<u64>(
+      {std::max(1u, std::thread::hardware_concurrency()), MAX_TREE_THREADS, job.leaves.size()}));
+  std::vector<std::thread> workers;
+  for (unsigned int i = 1; i < thread_count; ++i)
+  {
+    workers.emplace_back([&job] {
+      Common::SetCurrentThreadName("MD5 tree worker");
+      HashChunks(&job, nullptr);
+    });
+  }
+
+  // This thread hashes chunks too, and reports the progress of all of them.
+  int last_progress = -1;
+  HashChunks(&job, [&] {
+    const int progress = static_cast<int>(job.chunks_done * 100 / job.leaves.size());
+    if (progress != last_progress)
+    {
+      last_progress = progress;
+      if (!report_progress(progress))
+        job.stop = true;
+    }
+  });
+
+  for (std::thread& worker : workers)
+    worker.join();
+
+  if (job.stop || job.failed)
+    return "";
+  if (last_progress != 100 && !report_progress(100))
+    return "";
+
+  return HashToString(HashTree(std::move(job.leaves)));
+}
 }
-}
\ No newline at end of file
@@ -7,7 +7,16 @@
 #include <functional>
 #include <string>
 
+#include "Common/CommonTypes.h"
+
 namespace MD5
 {
 std::string MD5Sum(const std::string& file_name, std::function<bool(int)> progress);
-}
\ No newline at end of file
+
+// Hashes the data in chunks of TREE_CHUNK_SIZE bytes on several threads and combines the hashes
+// of the chunks as a binary tree. The result is not the MD5 of the data, but any difference in
+// the data changes it, so it works just as well to compare games. Like MD5Sum, this hashes the
+// data read through a BlobReader, so a compressed game has the same hash as the plain disc image.
+constexpr u64 TREE_CHUNK_SIZE = 8 * 1024 * 1024;
+std::string MD5TreeSum(const std::string& file_name, std::function<bool(int)> progress);
+}
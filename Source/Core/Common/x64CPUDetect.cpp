@@ -38,7 +38,7 @@ static inline void __cpuid(int info[4], int function_id)
 }
 
 #define _XCR_XFEATURE_ENABLED_MASK 0
-static u64 _xgetbv(u32 index)
+static u64 xgetbv(u32 index)
 {
   u32 eax, edx;
   __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
@@ -139,7 +139,7 @@ void CPUInfo::Detect()
     //  - XGETBV result has the XCR bit set.
     if (((cpu_id[2] >> 28) & 1) && ((cpu_id[2] >> 27) & 1))
     {
-      if ((_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) == 0x6)
+      if ((xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) == 0x6)
       {
         bAVX = true;
         if ((cpu_id[2] >> 12) & 1)
@@ -157,6 +157,12 @@ void CPUInfo::Detect()
         bBMI1 = true;
       if ((cpu_id[1] >> 8) & 1)
         bBMI2 = true;
+      // The SHA extensions cover both SHA-1 and SHA-256.
+      if ((cpu_id[1] >> 29) & 1)
+      {
+        bSHA1 = true;
+        bSHA2 = true;
+      }
     }
   }
 
@@ -255,6 +261,8 @@ std::string CPUInfo::Summarize()
     sum += ", FMA";
   if (bAES)
     sum += ", AES";
+  if (bSHA1)
+    sum += ", SHA";
   if (bMOVBE)
     sum += ", MOVBE";
   if (bLongMode)
@@ -53,6 +53,15 @@ const ConfigInfo<std::string> GFX_DUMP_PATH{{System::GFX, "Settings", "DumpPath"
 const ConfigInfo<int> GFX_BITRATE_KBPS{{System::GFX, "Settings", "BitrateKbps"}, 2500};
 const ConfigInfo<bool> GFX_INTERNAL_RESOLUTION_FRAME_DUMPS{
     {System::GFX, "Settings", "InternalResolutionFrameDumps"}, false};
+const ConfigInfo<int> GFX_FRAME_DUMP_QUEUE_SIZE{{System::GFX, "Settings", "FrameDumpQueueSize"}, 4};
+const ConfigInfo<bool> GFX_FRAME_DUMP_DROP_FRAMES{{System::GFX, "Settings", "FrameDumpDropFrames"},
+                                                  false};
+const ConfigInfo<int> GFX_FRAME_DUMP_THREADS{{System::GFX, "Settings", "FrameDumpThreads"}, 0};
+const ConfigInfo<std::string> GFX_DUMP_IMAGE_FORMAT{{System::GFX, "Settings", "DumpImageFormat"},
+                                                    "png"};
+const ConfigInfo<int> GFX_PNG_COMPRESSION_LEVEL{{System::GFX, "Settings", "PNGCompressionLevel"},
+                                                6};
+const ConfigInfo<bool> GFX_PNG_FAST_FILTER{{System::GFX, "Settings", "PNGFastFilter"}, false};
 const ConfigInfo<bool> GFX_ENABLE_GPU_TEXTURE_DECODING{
     {System::GFX, "Settings", "EnableGPUTextureDecoding"}, false};
 const ConfigInfo<bool> GFX_ENABLE_PIXEL_LIGHTING{{System::GFX, "Settings", "EnablePixelLighting"},
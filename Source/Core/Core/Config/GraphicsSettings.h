@@ -44,6 +44,12 @@ extern const ConfigInfo<std::string> GFX_DUMP_CODEC;
 extern const ConfigInfo<std::string> GFX_DUMP_PATH;
 extern const ConfigInfo<int> GFX_BITRATE_KBPS;
 extern const ConfigInfo<bool> GFX_INTERNAL_RESOLUTION_FRAME_DUMPS;
+extern const ConfigInfo<int> GFX_FRAME_DUMP_QUEUE_SIZE;
+extern const ConfigInfo<bool> GFX_FRAME_DUMP_DROP_FRAMES;
+extern const ConfigInfo<int> GFX_FRAME_DUMP_THREADS;
+extern const ConfigInfo<std::string> GFX_DUMP_IMAGE_FORMAT;
+extern const ConfigInfo<int> GFX_PNG_COMPRESSION_LEVEL;
+extern const ConfigInfo<bool> GFX_PNG_FAST_FILTER;
 extern const ConfigInfo<bool> GFX_ENABLE_GPU_TEXTURE_DECODING;
 extern const ConfigInfo<bool> GFX_ENABLE_PIXEL_LIGHTING;
 extern const ConfigInfo<bool> GFX_FAST_DEPTH_CALC;
@@ -33,6 +33,9 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_USE_FFV1.location, Config::GFX_DUMP_FORMAT.location,
       Config::GFX_DUMP_CODEC.location, Config::GFX_DUMP_PATH.location,
       Config::GFX_BITRATE_KBPS.location, Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS.location,
+      Config::GFX_FRAME_DUMP_QUEUE_SIZE.location, Config::GFX_FRAME_DUMP_DROP_FRAMES.location,
+      Config::GFX_FRAME_DUMP_THREADS.location, Config::GFX_DUMP_IMAGE_FORMAT.location,
+      Config::GFX_PNG_COMPRESSION_LEVEL.location, Config::GFX_PNG_FAST_FILTER.location,
       Config::GFX_ENABLE_GPU_TEXTURE_DECODING.location, Config::GFX_ENABLE_PIXEL_LIGHTING.location,
       Config::GFX_FAST_DEPTH_CALC.location, Config::GFX_MSAA.location, Config::GFX_SSAA.location,
       Config::GFX_EFB_SCALE.location, Config::GFX_TEXFMT_OVERLAY_ENABLE.location,
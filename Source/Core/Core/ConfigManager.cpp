@@ -298,6 +298,7 @@ void SConfig::SaveMovieSettings(IniFile& ini)
 
   movie->Set("PauseMovie", m_PauseMovie);
   movie->Set("Author", m_strMovieAuthor);
+  movie->Set("KeyframeInterval", m_MovieKeyframeInterval);
   movie->Set("DumpFrames", m_DumpFrames);
   movie->Set("DumpFramesSilent", m_DumpFramesSilent);
   movie->Set("ShowInputDisplay", m_ShowInputDisplay);
@@ -627,6 +628,7 @@ void SConfig::LoadMovieSettings(IniFile& ini)
 
   movie->Get("PauseMovie", &m_PauseMovie, false);
   movie->Get("Author", &m_strMovieAuthor, "");
+  movie->Get("KeyframeInterval", &m_MovieKeyframeInterval, 3600);
   movie->Get("DumpFrames", &m_DumpFrames, false);
   movie->Get("DumpFramesSilent", &m_DumpFramesSilent, false);
   movie->Get("ShowInputDisplay", &m_ShowInputDisplay, false);
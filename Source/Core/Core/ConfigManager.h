@@ -297,6 +297,8 @@ struct SConfig : NonCopyable
   bool m_ShowFrameCount;
   bool m_ShowRTC;
   std::string m_strMovieAuthor;
+  // Frames between two keyframes of a movie, or 0 for none.
+  unsigned int m_MovieKeyframeInterval;
   unsigned int m_FrameSkip;
   bool m_DumpFrames;
   bool m_DumpFramesSilent;
@@ -60,6 +60,7 @@
 #include "Core/PatchEngine.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 #include "Core/State.h"
 #include "Core/WiiRoot.h"
 
@@ -938,6 +939,8 @@ void Shutdown()
 
   // Make sure there's nothing left over in case we're about to exit.
   HostDispatchJobs();
+
+  Profiler::StopSampling();
 }
 
 void SetOnStoppedCallback(StoppedCallbackFunc callback)
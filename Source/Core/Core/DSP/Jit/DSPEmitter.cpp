@@ -12,6 +12,7 @@
 #include "Common/BitSet.h"
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 
 #include "Core/DSP/DSPAnalyzer.h"
@@ -28,7 +29,9 @@ namespace JIT
 {
 namespace x86
 {
-constexpr size_t COMPILED_CODE_SIZE = 2097152;
+constexpr size_t COMPILED_CODE_SIZE = 8388608;
+// The code space a ucode used to have to itself. Cached ucodes are dropped when less is left.
+constexpr size_t MIN_UCODE_CODE_SPACE = 2097152;
 constexpr size_t MAX_BLOCK_SIZE = 250;
 constexpr u16 DSP_IDLE_SKIP_CYCLES = 0x1000;
 
@@ -76,14 +79,19 @@ void DSPEmitter::DoState(PointerWrap& p)
 
 void DSPEmitter::ClearIRAM()
 {
-  for (size_t i = 0; i < DSP_IRAM_SIZE; i++)
-  {
-    m_blocks[i] = (DSPCompiledCode)m_stub_entry_point;
-    m_block_links[i] = nullptr;
-    m_block_size[i] = 0;
-    m_unresolved_jumps[i].clear();
-  }
-  g_dsp.reset_dspjit_codespace = true;
+  // If a reset is pending, the current blocks are about to be cleared along with the code space.
+  if (!g_dsp.reset_dspjit_codespace)
+    StoreUCodeBlocks();
+  ResetBlocks();
+
+  m_current_ucode.iram.assign(g_dsp.iram, g_dsp.iram + DSP_IRAM_SIZE);
+  m_current_ucode.hash = HashAdler32(reinterpret_cast<const u8*>(g_dsp.iram), DSP_IRAM_BYTE_SIZE);
+  m_current_ucode.blocks.clear();
+
+  if (GetSpaceLeft() < MIN_UCODE_CODE_SPACE)
+    g_dsp.reset_dspjit_codespace = true;
+  else if (!g_dsp.reset_dspjit_codespace)
+    RestoreUCodeBlocks();
 }
 
 void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
@@ -92,6 +100,13 @@ void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
   CompileDispatcher();
   m_stub_entry_point = CompileStub();
 
+  ResetBlocks();
+  m_ucode_cache.clear();
+  g_dsp.reset_dspjit_codespace = false;
+}
+
+void DSPEmitter::ResetBlocks()
+{
   for (size_t i = 0; i < MAX_BLOCKS; i++)
   {
     m_blocks[i] = (DSPCompiledCode)m_stub_entry_point;
@@ -99,7 +114,52 @@ void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
     m_block_size[i] = 0;
     m_unresolved_jumps[i].clear();
   }
-  g_dsp.reset_dspjit_codespace = false;
+}
+
+// The ROM blocks are kept too, since they may be linked to blocks in IRAM.
+void DSPEmitter::StoreUCodeBlocks()
+{
+  if (m_current_ucode.iram.empty())
+    return;
+
+  m_current_ucode.blocks.clear();
+  for (size_t i = 0; i < MAX_BLOCKS; i++)
+  {
+    if (IsBlockCompiled(static_cast<u16>(i)))
+    {
+      m_current_ucode.blocks.push_back(
+          {static_cast<u16>(i), m_block_size[i], m_blocks[i], m_block_links[i]});
+    }
+  }
+
+  if (!m_current_ucode.blocks.empty())
+    m_ucode_cache.push_back(std::move(m_current_ucode));
+  m_current_ucode = {};
+}
+
+void DSPEmitter::RestoreUCodeBlocks()
+{
+  const auto iter =
+      std::find_if(m_ucode_cache.begin(), m_ucode_cache.end(), [this](const CachedUCode& ucode) {
+        return ucode.hash == m_current_ucode.hash && ucode.iram == m_current_ucode.iram;
+      });
+  if (iter == m_ucode_cache.end())
+    return;
+
+  for (const CachedBlock& block : iter->blocks)
+  {
+    m_blocks[block.address] = block.code;
+    m_block_links[block.address] = block.link;
+    m_block_size[block.address] = block.size;
+  }
+  DEBUG_LOG(DSPLLE, "Reusing %zu compiled blocks for ucode %08x", iter->blocks.size(),
+            iter->hash);
+  m_ucode_cache.erase(iter);
+}
+
+bool DSPEmitter::IsBlockCompiled(u16 address) const
+{
+  return m_blocks[address] != (DSPCompiledCode)m_stub_entry_point;
 }
 
 // Must go out of block if exception is detected
@@ -378,9 +438,9 @@ void DSPEmitter::Compile(u16 start_addr)
   JMP(m_return_dispatcher, true);
 }
 
-static void CompileCurrent()
+void DSPEmitter::CompileWithLinks(u16 start_addr)
 {
-  g_dsp_jit->Compile(g_dsp.pc);
+  Compile(start_addr);
 
   bool retry = true;
 
@@ -389,17 +449,22 @@ static void CompileCurrent()
     retry = false;
     for (size_t i = 0; i < 0xffff; ++i)
     {
-      if (!g_dsp_jit->m_unresolved_jumps[i].empty())
+      if (!m_unresolved_jumps[i].empty())
       {
-        const u16 address_to_compile = g_dsp_jit->m_unresolved_jumps[i].front();
-        g_dsp_jit->Compile(address_to_compile);
-        if (!g_dsp_jit->m_unresolved_jumps[i].empty())
+        const u16 address_to_compile = m_unresolved_jumps[i].front();
+        Compile(address_to_compile);
+        if (!m_unresolved_jumps[i].empty())
           retry = true;
       }
     }
   }
 }
 
+static void CompileCurrent()
+{
+  g_dsp_jit->CompileWithLinks(g_dsp.pc);
+}
+
 const u8* DSPEmitter::CompileStub()
 {
   const u8* entryPoint = AlignCode16();
@@ -477,12 +542,13 @@ Gen::OpArg DSPEmitter::M_SDSP_external_interrupt_waiting()
 
 Gen::OpArg DSPEmitter::M_SDSP_r_st(size_t index)
 {
-  return MDisp(R15, static_cast<int>(offsetof(SDSP, r.st[index])));
+  return MDisp(R15, static_cast<int>(offsetof(SDSP, r.st[0]) + sizeof(SDSP::r.st[0]) * index));
 }
 
 Gen::OpArg DSPEmitter::M_SDSP_reg_stack_ptr(size_t index)
 {
-  return MDisp(R15, static_cast<int>(offsetof(SDSP, reg_stack_ptr[index])));
+  return MDisp(R15, static_cast<int>(offsetof(SDSP, reg_stack_ptr[0]) +
+                                     sizeof(SDSP::reg_stack_ptr[0]) * index));
 }
 
 }  // namespace x86
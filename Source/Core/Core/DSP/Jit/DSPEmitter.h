@@ -42,12 +42,17 @@ public:
   void DoState(PointerWrap& p);
 
   void EmitInstruction(UDSPInstruction inst);
+  // Called when new code was loaded into IRAM. Compiled blocks are kept per ucode, so that
+  // switching back to a ucode which was loaded before doesn't compile it all over again.
   void ClearIRAM();
   void ClearIRAMandDSPJITCodespaceReset();
 
   void CompileDispatcher();
   Block CompileStub();
   void Compile(u16 start_addr);
+  // Compiles the block at start_addr and the blocks it is waiting on to be linked to them.
+  void CompileWithLinks(u16 start_addr);
+  bool IsBlockCompiled(u16 address) const;
 
   bool FlagsNeeded() const;
 
@@ -210,8 +215,29 @@ public:
   std::array<std::list<u16>, MAX_BLOCKS> m_unresolved_jumps;
 
 private:
+  struct CachedBlock
+  {
+    u16 address;
+    u16 size;
+    DSPCompiledCode code;
+    Block link;
+  };
+
+  struct CachedUCode
+  {
+    u32 hash;
+    std::vector<u16> iram;
+    std::vector<CachedBlock> blocks;
+  };
+
+  void ResetBlocks();
+  void StoreUCodeBlocks();
+  void RestoreUCodeBlocks();
+
   void WriteBranchExit();
-  void WriteBlockLink(u16 dest);
+  // Only unconditional branches wait for their destination to be compiled. Conditional ones are
+  // linked if the destination already is, and go through the dispatcher otherwise.
+  void WriteBlockLink(u16 dest, bool wait_for_dest);
 
   void ReJitConditional(UDSPInstruction opc, void (DSPEmitter::*conditional_fn)(UDSPInstruction));
   void r_jcc(UDSPInstruction opc);
@@ -309,6 +335,11 @@ private:
   std::vector<Block> m_block_links;
   Block m_block_link_entry;
 
+  // The IRAM contents the current blocks were compiled from, and the blocks of other ucodes
+  // which are still in the code space.
+  CachedUCode m_current_ucode;
+  std::vector<CachedUCode> m_ucode_cache;
+
   u16 m_cycles_left = 0;
 
   // The index of the last stored ext value (compile time).
@@ -100,7 +100,7 @@ void DSPEmitter::WriteBranchExit()
   m_gpr.FlushRegs(c, false);
 }
 
-void DSPEmitter::WriteBlockLink(u16 dest)
+void DSPEmitter::WriteBlockLink(u16 dest, bool wait_for_dest)
 {
   // Jump directly to the called block if it has already been compiled.
   if (!(dest >= m_start_address && dest <= m_compile_pc))
@@ -119,7 +119,7 @@ void DSPEmitter::WriteBlockLink(u16 dest)
       JMP(m_block_links[dest], true);
       SetJumpTarget(notEnoughCycles);
     }
-    else
+    else if (wait_for_dest)
     {
       // The destination has not been compiled yet.  Add it to the list
       // of blocks that this block is waiting on.
@@ -133,9 +133,9 @@ void DSPEmitter::r_jcc(const UDSPInstruction opc)
   u16 dest = dsp_imem_read(m_compile_pc + 1);
   const DSPOPCTemplate* opcode = GetOpTemplate(opc);
 
-  // If the block is unconditional, attempt to link block
-  if (opcode->uncond_branch)
-    WriteBlockLink(dest);
+  // Conditional branches are only linked to blocks which are already compiled, waiting for them
+  // could make blocks wait on each other forever.
+  WriteBlockLink(dest, opcode->uncond_branch);
   MOV(16, M_SDSP_pc(), Imm16(dest));
   WriteBranchExit();
 }
@@ -179,9 +179,9 @@ void DSPEmitter::r_call(const UDSPInstruction opc)
   u16 dest = dsp_imem_read(m_compile_pc + 1);
   const DSPOPCTemplate* opcode = GetOpTemplate(opc);
 
-  // If the block is unconditional, attempt to link block
-  if (opcode->uncond_branch)
-    WriteBlockLink(dest);
+  // Conditional branches are only linked to blocks which are already compiled, waiting for them
+  // could make blocks wait on each other forever.
+  WriteBlockLink(dest, opcode->uncond_branch);
   MOV(16, M_SDSP_pc(), Imm16(dest));
   WriteBranchExit();
 }
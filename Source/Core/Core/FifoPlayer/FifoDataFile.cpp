@@ -5,20 +5,31 @@
 #include "Core/FifoPlayer/FifoDataFile.h"
 
 #include <algorithm>
+#include <cinttypes>
+#include <cstdio>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <lzo/lzo1x.h>
+
 #include "Common/File.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
 
 enum
 {
   FILE_ID = 0x0d01f1f0,
-  VERSION_NUMBER = 4,
-  MIN_LOADER_VERSION = 1,
+  VERSION_NUMBER = 5,
+  // Version 5 compresses the frames.
+  MIN_LOADER_VERSION = 5,
 };
 
+constexpr size_t MAX_CACHED_FRAMES = 8;
+
 #pragma pack(push, 1)
 
 struct FileHeader
@@ -51,7 +62,12 @@ struct FileFrameInfo
   u32 fifoEnd;
   u64 memoryUpdatesOffset;
   u32 numMemoryUpdates;
-  u8 reserved[32];
+  // Since version 5, the fifo data, the memory update list and the memory update data of a frame
+  // are stored together at fifoDataOffset, compressed with LZO. The other offsets are relative to
+  // the start of the uncompressed data. Older versions leave these at 0.
+  u32 compressedSize;
+  u32 uncompressedSize;
+  u8 reserved[24];
 };
 static_assert(sizeof(FileFrameInfo) == 64, "FileFrameInfo should be 64 bytes");
 
@@ -68,6 +84,53 @@ static_assert(sizeof(FileMemoryUpdate) == 24, "FileMemoryUpdate should be 24 byt
 
 #pragma pack(pop)
 
+// Returns the compressed frame, and fills in everything but the offset of frameInfo.
+static std::vector<u8> CompressFrame(const FifoFrameInfo& frame, FileFrameInfo* frameInfo)
+{
+  std::vector<u8> data(frame.fifoData);
+  const size_t updatesOffset = data.size();
+  data.resize(data.size() + frame.memoryUpdates.size() * sizeof(FileMemoryUpdate));
+  for (size_t i = 0; i < frame.memoryUpdates.size(); ++i)
+  {
+    const MemoryUpdate& srcUpdate = frame.memoryUpdates[i];
+
+    FileMemoryUpdate dstUpdate = {};
+    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+    dstUpdate.address = srcUpdate.address;
+    dstUpdate.dataOffset = data.size();
+    dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
+    dstUpdate.type = srcUpdate.type;
+    std::memcpy(&data[updatesOffset + i * sizeof(FileMemoryUpdate)], &dstUpdate,
+                sizeof(FileMemoryUpdate));
+
+    data.insert(data.end(), srcUpdate.data.begin(), srcUpdate.data.end());
+  }
+
+  static const bool lzoInitialized = lzo_init() == LZO_E_OK;
+  if (!lzoInitialized)
+    PanicAlertT("Internal LZO Error - lzo_init() failed");
+
+  std::vector<lzo_align_t> workMemory((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) /
+                                      sizeof(lzo_align_t));
+  std::vector<u8> compressed(data.size() + data.size() / 16 + 64 + 3);
+  lzo_uint compressedSize = compressed.size();
+  if (lzo1x_1_compress(data.data(), data.size(), compressed.data(), &compressedSize,
+                       workMemory.data()) != LZO_E_OK)
+  {
+    PanicAlertT("Internal LZO Error - compression failed");
+  }
+  compressed.resize(compressedSize);
+
+  frameInfo->fifoDataSize = static_cast<u32>(frame.fifoData.size());
+  frameInfo->fifoStart = frame.fifoStart;
+  frameInfo->fifoEnd = frame.fifoEnd;
+  frameInfo->memoryUpdatesOffset = updatesOffset;
+  frameInfo->numMemoryUpdates = static_cast<u32>(frame.memoryUpdates.size());
+  frameInfo->compressedSize = static_cast<u32>(compressed.size());
+  frameInfo->uncompressedSize = static_cast<u32>(data.size());
+  return compressed;
+}
+
 FifoDataFile::FifoDataFile() = default;
 
 FifoDataFile::~FifoDataFile() = default;
@@ -89,11 +152,83 @@ bool FifoDataFile::GetIsWii() const
 
 void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
 {
-  m_Frames.push_back(frameInfo);
+  FileFrameInfo dstFrame = {};
+  const std::vector<u8> compressed = CompressFrame(frameInfo, &dstFrame);
+
+  std::lock_guard<std::mutex> lk(m_Mutex);
+
+  if (!m_File)
+  {
+    // Deleted automatically when closed.
+    m_File = std::make_unique<File::IOFile>(std::tmpfile());
+    if (!m_File->IsOpen())
+    {
+      m_File.reset();
+      PanicAlertT("Failed to create a temporary file for the FIFO log.");
+      return;
+    }
+  }
+
+  m_File->Seek(0, SEEK_END);
+  dstFrame.fifoDataOffset = m_File->Tell();
+  if (!m_File->WriteBytes(compressed.data(), compressed.size()))
+  {
+    ERROR_LOG(VIDEO, "Failed to write frame %zu of the FIFO log", m_Frames.size());
+    return;
+  }
+
+  m_Frames.push_back(dstFrame);
+  m_AddedFifoDataSize += frameInfo.fifoData.size();
+  for (const MemoryUpdate& update : frameInfo.memoryUpdates)
+    m_AddedMemoryUpdateSize += update.data.size();
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::GetFrame(u32 frame) const
+{
+  std::lock_guard<std::mutex> lk(m_Mutex);
+
+  auto iter = std::find_if(m_CachedFrames.begin(), m_CachedFrames.end(),
+                           [frame](const auto& entry) { return entry.first == frame; });
+  if (iter != m_CachedFrames.end())
+  {
+    // Keep the most recently used frames at the back.
+    std::rotate(iter, iter + 1, m_CachedFrames.end());
+    return m_CachedFrames.back().second;
+  }
+
+  std::shared_ptr<const FifoFrameInfo> frameInfo = ReadFrame(m_Frames[frame]);
+  if (m_CachedFrames.size() >= MAX_CACHED_FRAMES)
+    m_CachedFrames.erase(m_CachedFrames.begin());
+  m_CachedFrames.emplace_back(frame, frameInfo);
+  return frameInfo;
+}
+
+u32 FifoDataFile::GetFrameCount() const
+{
+  std::lock_guard<std::mutex> lk(m_Mutex);
+  return static_cast<u32>(m_Frames.size());
+}
+
+u64 FifoDataFile::GetAddedFifoDataSize() const
+{
+  std::lock_guard<std::mutex> lk(m_Mutex);
+  return m_AddedFifoDataSize;
+}
+
+u64 FifoDataFile::GetAddedMemoryUpdateSize() const
+{
+  std::lock_guard<std::mutex> lk(m_Mutex);
+  return m_AddedMemoryUpdateSize;
 }
 
 bool FifoDataFile::Save(const std::string& filename)
 {
+  std::vector<FileFrameInfo> frames;
+  {
+    std::lock_guard<std::mutex> lk(m_Mutex);
+    frames = m_Frames;
+  }
+
   File::IOFile file;
   if (!file.Open(filename, "wb"))
     return false;
@@ -103,7 +238,7 @@ bool FifoDataFile::Save(const std::string& filename)
 
   // Add space for frame list
   u64 frameListOffset = file.Tell();
-  PadFile(m_Frames.size() * sizeof(FileFrameInfo), file);
+  PadFile(frames.size() * sizeof(FileFrameInfo), file);
 
   u64 bpMemOffset = file.Tell();
   file.WriteArray(m_BPMem, BP_MEM_SIZE);
@@ -142,7 +277,7 @@ bool FifoDataFile::Save(const std::string& filename)
   header.texMemSize = TEX_MEM_SIZE;
 
   header.frameListOffset = frameListOffset;
-  header.frameCount = (u32)m_Frames.size();
+  header.frameCount = static_cast<u32>(frames.size());
 
   header.flags = m_Flags;
 
@@ -150,24 +285,25 @@ bool FifoDataFile::Save(const std::string& filename)
   file.WriteBytes(&header, sizeof(FileHeader));
 
   // Write frames list
-  for (unsigned int i = 0; i < m_Frames.size(); ++i)
+  for (u32 i = 0; i < frames.size(); ++i)
   {
-    const FifoFrameInfo& srcFrame = m_Frames[i];
+    FileFrameInfo dstFrame = frames[i];
+
+    // Compressed frames are copied as they are, frames from older versions are compressed.
+    std::vector<u8> compressed;
+    if (dstFrame.compressedSize != 0)
+    {
+      std::lock_guard<std::mutex> lk(m_Mutex);
+      compressed = ReadCompressedFrame(dstFrame);
+    }
+    else
+    {
+      compressed = CompressFrame(*GetFrame(i), &dstFrame);
+    }
 
-    // Write FIFO data
     file.Seek(0, SEEK_END);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcFrame.fifoData.data(), srcFrame.fifoData.size());
-
-    u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
-
-    FileFrameInfo dstFrame;
-    dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
-    dstFrame.fifoDataOffset = dataOffset;
-    dstFrame.fifoStart = srcFrame.fifoStart;
-    dstFrame.fifoEnd = srcFrame.fifoEnd;
-    dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
-    dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame.memoryUpdates.size());
+    dstFrame.fifoDataOffset = file.Tell();
+    file.WriteBytes(compressed.data(), compressed.size());
 
     // Write frame info
     u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
@@ -233,29 +369,23 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
     file.ReadArray(dataFile->m_TexMem, size);
   }
 
-  // Read frames
-  for (u32 i = 0; i < header.frameCount; ++i)
-  {
-    u64 frameOffset = header.frameListOffset + (i * sizeof(FileFrameInfo));
-    file.Seek(frameOffset, SEEK_SET);
-    FileFrameInfo srcFrame;
-    file.ReadBytes(&srcFrame, sizeof(FileFrameInfo));
-
-    FifoFrameInfo dstFrame;
-    dstFrame.fifoData.resize(srcFrame.fifoDataSize);
-    dstFrame.fifoStart = srcFrame.fifoStart;
-    dstFrame.fifoEnd = srcFrame.fifoEnd;
-
-    file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-    file.ReadBytes(dstFrame.fifoData.data(), srcFrame.fifoDataSize);
-
-    ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates,
-                      dstFrame.memoryUpdates, file);
+  // Only the frame list is read here, the frames are read when they're needed.
+  dataFile->m_Frames.resize(header.frameCount);
+  file.Seek(header.frameListOffset, SEEK_SET);
+  if (!file.ReadArray(dataFile->m_Frames.data(), header.frameCount))
+    return nullptr;
 
-    dataFile->AddFrame(dstFrame);
+  // Older versions didn't clear the reserved fields.
+  if (dataFile->m_Version < 5)
+  {
+    for (FileFrameInfo& frame : dataFile->m_Frames)
+    {
+      frame.compressedSize = 0;
+      frame.uncompressedSize = 0;
+    }
   }
 
-  file.Close();
+  dataFile->m_File = std::make_unique<File::IOFile>(std::move(file));
 
   return dataFile;
 }
@@ -279,35 +409,73 @@ bool FifoDataFile::GetFlag(u32 flag) const
   return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
-                                     File::IOFile& file)
+// m_Mutex must be held.
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::ReadFrame(const FileFrameInfo& srcFrame) const
 {
-  // Add space for memory update list
-  u64 updateListOffset = file.Tell();
-  PadFile(memUpdates.size() * sizeof(FileMemoryUpdate), file);
+  auto dstFrame = std::make_shared<FifoFrameInfo>();
+  dstFrame->fifoStart = srcFrame.fifoStart;
+  dstFrame->fifoEnd = srcFrame.fifoEnd;
 
-  for (unsigned int i = 0; i < memUpdates.size(); ++i)
+  if (srcFrame.compressedSize == 0)
   {
-    const MemoryUpdate& srcUpdate = memUpdates[i];
+    dstFrame->fifoData.resize(srcFrame.fifoDataSize);
+    m_File->Seek(srcFrame.fifoDataOffset, SEEK_SET);
+    m_File->ReadBytes(dstFrame->fifoData.data(), srcFrame.fifoDataSize);
 
-    // Write memory
-    file.Seek(0, SEEK_END);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcUpdate.data.data(), srcUpdate.data.size());
+    ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates,
+                      dstFrame->memoryUpdates, *m_File);
+    return dstFrame;
+  }
 
-    FileMemoryUpdate dstUpdate;
+  const std::vector<u8> compressed = ReadCompressedFrame(srcFrame);
+  std::vector<u8> data(srcFrame.uncompressedSize);
+  lzo_uint size = data.size();
+  const u64 updatesEnd =
+      srcFrame.memoryUpdatesOffset + u64{srcFrame.numMemoryUpdates} * sizeof(FileMemoryUpdate);
+  if (lzo1x_decompress_safe(compressed.data(), compressed.size(), data.data(), &size, nullptr) !=
+          LZO_E_OK ||
+      size != data.size() || srcFrame.fifoDataSize > size || updatesEnd > size)
+  {
+    ERROR_LOG(VIDEO, "Failed to decompress a frame of the FIFO log at %" PRIx64,
+              srcFrame.fifoDataOffset);
+    return dstFrame;
+  }
+
+  dstFrame->fifoData.assign(data.begin(), data.begin() + srcFrame.fifoDataSize);
+
+  dstFrame->memoryUpdates.resize(srcFrame.numMemoryUpdates);
+  for (u32 i = 0; i < srcFrame.numMemoryUpdates; ++i)
+  {
+    FileMemoryUpdate srcUpdate;
+    std::memcpy(&srcUpdate, &data[srcFrame.memoryUpdatesOffset + i * sizeof(FileMemoryUpdate)],
+                sizeof(FileMemoryUpdate));
+    if (srcUpdate.dataOffset + srcUpdate.dataSize > size)
+    {
+      ERROR_LOG(VIDEO, "Invalid memory update in the FIFO log at %" PRIx64,
+                srcFrame.fifoDataOffset);
+      dstFrame->memoryUpdates.resize(i);
+      break;
+    }
+
+    MemoryUpdate& dstUpdate = dstFrame->memoryUpdates[i];
     dstUpdate.address = srcUpdate.address;
-    dstUpdate.dataOffset = dataOffset;
-    dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
     dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-    dstUpdate.type = srcUpdate.type;
-
-    u64 updateOffset = updateListOffset + (i * sizeof(FileMemoryUpdate));
-    file.Seek(updateOffset, SEEK_SET);
-    file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
+    dstUpdate.data.assign(data.begin() + srcUpdate.dataOffset,
+                          data.begin() + srcUpdate.dataOffset + srcUpdate.dataSize);
+    dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
   }
 
-  return updateListOffset;
+  return dstFrame;
+}
+
+// m_Mutex must be held.
+std::vector<u8> FifoDataFile::ReadCompressedFrame(const FileFrameInfo& srcFrame) const
+{
+  std::vector<u8> compressed(srcFrame.compressedSize);
+  m_File->Seek(srcFrame.fifoDataOffset, SEEK_SET);
+  if (!m_File->ReadBytes(compressed.data(), compressed.size()))
+    compressed.clear();
+  return compressed;
 }
 
 void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
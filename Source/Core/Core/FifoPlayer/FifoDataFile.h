@@ -5,7 +5,9 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -15,6 +17,8 @@ namespace File
 class IOFile;
 }
 
+struct FileFrameInfo;
+
 struct MemoryUpdate
 {
   enum Type
@@ -66,9 +70,17 @@ public:
   u32* GetXFMem() { return m_XFMem; }
   u32* GetXFRegs() { return m_XFRegs; }
   u8* GetTexMem() { return m_TexMem; }
+
+  // Frames are compressed and written to a temporary file as they're added, so that a recording
+  // doesn't have to fit in memory.
   void AddFrame(const FifoFrameInfo& frameInfo);
-  const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
-  u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
+  // Frames are only read from the file when they're needed, and just the most recently used ones
+  // are kept in memory.
+  std::shared_ptr<const FifoFrameInfo> GetFrame(u32 frame) const;
+  u32 GetFrameCount() const;
+  // Totals for the frames added with AddFrame.
+  u64 GetAddedFifoDataSize() const;
+  u64 GetAddedMemoryUpdateSize() const;
   bool Save(const std::string& filename);
 
   static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
@@ -84,7 +96,8 @@ private:
   void SetFlag(u32 flag, bool set);
   bool GetFlag(u32 flag) const;
 
-  u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
+  std::shared_ptr<const FifoFrameInfo> ReadFrame(const FileFrameInfo& srcFrame) const;
+  std::vector<u8> ReadCompressedFrame(const FileFrameInfo& srcFrame) const;
   static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
                                 std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
 
@@ -97,5 +110,15 @@ private:
   u32 m_Flags = 0;
   u32 m_Version = 0;
 
-  std::vector<FifoFrameInfo> m_Frames;
+  // The file the frames are read from: the loaded file, or the temporary file of a recording.
+  // Frame offsets are relative to the start of that file.
+  std::unique_ptr<File::IOFile> m_File;
+  std::vector<FileFrameInfo> m_Frames;
+  u64 m_AddedFifoDataSize = 0;
+  u64 m_AddedMemoryUpdateSize = 0;
+
+  // Frames are added by the video thread while the GUI shows the recording, and a loaded file is
+  // read by both the GUI and the CPU thread.
+  mutable std::mutex m_Mutex;
+  mutable std::vector<std::pair<u32, std::shared_ptr<const FifoFrameInfo>>> m_CachedFrames;
 };
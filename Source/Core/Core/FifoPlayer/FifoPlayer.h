@@ -89,9 +89,14 @@ public:
   // If enabled then all memory updates happen at once before the first frame
   // Default is disabled
   void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
+  // Plays the frame range this many times and then stops, regardless of the loop setting.
+  // 0 follows the loop setting.
+  void SetPlayCount(u32 count) { m_PlayCount = count; }
   // Callbacks
   void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
   void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
+  // Called on the CPU thread once the GPU is done with a frame.
+  void SetFrameFinishedCallback(CallbackFunc callback) { m_FrameFinishedCb = callback; }
   static FifoPlayer& GetInstance();
 
 private:
@@ -102,8 +107,7 @@ private:
   CPU::State AdvanceFrame();
 
   void WriteFrame(const FifoFrameInfo& frame, const AnalyzedFrameInfo& info);
-  void WriteFramePart(u32 dataStart, u32 dataEnd, u32& nextMemUpdate, const FifoFrameInfo& frame,
-                      const AnalyzedFrameInfo& info);
+  void WriteFramePart(u32 dataStart, u32 dataEnd, u32& nextMemUpdate, const FifoFrameInfo& frame);
 
   void WriteAllMemoryUpdates();
   void WriteMemory(const MemoryUpdate& memUpdate);
@@ -134,6 +138,8 @@ private:
   static bool IsHighWatermarkSet();
 
   bool m_Loop;
+  u32 m_PlayCount = 0;
+  u32 m_TimesPlayed = 0;
 
   u32 m_CurrentFrame = 0;
   u32 m_FrameRangeStart = 0;
@@ -150,6 +156,7 @@ private:
 
   CallbackFunc m_FileLoadedCb = nullptr;
   CallbackFunc m_FrameWrittenCb = nullptr;
+  CallbackFunc m_FrameFinishedCb = nullptr;
 
   std::unique_ptr<FifoDataFile> m_File;
 
@@ -21,31 +21,88 @@ namespace GPFifo
 // Overfilling is no problem (up to the real limit), CheckGatherPipe will blast the
 // contents in nicely sized chunks
 //
-// Other optimizations to think about:
-// - If the GP is NOT linked to the FIFO, just blast to memory byte by word
-// - If the GP IS linked to the FIFO, use a fast wrapping buffer and skip writing to memory
-//
-// Both of these should actually work! Only problem is that we have to decide at run time,
-// the same function could use both methods. Compile 2 different versions of each such block?
+// When the GP is linked to the FIFO and there is enough free space in front of the CPU write
+// pointer, the pipe points straight into the FIFO in guest RAM instead. Writes (including the
+// ones emitted by the JIT) then land where the GPU reads them, and a burst only has to advance
+// the write pointer instead of copying the data.
 
 // More room for the fastmodes
 alignas(32) static u8 s_gather_pipe[GATHER_PIPE_SIZE * 16];
 
+// Start of the pending data: either s_gather_pipe, or guest RAM at s_direct_address.
+static u8* s_pipe_base = s_gather_pipe;
+static u32 s_direct_address;
+
 // pipe pointer
 u8* g_gather_pipe_ptr = s_gather_pipe;
 
 static size_t GetGatherPipeCount()
 {
-  return g_gather_pipe_ptr - s_gather_pipe;
+  return g_gather_pipe_ptr - s_pipe_base;
 }
 
 static void SetGatherPipeCount(size_t size)
 {
-  g_gather_pipe_ptr = s_gather_pipe + size;
+  g_gather_pipe_ptr = s_pipe_base + size;
+}
+
+static bool IsDirect()
+{
+  return s_pipe_base != s_gather_pipe;
+}
+
+// Moves the pending data back into s_gather_pipe.
+static void LeaveDirectMode()
+{
+  if (!IsDirect())
+    return;
+
+  const size_t pipe_count = GetGatherPipeCount();
+  std::memcpy(s_gather_pipe, s_pipe_base, pipe_count);
+  s_pipe_base = s_gather_pipe;
+  SetGatherPipeCount(pipe_count);
+}
+
+// Returns where the pipe can be placed in guest RAM, or nullptr if it has to stay buffered.
+static u8* GetDirectPointer()
+{
+  // Only the GPU reads from a linked FIFO, and it never reads beyond the write pointer. The
+  // whole data written before the next check has to fit in front of both the end of the FIFO
+  // and the data the GPU hasn't read yet.
+  if (!CommandProcessor::fifo.bFF_GPLinkEnable)
+    return nullptr;
+
+  const u32 write_pointer = ProcessorInterface::Fifo_CPUWritePointer;
+  const u32 fifo_end = ProcessorInterface::Fifo_CPUEnd + GATHER_PIPE_SIZE;
+  const u32 fifo_size = fifo_end - ProcessorInterface::Fifo_CPUBase;
+  if (write_pointer < ProcessorInterface::Fifo_CPUBase || write_pointer >= fifo_end ||
+      fifo_end - write_pointer < sizeof(s_gather_pipe) ||
+      CommandProcessor::fifo.CPReadWriteDistance + sizeof(s_gather_pipe) + GATHER_PIPE_SIZE >
+          fifo_size)
+  {
+    return nullptr;
+  }
+
+  // The area must not cross the end of MEM1 or MEM2.
+  const u32 address = write_pointer & 0x3FFFFFFF;
+  if (address < Memory::REALRAM_SIZE)
+  {
+    if (address + sizeof(s_gather_pipe) > Memory::REALRAM_SIZE)
+      return nullptr;
+    return Memory::m_pRAM + address;
+  }
+  if (Memory::m_pEXRAM && (address >> 28) == 0x1 &&
+      (address & 0x0FFFFFFF) + sizeof(s_gather_pipe) <= Memory::EXRAM_SIZE)
+  {
+    return Memory::m_pEXRAM + (address & Memory::EXRAM_MASK);
+  }
+  return nullptr;
 }
 
 void DoState(PointerWrap& p)
 {
+  // Savestates always contain the buffered pipe.
+  LeaveDirectMode();
   p.Do(s_gather_pipe);
   u32 pipe_count = static_cast<u32>(GetGatherPipeCount());
   p.Do(pipe_count);
@@ -55,6 +112,7 @@ void DoState(PointerWrap& p)
 void Init()
 {
   ResetGatherPipe();
+  s_direct_address = 0;
   memset(s_gather_pipe, 0, sizeof(s_gather_pipe));
 }
 
@@ -65,18 +123,27 @@ bool IsEmpty()
 
 void ResetGatherPipe()
 {
+  // The FIFO is usually being reconfigured, so go back to buffering until the next burst.
+  s_pipe_base = s_gather_pipe;
   SetGatherPipeCount(0);
 }
 
 static void UpdateGatherPipe()
 {
+  // If the FIFO registers changed since the pipe was placed, the data has to be copied to the
+  // new write pointer like buffered data.
+  if (IsDirect() && s_direct_address != ProcessorInterface::Fifo_CPUWritePointer)
+    LeaveDirectMode();
+
+  const bool direct = IsDirect();
   size_t pipe_count = GetGatherPipeCount();
   size_t processed;
   u8* cur_mem = Memory::GetPointer(ProcessorInterface::Fifo_CPUWritePointer);
   for (processed = 0; pipe_count >= GATHER_PIPE_SIZE; processed += GATHER_PIPE_SIZE)
   {
-    // copy the GatherPipe
-    memcpy(cur_mem, s_gather_pipe + processed, GATHER_PIPE_SIZE);
+    // copy the GatherPipe, unless it was written in place
+    if (!direct)
+      memcpy(cur_mem, s_gather_pipe + processed, GATHER_PIPE_SIZE);
     pipe_count -= GATHER_PIPE_SIZE;
 
     // increase the CPUWritePointer
@@ -94,8 +161,21 @@ static void UpdateGatherPipe()
     CommandProcessor::GatherPipeBursted();
   }
 
-  // move back the spill bytes
-  memmove(s_gather_pipe, s_gather_pipe + processed, pipe_count);
+  // move back the spill bytes, either to the new write pointer or into the buffer
+  const u8* spill = s_pipe_base + processed;
+  u8* direct_pointer = GetDirectPointer();
+  if (direct_pointer)
+  {
+    s_direct_address = ProcessorInterface::Fifo_CPUWritePointer;
+    if (direct_pointer != spill)
+      memmove(direct_pointer, spill, pipe_count);
+    s_pipe_base = direct_pointer;
+  }
+  else
+  {
+    memmove(s_gather_pipe, spill, pipe_count);
+    s_pipe_base = s_gather_pipe;
+  }
   SetGatherPipeCount(pipe_count);
 }
 
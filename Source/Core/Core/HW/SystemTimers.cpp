@@ -61,6 +61,7 @@ IPC_HLE_PERIOD: For the Wii Remote this is the call schedule:
 #include "Core/IOS/IOS.h"
 #include "Core/PatchEngine.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/Rollback.h"
 #include "VideoCommon/Fifo.h"
 
 namespace SystemTimers
@@ -120,6 +121,7 @@ static void IPC_HLE_UpdateCallback(u64 userdata, s64 cyclesLate)
 
 static void VICallback(u64 userdata, s64 cyclesLate)
 {
+  cyclesLate = Rollback::RunSafePoint(cyclesLate);
   VideoInterface::Update(CoreTiming::GetTicks() - cyclesLate);
   CoreTiming::ScheduleEvent(VideoInterface::GetTicksPerHalfLine() - cyclesLate, et_VI);
 }
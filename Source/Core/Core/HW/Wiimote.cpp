@@ -83,6 +83,11 @@ void Initialize(InitializeMode init_mode)
 
 void ResetAllWiimotes()
 {
+  // Before the first boot of a frontend without a controller config window, the Wiimotes don't
+  // exist yet; the boot creates them in their initial state.
+  if (s_config.ControllersNeedToBeCreated())
+    return;
+
   for (int i = WIIMOTE_CHAN_0; i < MAX_BBMOTES; ++i)
     static_cast<WiimoteEmu::Wiimote*>(s_config.GetController(i))->Reset();
 }
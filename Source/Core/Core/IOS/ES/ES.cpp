@@ -11,9 +11,8 @@
 #include <utility>
 #include <vector>
 
-#include <mbedtls/sha1.h>
-
 #include "Common/ChunkFile.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
@@ -913,9 +912,8 @@ ReturnCode ES::VerifyContainer(VerifyContainerType type, VerifyMode mode,
   // Calculate the SHA1 of the signed blob.
   const size_t skip = type == VerifyContainerType::Device ? offsetof(SignatureECC, issuer) :
                                                             offsetof(SignatureRSA2048, issuer);
-  std::array<u8, 20> sha1;
-  mbedtls_sha1(signed_blob.GetBytes().data() + skip, signed_blob.GetBytes().size() - skip,
-               sha1.data());
+  const std::array<u8, 20> sha1 = Common::SHA1::CalculateDigest(
+      signed_blob.GetBytes().data() + skip, signed_blob.GetBytes().size() - skip);
 
   // Verify the signature.
   const std::vector<u8> signature = signed_blob.GetSignatureData();
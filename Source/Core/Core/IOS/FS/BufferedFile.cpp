@@ -0,0 +1,187 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/IOS/FS/BufferedFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace IOS
+{
+namespace HLE
+{
+BufferedFile::BufferedFile(const std::string& path) : m_file(path, "r+b")
+{
+  m_size = m_file.GetSize();
+  m_buffer.reserve(BLOCK_SIZE);
+}
+
+BufferedFile::~BufferedFile()
+{
+  Flush();
+}
+
+bool BufferedFile::Read(u64 offset, u8* data, size_t size, size_t* bytes_read)
+{
+  ++m_stats.reads;
+  *bytes_read = 0;
+  while (*bytes_read < size)
+  {
+    const u64 position = offset + *bytes_read;
+    if (position >= m_size)
+      break;
+
+    if (position >= m_buffer_offset && position < m_buffer_offset + m_buffer.size())
+    {
+      const size_t start = static_cast<size_t>(position - m_buffer_offset);
+      const size_t count = std::min(size - *bytes_read, m_buffer.size() - start);
+      std::memcpy(data + *bytes_read, &m_buffer[start], count);
+      *bytes_read += count;
+      continue;
+    }
+
+    // The host file has to be up to date before anything is read from it.
+    if (!Flush())
+      return false;
+
+    // Big reads go straight to the host, small ones read a block ahead.
+    const size_t remaining = size - *bytes_read;
+    if (remaining >= BLOCK_SIZE)
+    {
+      size_t count;
+      const bool success = ReadHost(position, data + *bytes_read, remaining, &count);
+      *bytes_read += count;
+      return success;
+    }
+
+    DropBuffer();
+    m_buffer.resize(static_cast<size_t>(std::min<u64>(BLOCK_SIZE, m_size - position)));
+    size_t count;
+    const bool success = ReadHost(position, m_buffer.data(), m_buffer.size(), &count);
+    m_buffer.resize(count);
+    m_buffer_offset = position;
+    if (!success)
+      return false;
+    if (count == 0)
+      break;
+  }
+  return true;
+}
+
+bool BufferedFile::Write(u64 offset, const u8* data, size_t size)
+{
+  ++m_stats.writes;
+
+  if (size >= BLOCK_SIZE)
+  {
+    if (!Flush())
+      return false;
+    DropBuffer();
+    if (!WriteHost(offset, data, size))
+      return false;
+    m_size = std::max(m_size, offset + size);
+    return true;
+  }
+
+  // The window can only grow from the bytes it has, so that all of them stay up to date.
+  const bool fits_in_buffer = offset >= m_buffer_offset &&
+                              offset <= m_buffer_offset + m_buffer.size() &&
+                              offset + size <= m_buffer_offset + BLOCK_SIZE;
+  if (!fits_in_buffer)
+  {
+    if (!Flush())
+      return false;
+    DropBuffer();
+    m_buffer_offset = offset;
+  }
+
+  const size_t start = static_cast<size_t>(offset - m_buffer_offset);
+  if (start + size > m_buffer.size())
+    m_buffer.resize(start + size);
+  std::memcpy(&m_buffer[start], data, size);
+
+  if (m_dirty_begin == m_dirty_end)
+  {
+    m_dirty_begin = start;
+    m_dirty_end = start + size;
+  }
+  else
+  {
+    m_dirty_begin = std::min(m_dirty_begin, start);
+    m_dirty_end = std::max(m_dirty_end, start + size);
+  }
+
+  m_size = std::max(m_size, offset + size);
+  return true;
+}
+
+bool BufferedFile::Flush()
+{
+  if (m_dirty_begin == m_dirty_end)
+    return true;
+
+  const bool success = WriteHost(m_buffer_offset + m_dirty_begin, &m_buffer[m_dirty_begin],
+                                 m_dirty_end - m_dirty_begin) &&
+                       m_file.Flush();
+  // After a flush, the stream can be read without seeking.
+  if (success)
+    m_last_access = HostAccess::None;
+  m_dirty_begin = 0;
+  m_dirty_end = 0;
+  return success;
+}
+
+bool BufferedFile::SeekHost(u64 offset, HostAccess access)
+{
+  if (offset == m_host_position && (access == m_last_access || m_last_access == HostAccess::None))
+    return true;
+
+  ++m_stats.host_seeks;
+  m_last_access = HostAccess::None;
+  if (!m_file.Seek(offset, SEEK_SET))
+    return false;
+  m_host_position = offset;
+  return true;
+}
+
+bool BufferedFile::ReadHost(u64 offset, u8* data, size_t size, size_t* bytes_read)
+{
+  *bytes_read = 0;
+  if (!SeekHost(offset, HostAccess::Read))
+    return false;
+
+  ++m_stats.host_reads;
+  m_last_access = HostAccess::Read;
+  *bytes_read = std::fread(data, 1, size, m_file.GetHandle());
+  m_host_position += *bytes_read;
+  return *bytes_read == size || !std::ferror(m_file.GetHandle());
+}
+
+bool BufferedFile::WriteHost(u64 offset, const u8* data, size_t size)
+{
+  if (!SeekHost(offset, HostAccess::Write))
+    return false;
+
+  ++m_stats.host_writes;
+  m_last_access = HostAccess::Write;
+  if (!m_file.WriteBytes(data, size))
+  {
+    // Where the host file is now isn't known.
+    m_host_position = ~0ULL;
+    return false;
+  }
+  m_host_position += size;
+  return true;
+}
+
+void BufferedFile::DropBuffer()
+{
+  m_buffer.clear();
+  m_buffer_offset = 0;
+  m_dirty_begin = 0;
+  m_dirty_end = 0;
+}
+}  // namespace HLE
+}  // namespace IOS
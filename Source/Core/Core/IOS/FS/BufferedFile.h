@@ -0,0 +1,82 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+
+namespace IOS
+{
+namespace HLE
+{
+// A host file of the emulated NAND, with a window of it kept in memory. Small reads are served
+// from a block that is read ahead, and small writes are collected until they leave the window,
+// so that games which stream their saves in small pieces don't cause a host call per piece.
+// Everything is written to the host file by Flush() and when the object is destroyed.
+class BufferedFile
+{
+public:
+  static constexpr size_t BLOCK_SIZE = 0x4000;
+
+  struct Stats
+  {
+    u64 reads = 0;
+    u64 writes = 0;
+    // Calls to the host that were needed for them.
+    u64 host_reads = 0;
+    u64 host_writes = 0;
+    u64 host_seeks = 0;
+  };
+
+  explicit BufferedFile(const std::string& path);
+  ~BufferedFile();
+
+  BufferedFile(const BufferedFile&) = delete;
+  BufferedFile& operator=(const BufferedFile&) = delete;
+
+  bool IsOpen() const { return m_file.IsOpen(); }
+  // Includes what hasn't been written to the host yet.
+  u64 GetSize() const { return m_size; }
+  const Stats& GetStats() const { return m_stats; }
+
+  // Reads up to the end of the file. Returns false if the host file couldn't be read.
+  bool Read(u64 offset, u8* data, size_t size, size_t* bytes_read);
+  bool Write(u64 offset, const u8* data, size_t size);
+  bool Flush();
+
+private:
+  enum class HostAccess
+  {
+    None,
+    Read,
+    Write,
+  };
+
+  bool SeekHost(u64 offset, HostAccess access);
+  bool ReadHost(u64 offset, u8* data, size_t size, size_t* bytes_read);
+  bool WriteHost(u64 offset, const u8* data, size_t size);
+  void DropBuffer();
+
+  File::IOFile m_file;
+  u64 m_size = 0;
+  // Where the host file is, so that it's only moved when needed.
+  u64 m_host_position = 0;
+  // A stream has to be seeked between a read and a write.
+  HostAccess m_last_access = HostAccess::None;
+
+  // The bytes from m_buffer_offset on, which are up to date. The bytes between m_dirty_begin and
+  // m_dirty_end (relative to m_buffer_offset) still need to be written to the host.
+  std::vector<u8> m_buffer;
+  u64 m_buffer_offset = 0;
+  size_t m_dirty_begin = 0;
+  size_t m_dirty_end = 0;
+
+  Stats m_stats;
+};
+}  // namespace HLE
+}  // namespace IOS
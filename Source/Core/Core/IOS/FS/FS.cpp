@@ -159,6 +159,8 @@ static u64 ComputeTotalFileSize(const File::FSTEntry& parentEntry)
 
 IPCCommandResult FS::IOCtl(const IOCtlRequest& request)
 {
+  // Attributes, renames and deletes act on the host files directly.
+  FlushOpenFiles();
   Memory::Memset(request.buffer_out, 0, request.buffer_out_size);
 
   switch (request.request)
@@ -189,6 +191,7 @@ IPCCommandResult FS::IOCtl(const IOCtlRequest& request)
 
 IPCCommandResult FS::IOCtlV(const IOCtlVRequest& request)
 {
+  FlushOpenFiles();
   switch (request.request)
   {
   case IOCTLV_READ_DIR:
@@ -18,13 +18,14 @@
 #include "Common/NandPaths.h"
 #include "Core/CommonTitles.h"
 #include "Core/HW/Memmap.h"
+#include "Core/IOS/FS/BufferedFile.h"
 #include "Core/IOS/IOS.h"
 
 namespace IOS
 {
 namespace HLE
 {
-static std::map<std::string, std::weak_ptr<File::IOFile>> openFiles;
+static std::map<std::string, std::weak_ptr<BufferedFile>> openFiles;
 
 // This is used by several of the FileIO and /dev/fs functions
 std::string BuildFilename(const std::string& wii_path)
@@ -37,6 +38,15 @@ std::string BuildFilename(const std::string& wii_path)
   return nand_path;
 }
 
+void FlushOpenFiles()
+{
+  for (const auto& entry : openFiles)
+  {
+    if (const std::shared_ptr<BufferedFile> file = entry.second.lock())
+      file->Flush();
+  }
+}
+
 void CreateVirtualFATFilesystem()
 {
   const int cdbSize = 0x01400000;
@@ -134,6 +144,8 @@ void FileIO::OpenFile()
   //    - PokePark 2 (Also gets stuck while loading)
   //    - Wii System Menu (Can't access the system settings, gets stuck on blank screen)
   //    - The Beatles: Rock Band (saving doesn't work)
+  //
+  // Sharing the file also means sharing its buffers, so handles never see stale data.
 
   // Check if the file has already been opened.
   auto search = openFiles.find(m_name);
@@ -145,18 +157,23 @@ void FileIO::OpenFile()
   {
     std::string path = m_name;
     // This code will be called when all references to the shared pointer below have been removed.
-    auto deleter = [path](File::IOFile* ptr) {
-      delete ptr;             // IOFile's deconstructor closes the file.
+    auto deleter = [path](BufferedFile* ptr) {
+      const BufferedFile::Stats& stats = ptr->GetStats();
+      INFO_LOG(IOS_FILEIO, "FileIO: %s had %" PRIu64 " reads and %" PRIu64 " writes, which took "
+                           "%" PRIu64 " host reads, %" PRIu64 " host writes and %" PRIu64 " seeks",
+               path.c_str(), stats.reads, stats.writes, stats.host_reads, stats.host_writes,
+               stats.host_seeks);
+      delete ptr;             // BufferedFile's deconstructor writes back and closes the file.
       openFiles.erase(path);  // erase the weak pointer from the list of open files.
     };
 
     // All files are opened read/write. Actual access rights will be controlled per handle by the
     // read/write functions below
-    m_file = std::shared_ptr<File::IOFile>(new File::IOFile(m_filepath, "r+b"),
+    m_file = std::shared_ptr<BufferedFile>(new BufferedFile(m_filepath),
                                            deleter);  // Use the custom deleter from above.
 
     // Store a weak pointer to our newly opened file in the cache.
-    openFiles[path] = std::weak_ptr<File::IOFile>(m_file);
+    openFiles[path] = std::weak_ptr<BufferedFile>(m_file);
   }
 }
 
@@ -220,12 +237,13 @@ IPCCommandResult FileIO::Read(const ReadWriteRequest& request)
 
   DEBUG_LOG(IOS_FILEIO, "Read 0x%x bytes to 0x%08x from %s", request.size, request.buffer,
             m_name.c_str());
-  m_file->Seek(m_SeekPos, SEEK_SET);  // File might be opened twice, need to seek before we read
-  const u32 number_of_bytes_read = static_cast<u32>(
-      fread(Memory::GetPointer(request.buffer), 1, requested_read_length, m_file->GetHandle()));
-
-  if (number_of_bytes_read != requested_read_length && ferror(m_file->GetHandle()))
+  size_t bytes_read;
+  if (!m_file->Read(m_SeekPos, Memory::GetPointer(request.buffer), requested_read_length,
+                    &bytes_read))
+  {
     return GetDefaultReply(FS_EACCESS);
+  }
+  const u32 number_of_bytes_read = static_cast<u32>(bytes_read);
 
   // IOS returns the number of bytes read and adds that value to the seek position,
   // instead of adding the *requested* read length.
@@ -248,9 +266,7 @@ IPCCommandResult FileIO::Write(const ReadWriteRequest& request)
     {
       DEBUG_LOG(IOS_FILEIO, "FileIO: Write 0x%04x bytes from 0x%08x to %s", request.size,
                 request.buffer, m_name.c_str());
-      m_file->Seek(m_SeekPos,
-                   SEEK_SET);  // File might be opened twice, need to seek before we write
-      if (m_file->WriteBytes(Memory::GetPointer(request.buffer), request.size))
+      if (m_file->Write(m_SeekPos, Memory::GetPointer(request.buffer), request.size))
       {
         return_value = request.size;
         m_SeekPos += request.size;
@@ -288,7 +304,8 @@ IPCCommandResult FileIO::IOCtl(const IOCtlRequest& request)
 void FileIO::PrepareForState(PointerWrap::Mode mode)
 {
   // Temporally close the file, to prevent any issues with the savestating of /tmp
-  // it can be opened again with another call to OpenFile()
+  // it can be opened again with another call to OpenFile(). Closing the last handle of a file
+  // writes back what it has buffered.
   m_file.reset();
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "Common/ChunkFile.h"
@@ -13,17 +14,17 @@
 
 class PointerWrap;
 
-namespace File
-{
-class IOFile;
-}
-
 namespace IOS
 {
 namespace HLE
 {
+class BufferedFile;
+
 std::string BuildFilename(const std::string& wii_path);
 void CreateVirtualFATFilesystem();
+// Writes what open files haven't written to the host yet, for operations that don't go
+// through them.
+void FlushOpenFiles();
 
 namespace Device
 {
@@ -76,7 +77,7 @@ private:
   u32 m_SeekPos = 0;
 
   std::string m_filepath;
-  std::shared_ptr<File::IOFile> m_file;
+  std::shared_ptr<BufferedFile> m_file;
 };
 }  // namespace Device
 }  // namespace HLE
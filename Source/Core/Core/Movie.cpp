@@ -7,8 +7,10 @@
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <cinttypes>
 #include <iomanip>
 #include <iterator>
+#include <map>
 #include <mbedtls/config.h>
 #include <mbedtls/md.h>
 #include <mutex>
@@ -43,6 +45,7 @@
 #include "Core/HW/WiimoteEmu/WiimoteEmu.h"
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/IOS/USB/Bluetooth/WiimoteDevice.h"
+#include "Core/MovieInputLog.h"
 #include "Core/NetPlayProto.h"
 #include "Core/State.h"
 
@@ -66,7 +69,10 @@ static PlayMode s_playMode = MODE_NONE;
 static u8 s_controllers = 0;
 static ControllerState s_padState;
 static DTMHeader tmpHeader;
-static std::vector<u8> s_temp_input;
+// Protects the input log, which the save state thread writes to movies while the CPU thread
+// adds to it.
+static std::mutex s_input_log_lock;
+static InputLog s_input_log;
 static u64 s_currentByte = 0;
 static u64 s_currentFrame = 0, s_totalFrames = 0;  // VI
 static u64 s_currentLagCount = 0;
@@ -104,6 +110,92 @@ static WiiManipFunction s_wii_manip_func;
 
 static std::string s_current_file_name;
 
+// Save states taken every few frames of the movie that is running, by frame, so that seeking
+// only has to run the frames after one of them.
+static std::mutex s_keyframes_lock;
+static std::map<u64, std::string> s_keyframes;
+static u64 s_next_keyframe = 0;
+
+static bool s_seeking = false;
+static u64 s_seek_target = 0;
+static bool s_was_throttler_disabled = false;
+
+static std::string GetInputLogPath()
+{
+  return File::GetUserPath(D_CACHE_IDX) + "MovieInput.bin";
+}
+
+static std::string GetKeyframePath(u64 frame)
+{
+  return StringFromFormat("%sMovieKeyframes" DIR_SEP "%" PRIu64 ".sav",
+                          File::GetUserPath(D_CACHE_IDX).c_str(), frame);
+}
+
+// Deletes the keyframes from the frame on.
+static void DropKeyframes(u64 first_frame)
+{
+  std::lock_guard<std::mutex> lk(s_keyframes_lock);
+  for (auto it = s_keyframes.lower_bound(first_frame); it != s_keyframes.end();)
+  {
+    File::Delete(it->second);
+    it = s_keyframes.erase(it);
+  }
+  s_next_keyframe = 0;
+}
+
+// NOTE: Host Thread
+static void SaveKeyframe()
+{
+  if (!IsMovieActive() || !Core::IsRunningAndStarted())
+    return;
+
+  const bool was_unpaused = Core::PauseAndLock(true);
+
+  const u64 frame = s_currentFrame;
+  const u64 interval = SConfig::GetInstance().m_MovieKeyframeInterval;
+  bool is_needed;
+  {
+    // After seeking back, the frames that are run again may already have keyframes.
+    std::lock_guard<std::mutex> lk(s_keyframes_lock);
+    const auto next = s_keyframes.upper_bound(frame);
+    is_needed = next == s_keyframes.begin() || std::prev(next)->first + interval <= frame;
+  }
+
+  if (is_needed)
+  {
+    const std::string path = GetKeyframePath(frame);
+    File::CreateFullPath(path);
+    State::SaveAsKeyframe(path);
+
+    std::lock_guard<std::mutex> lk(s_keyframes_lock);
+    s_keyframes[frame] = path;
+  }
+
+  Core::PauseAndLock(false, was_unpaused);
+}
+
+static bool ReadInput(u64 offset, void* data, size_t size)
+{
+  std::lock_guard<std::mutex> lk(s_input_log_lock);
+  return s_input_log.Read(offset, data, size);
+}
+
+// NOTE: CPU Thread
+static void WriteInput(const void* data, size_t size)
+{
+  std::lock_guard<std::mutex> lk(s_input_log_lock);
+
+  // Recording after going back in the movie replaces everything that came after.
+  if (s_currentByte < s_input_log.GetSize())
+  {
+    s_input_log.Truncate(s_currentByte);
+    DropKeyframes(s_currentFrame);
+  }
+
+  s_input_log.Write(s_currentByte, data, size);
+  s_currentByte += size;
+}
+
 static bool IsMovieHeader(u8 magic[4])
 {
   return magic[0] == 'D' && magic[1] == 'T' && magic[2] == 'M' && magic[3] == 0x1A;
@@ -198,6 +290,20 @@ void FrameUpdate()
     CPU::Break();
   }
 
+  if (s_seeking && s_currentFrame >= s_seek_target)
+  {
+    s_seeking = false;
+    Core::SetIsThrottlerTempDisabled(s_was_throttler_disabled);
+    CPU::Break();
+  }
+
+  const u64 keyframe_interval = SConfig::GetInstance().m_MovieKeyframeInterval;
+  if (keyframe_interval != 0 && IsMovieActive() && s_currentFrame >= s_next_keyframe)
+  {
+    s_next_keyframe = s_currentFrame + keyframe_interval;
+    Core::QueueHostJob(SaveKeyframe);
+  }
+
   s_bPolled = false;
 }
 
@@ -292,6 +398,48 @@ void DoFrameStep()
   }
 }
 
+// NOTE: Host Thread
+bool SeekToFrame(u64 frame)
+{
+  if (!IsMovieActive() || !Core::IsRunningAndStarted() || frame > s_totalFrames)
+    return false;
+
+  const bool was_unpaused = Core::PauseAndLock(true);
+
+  std::string keyframe_path;
+  u64 keyframe = 0;
+  {
+    std::lock_guard<std::mutex> lk(s_keyframes_lock);
+    auto it = s_keyframes.upper_bound(frame);
+    if (it != s_keyframes.begin())
+    {
+      --it;
+      keyframe = it->first;
+      keyframe_path = it->second;
+    }
+  }
+
+  bool success = true;
+  if (frame < s_currentFrame || (!keyframe_path.empty() && keyframe > s_currentFrame))
+  {
+    success = !keyframe_path.empty() && State::LoadKeyframe(keyframe_path);
+    s_next_keyframe = 0;
+  }
+
+  // The frames up to the target are run as fast as possible, and emulation pauses there.
+  if (success && s_currentFrame < frame)
+  {
+    if (!s_seeking)
+      s_was_throttler_disabled = Core::GetIsThrottlerTempDisabled();
+    s_seeking = true;
+    s_seek_target = frame;
+    Core::SetIsThrottlerTempDisabled(true);
+  }
+
+  Core::PauseAndLock(false, was_unpaused || s_seeking);
+  return success;
+}
+
 // NOTE: Host Thread
 void SetReadOnly(bool bEnabled)
 {
@@ -371,6 +519,11 @@ u64 GetTotalLagCount()
   return s_totalLagCount;
 }
 
+u64 GetTotalTickCount()
+{
+  return s_totalTickCount;
+}
+
 void SetClearSave(bool enabled)
 {
   s_bClearSave = enabled;
@@ -598,7 +751,11 @@ bool BeginRecordingInput(int controllers)
 
   s_playMode = MODE_RECORDING;
   s_author = SConfig::GetInstance().m_strMovieAuthor;
-  s_temp_input.clear();
+  {
+    std::lock_guard<std::mutex> lk(s_input_log_lock);
+    s_input_log.Reset(GetInputLogPath());
+  }
+  DropKeyframes(0);
 
   s_currentByte = 0;
 
@@ -864,9 +1021,7 @@ void RecordInput(GCPadStatus* PadStatus, int controllerID)
 
   CheckPadStatus(PadStatus, controllerID);
 
-  s_temp_input.resize(s_currentByte + sizeof(ControllerState));
-  memcpy(&s_temp_input[s_currentByte], &s_padState, sizeof(ControllerState));
-  s_currentByte += sizeof(ControllerState);
+  WriteInput(&s_padState, sizeof(ControllerState));
 }
 
 // NOTE: CPU Thread
@@ -885,10 +1040,8 @@ void RecordWiimote(int wiimote, u8* data, u8 size)
     return;
 
   InputUpdate();
-  s_temp_input.resize(s_currentByte + size + 1);
-  s_temp_input[s_currentByte++] = size;
-  memcpy(&s_temp_input[s_currentByte], data, size);
-  s_currentByte += size;
+  WriteInput(&size, 1);
+  WriteInput(data, size);
 }
 
 // NOTE: EmuThread / Host Thread
@@ -961,8 +1114,12 @@ bool PlayInput(const std::string& filename)
 
   Core::UpdateWantDeterminism();
 
-  s_temp_input.resize(recording_file.GetSize() - 256);
-  recording_file.ReadBytes(s_temp_input.data(), s_temp_input.size());
+  {
+    std::lock_guard<std::mutex> lk(s_input_log_lock);
+    s_input_log.Reset(GetInputLogPath());
+    s_input_log.ReadFrom(recording_file, recording_file.GetSize() - 256);
+  }
+  DropKeyframes(0);
   s_currentByte = 0;
   recording_file.Close();
 
@@ -1037,41 +1194,58 @@ void LoadInput(const std::string& filename)
     afterEnd = true;
   }
 
-  if (!s_bReadOnly || s_temp_input.empty())
+  if (!s_bReadOnly || s_input_log.IsEmpty())
   {
     s_totalFrames = tmpHeader.frameCount;
     s_totalLagCount = tmpHeader.lagCount;
     s_totalInputCount = tmpHeader.inputCount;
     s_totalTickCount = s_tickCountAtLastInput = tmpHeader.tickCount;
 
-    s_temp_input.resize(static_cast<size_t>(totalSavedBytes));
-    t_record.ReadBytes(s_temp_input.data(), s_temp_input.size());
+    {
+      std::lock_guard<std::mutex> lk(s_input_log_lock);
+      s_input_log.Reset(GetInputLogPath());
+      s_input_log.ReadFrom(t_record, totalSavedBytes);
+    }
+    // The keyframes were taken with the inputs that were just replaced.
+    DropKeyframes(0);
   }
   else if (s_currentByte > 0)
   {
     if (s_currentByte > totalSavedBytes)
     {
     }
-    else if (s_currentByte > s_temp_input.size())
+    else if (s_currentByte > s_input_log.GetSize())
     {
       afterEnd = true;
       PanicAlertT("Warning: You loaded a save that's after the end of the current movie. (byte %u "
-                  "> %zu) (input %u > %u). You should load another save before continuing, or load "
+                  "> %u) (input %u > %u). You should load another save before continuing, or load "
                   "this state with read-only mode off.",
-                  (u32)s_currentByte + 256, s_temp_input.size() + 256, (u32)s_currentInputCount,
-                  (u32)s_totalInputCount);
+                  (u32)s_currentByte + 256, (u32)s_input_log.GetSize() + 256,
+                  (u32)s_currentInputCount, (u32)s_totalInputCount);
     }
-    else if (s_currentByte > 0 && !s_temp_input.empty())
+    else if (s_currentByte > 0 && !s_input_log.IsEmpty())
     {
-      // verify identical from movie start to the save's current frame
-      std::vector<u8> movInput(s_currentByte);
-      t_record.ReadArray(movInput.data(), movInput.size());
-
-      const auto result = std::mismatch(movInput.begin(), movInput.end(), s_temp_input.begin());
+      // verify identical from movie start to the save's current frame, a chunk at a time
+      std::vector<u8> movInput(InputLog::CHUNK_SIZE);
+      std::vector<u8> curInput(InputLog::CHUNK_SIZE);
+      u64 mismatch_offset = s_currentByte;
+      for (u64 offset = 0; offset < s_currentByte && mismatch_offset == s_currentByte;
+           offset += InputLog::CHUNK_SIZE)
+      {
+        const size_t count =
+            static_cast<size_t>(std::min(u64{InputLog::CHUNK_SIZE}, s_currentByte - offset));
+        t_record.ReadBytes(movInput.data(), count);
+        ReadInput(offset, curInput.data(), count);
+
+        const auto result =
+            std::mismatch(movInput.begin(), movInput.begin() + count, curInput.begin());
+        if (result.first != movInput.begin() + count)
+          mismatch_offset = offset + std::distance(movInput.begin(), result.first);
+      }
 
-      if (result.first != movInput.end())
+      if (mismatch_offset != s_currentByte)
       {
-        const ptrdiff_t mismatch_index = std::distance(movInput.begin(), result.first);
+        const ptrdiff_t mismatch_index = static_cast<ptrdiff_t>(mismatch_offset);
 
         // this is a "you did something wrong" alert for the user's benefit.
         // we'll try to say what's going on in excruciating detail, otherwise the user might not
@@ -1086,17 +1260,24 @@ void LoadInput(const std::string& filename)
                       "read-only mode off. Otherwise you'll probably get a desync.",
                       byte_offset, byte_offset);
 
-          std::copy(movInput.begin(), movInput.end(), s_temp_input.begin());
+          std::lock_guard<std::mutex> lk(s_input_log_lock);
+          t_record.Seek(sizeof(DTMHeader), SEEK_SET);
+          for (u64 offset = 0; offset < s_currentByte; offset += InputLog::CHUNK_SIZE)
+          {
+            const size_t count =
+                static_cast<size_t>(std::min(u64{InputLog::CHUNK_SIZE}, s_currentByte - offset));
+            t_record.ReadBytes(movInput.data(), count);
+            s_input_log.Write(offset, movInput.data(), count);
+          }
         }
         else
         {
           const ptrdiff_t frame = mismatch_index / sizeof(ControllerState);
           ControllerState curPadState;
-          memcpy(&curPadState, &s_temp_input[frame * sizeof(ControllerState)],
-                 sizeof(ControllerState));
+          ReadInput(frame * sizeof(ControllerState), &curPadState, sizeof(ControllerState));
           ControllerState movPadState;
-          memcpy(&movPadState, &s_temp_input[frame * sizeof(ControllerState)],
-                 sizeof(ControllerState));
+          t_record.Seek(sizeof(DTMHeader) + frame * sizeof(ControllerState), SEEK_SET);
+          t_record.ReadArray(&movPadState, 1);
           PanicAlertT(
               "Warning: You loaded a save whose movie mismatches on frame %td. You should load "
               "another save before continuing, or load this state with read-only mode off. "
@@ -1161,7 +1342,7 @@ void LoadInput(const std::string& filename)
 // NOTE: CPU Thread
 static void CheckInputEnd()
 {
-  if (s_currentByte >= s_temp_input.size() ||
+  if (s_currentByte >= s_input_log.GetSize() ||
       (CoreTiming::GetTicks() > s_totalTickCount && !IsRecordingInputFromSaveState()))
   {
     EndPlayInput(!s_bReadOnly);
@@ -1173,13 +1354,13 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 {
   // Correct playback is entirely dependent on the emulator polling the controllers
   // in the same order done during recording
-  if (!IsPlayingInput() || !IsUsingPad(controllerID) || s_temp_input.empty())
+  if (!IsPlayingInput() || !IsUsingPad(controllerID) || s_input_log.IsEmpty())
     return;
 
-  if (s_currentByte + sizeof(ControllerState) > s_temp_input.size())
+  if (s_currentByte + sizeof(ControllerState) > s_input_log.GetSize())
   {
-    PanicAlertT("Premature movie end in PlayController. %u + %zu > %zu", (u32)s_currentByte,
-                sizeof(ControllerState), s_temp_input.size());
+    PanicAlertT("Premature movie end in PlayController. %u + %zu > %u", (u32)s_currentByte,
+                sizeof(ControllerState), (u32)s_input_log.GetSize());
     EndPlayInput(!s_bReadOnly);
     return;
   }
@@ -1190,7 +1371,7 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
   memset(PadStatus, 0, sizeof(GCPadStatus));
   PadStatus->err = e;
 
-  memcpy(&s_padState, &s_temp_input[s_currentByte], sizeof(ControllerState));
+  ReadInput(s_currentByte, &s_padState, sizeof(ControllerState));
   s_currentByte += sizeof(ControllerState);
 
   PadStatus->triggerLeft = s_padState.TriggerL;
@@ -1274,21 +1455,20 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 bool PlayWiimote(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf, int ext,
                  const wiimote_key key)
 {
-  if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || s_temp_input.empty())
+  if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || s_input_log.IsEmpty())
     return false;
 
-  if (s_currentByte > s_temp_input.size())
+  u8 sizeInMovie;
+  if (!ReadInput(s_currentByte, &sizeInMovie, 1))
   {
-    PanicAlertT("Premature movie end in PlayWiimote. %u > %zu", (u32)s_currentByte,
-                s_temp_input.size());
+    PanicAlertT("Premature movie end in PlayWiimote. %u >= %u", (u32)s_currentByte,
+                (u32)s_input_log.GetSize());
     EndPlayInput(!s_bReadOnly);
     return false;
   }
 
   u8 size = rptf.size;
 
-  u8 sizeInMovie = s_temp_input[s_currentByte];
-
   if (size != sizeInMovie)
   {
     PanicAlertT("Fatal desync. Aborting playback. (Error in PlayWiimote: %u != %u, byte %u.)%s",
@@ -1303,15 +1483,15 @@ bool PlayWiimote(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf,
 
   s_currentByte++;
 
-  if (s_currentByte + size > s_temp_input.size())
+  if (s_currentByte + size > s_input_log.GetSize())
   {
-    PanicAlertT("Premature movie end in PlayWiimote. %u + %d > %zu", (u32)s_currentByte, size,
-                s_temp_input.size());
+    PanicAlertT("Premature movie end in PlayWiimote. %u + %d > %u", (u32)s_currentByte, size,
+                (u32)s_input_log.GetSize());
     EndPlayInput(!s_bReadOnly);
     return false;
   }
 
-  memcpy(data, &s_temp_input[s_currentByte], size);
+  ReadInput(s_currentByte, data, size);
   s_currentByte += size;
 
   s_currentInputCount++;
@@ -1415,7 +1595,11 @@ void SaveRecording(const std::string& filename)
 
   save_record.WriteArray(&header, 1);
 
-  bool success = save_record.WriteBytes(s_temp_input.data(), s_temp_input.size());
+  bool success;
+  {
+    std::lock_guard<std::mutex> lk(s_input_log_lock);
+    success = s_input_log.WriteTo(save_record);
+  }
 
   if (success && s_bRecordingFromSaveState)
   {
@@ -1576,6 +1760,10 @@ static void GetMD5()
 void Shutdown()
 {
   s_currentInputCount = s_totalInputCount = s_totalFrames = s_tickCountAtLastInput = 0;
-  s_temp_input.clear();
+  {
+    std::lock_guard<std::mutex> lk(s_input_log_lock);
+    s_input_log.Clear();
+  }
+  DropKeyframes(0);
 }
 };
@@ -131,6 +131,7 @@ u64 GetCurrentInputCount();
 u64 GetTotalInputCount();
 u64 GetCurrentLagCount();
 u64 GetTotalLagCount();
+u64 GetTotalTickCount();
 
 void SetClearSave(bool enabled);
 void SignalDiscChange(const std::string& new_path);
@@ -158,6 +159,9 @@ void ChangePads(bool instantly = false);
 void ChangeWiiPads(bool instantly = false);
 
 void DoFrameStep();
+// Jumps to a frame of the movie that is running by loading the closest keyframe before it and
+// running the frames after it, then pauses. Returns false if there is no way to get there.
+bool SeekToFrame(u64 frame);
 void SetReadOnly(bool bEnabled);
 
 bool BeginRecordingInput(int controllers);
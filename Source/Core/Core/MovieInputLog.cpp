@@ -0,0 +1,188 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/MovieInputLog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "Common/Assert.h"
+#include "Common/FileUtil.h"
+
+namespace Movie
+{
+InputLog::~InputLog()
+{
+  Clear();
+}
+
+void InputLog::Reset(const std::string& scratch_path)
+{
+  Clear();
+
+  m_scratch_path = scratch_path;
+  File::CreateFullPath(m_scratch_path);
+  m_spill = m_scratch.Open(m_scratch_path, "w+b");
+  m_tail.reserve(CHUNK_SIZE);
+}
+
+void InputLog::Clear()
+{
+  m_scratch.Close();
+  m_spill = false;
+  if (!m_scratch_path.empty() && File::Exists(m_scratch_path))
+    File::Delete(m_scratch_path);
+  m_scratch_path.clear();
+
+  m_size = 0;
+  m_flushed = 0;
+  std::vector<u8>().swap(m_tail);
+  m_cached_chunk = NO_CHUNK;
+}
+
+bool InputLog::Read(u64 offset, void* data, size_t size)
+{
+  if (offset + size > m_size)
+    return false;
+
+  u8* out = static_cast<u8*>(data);
+  while (size != 0)
+  {
+    size_t count;
+    if (offset >= m_flushed)
+    {
+      count = size;
+      std::memcpy(out, &m_tail[offset - m_flushed], count);
+    }
+    else
+    {
+      const size_t offset_in_chunk = offset % CHUNK_SIZE;
+      count = std::min(size, CHUNK_SIZE - offset_in_chunk);
+      const u8* chunk = GetChunk(offset / CHUNK_SIZE);
+      if (!chunk)
+        return false;
+      std::memcpy(out, chunk + offset_in_chunk, count);
+    }
+
+    out += count;
+    offset += count;
+    size -= count;
+  }
+  return true;
+}
+
+void InputLog::Write(u64 offset, const void* data, size_t size)
+{
+  _assert_(offset <= m_size);
+
+  const u8* in = static_cast<const u8*>(data);
+  while (size != 0)
+  {
+    size_t count;
+    if (offset >= m_flushed)
+    {
+      const size_t offset_in_tail = static_cast<size_t>(offset - m_flushed);
+      count = m_spill ? std::min(size, CHUNK_SIZE - offset_in_tail) : size;
+      if (offset_in_tail + count > m_tail.size())
+        m_tail.resize(offset_in_tail + count);
+      std::memcpy(&m_tail[offset_in_tail], in, count);
+      m_size = std::max(m_size, offset + count);
+
+      if (m_tail.size() == CHUNK_SIZE && m_spill)
+        FlushTail();
+    }
+    else
+    {
+      count = static_cast<size_t>(std::min<u64>(size, m_flushed - offset));
+      m_scratch.Seek(offset, SEEK_SET);
+      m_scratch.WriteBytes(in, count);
+      m_cached_chunk = NO_CHUNK;
+    }
+
+    in += count;
+    offset += count;
+    size -= count;
+  }
+}
+
+void InputLog::Truncate(u64 size)
+{
+  if (size >= m_size)
+    return;
+
+  if (size >= m_flushed)
+  {
+    m_tail.resize(static_cast<size_t>(size - m_flushed));
+  }
+  else
+  {
+    // The chunk the new end is in becomes the tail again.
+    const u64 chunk = size / CHUNK_SIZE;
+    const u8* data = GetChunk(chunk);
+    m_tail.assign(data, data + (data ? size % CHUNK_SIZE : 0));
+    m_flushed = chunk * CHUNK_SIZE;
+    m_cached_chunk = NO_CHUNK;
+  }
+  m_size = m_flushed + m_tail.size();
+}
+
+bool InputLog::ReadFrom(File::IOFile& file, u64 size)
+{
+  Truncate(0);
+
+  std::vector<u8> buffer(CHUNK_SIZE);
+  while (m_size < size)
+  {
+    const size_t count = static_cast<size_t>(std::min(u64{CHUNK_SIZE}, size - m_size));
+    if (!file.ReadBytes(buffer.data(), count))
+      return false;
+    Write(m_size, buffer.data(), count);
+  }
+  return true;
+}
+
+bool InputLog::WriteTo(File::IOFile& file)
+{
+  for (u64 chunk = 0; chunk < m_flushed / CHUNK_SIZE; ++chunk)
+  {
+    const u8* data = GetChunk(chunk);
+    if (!data || !file.WriteBytes(data, CHUNK_SIZE))
+      return false;
+  }
+  return file.WriteBytes(m_tail.data(), m_tail.size());
+}
+
+void InputLog::FlushTail()
+{
+  if (!m_scratch.Seek(m_flushed, SEEK_SET) || !m_scratch.WriteBytes(m_tail.data(), CHUNK_SIZE))
+  {
+    // Keep everything after this in memory, e.g. if the disk is full.
+    m_scratch.Clear();
+    m_spill = false;
+    return;
+  }
+
+  m_flushed += CHUNK_SIZE;
+  m_tail.clear();
+}
+
+const u8* InputLog::GetChunk(u64 chunk)
+{
+  if (chunk == m_cached_chunk)
+    return m_cache.data();
+
+  m_cache.resize(CHUNK_SIZE);
+  if (!m_scratch.Seek(chunk * CHUNK_SIZE, SEEK_SET) ||
+      !m_scratch.ReadBytes(m_cache.data(), CHUNK_SIZE))
+  {
+    m_scratch.Clear();
+    m_cached_chunk = NO_CHUNK;
+    return nullptr;
+  }
+
+  m_cached_chunk = chunk;
+  return m_cache.data();
+}
+}
@@ -0,0 +1,70 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+
+namespace Movie
+{
+// The input data of a movie, which grows with every poll while recording. Only the chunk that is
+// being appended to and the chunk that was read last are kept in memory; everything else is in a
+// scratch file, so hours of recording don't take more memory than a few minutes. Without a
+// scratch file, everything stays in memory.
+class InputLog
+{
+public:
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  InputLog() = default;
+  ~InputLog();
+
+  InputLog(const InputLog&) = delete;
+  InputLog& operator=(const InputLog&) = delete;
+
+  // Starts over without data, keeping what doesn't fit in memory in the file at the path.
+  void Reset(const std::string& scratch_path);
+  // Forgets the data and deletes the scratch file.
+  void Clear();
+
+  u64 GetSize() const { return m_size; }
+  bool IsEmpty() const { return m_size == 0; }
+
+  // Returns false if the bytes go past the end.
+  bool Read(u64 offset, void* data, size_t size);
+  // Overwrites the bytes at the offset, which must be at most the size, and grows if needed.
+  void Write(u64 offset, const void* data, size_t size);
+  // Drops everything from the offset on.
+  void Truncate(u64 size);
+
+  // Replaces the data with the next size bytes of the file.
+  bool ReadFrom(File::IOFile& file, u64 size);
+  // Writes all data to the file at its current position.
+  bool WriteTo(File::IOFile& file);
+
+private:
+  static constexpr u64 NO_CHUNK = ~0ULL;
+
+  void FlushTail();
+  const u8* GetChunk(u64 chunk);
+
+  std::string m_scratch_path;
+  File::IOFile m_scratch;
+  // Whether full chunks go to the scratch file.
+  bool m_spill = false;
+
+  u64 m_size = 0;
+  // Bytes before this are in the scratch file, which only holds whole chunks.
+  u64 m_flushed = 0;
+  // Bytes from m_flushed to the end.
+  std::vector<u8> m_tail;
+
+  u64 m_cached_chunk = NO_CHUNK;
+  std::vector<u8> m_cache;
+};
+}
@@ -9,7 +9,9 @@
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <mbedtls/md5.h>
 
@@ -17,6 +19,8 @@
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/ENetUtil.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
 #include "Common/MD5.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
@@ -30,6 +34,7 @@
 #include "Core/HW/WiimoteReal/WiimoteReal.h"
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/Movie.h"
+#include "Core/Rollback.h"
 #include "InputCommon/GCAdapter.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoConfig.h"
@@ -38,6 +43,80 @@ static std::mutex crit_netplay_client;
 static NetPlayClient* netplay_client = nullptr;
 NetSettings g_NetPlaySettings;
 
+// called from ---CPU--- thread
+static void RollbackSafePoint()
+{
+  std::lock_guard<std::mutex> lk(crit_netplay_client);
+
+  if (netplay_client)
+    netplay_client->OnRollbackSafePoint();
+}
+
+// Games are only hashed again when their size or modification time changed. Each line of the cache
+// holds the hash, size, modification time and path of a file.
+struct HashCacheEntry
+{
+  std::string hash;
+  u64 size;
+  u64 time;
+  std::string path;
+};
+
+static std::string GetHashCachePath()
+{
+  return File::GetUserPath(D_CACHE_IDX) + "NetPlayHashes.txt";
+}
+
+static std::vector<HashCacheEntry> ReadHashCache()
+{
+  std::vector<HashCacheEntry> entries;
+  std::ifstream cache;
+  File::OpenFStream(cache, GetHashCachePath(), std::ios_base::in);
+
+  std::string line;
+  while (std::getline(cache, line))
+  {
+    std::istringstream stream(line);
+    HashCacheEntry entry;
+    if (stream >> entry.hash >> entry.size >> entry.time && stream.get() == ' ' &&
+        std::getline(stream, entry.path))
+    {
+      entries.push_back(std::move(entry));
+    }
+  }
+  return entries;
+}
+
+static std::string GetCachedHash(const std::string& file)
+{
+  const File::FileInfo info(file);
+  for (const HashCacheEntry& entry : ReadHashCache())
+  {
+    if (entry.path == file && entry.size == info.GetSize() &&
+        entry.time == info.GetModificationTime())
+    {
+      return entry.hash;
+    }
+  }
+  return "";
+}
+
+static void CacheHash(const std::string& file, const std::string& hash)
+{
+  std::vector<HashCacheEntry> entries = ReadHashCache();
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [&file](const HashCacheEntry& entry) { return entry.path == file; }),
+                entries.end());
+  const File::FileInfo info(file);
+  entries.push_back({hash, info.GetSize(), info.GetModificationTime(), file});
+
+  File::CreateFullPath(GetHashCachePath());
+  std::ofstream cache;
+  File::OpenFStream(cache, GetHashCachePath(), std::ios_base::out | std::ios_base::trunc);
+  for (const HashCacheEntry& entry : entries)
+    cache << entry.hash << ' ' << entry.size << ' ' << entry.time << ' ' << entry.path << '\n';
+}
+
 // called from ---GUI--- thread
 NetPlayClient::~NetPlayClient()
 {
@@ -322,33 +401,36 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 
   case NP_MSG_PAD_DATA:
   {
-    PadMapping map = 0;
-    GCPadStatus pad;
-    packet >> map >> pad.button >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >>
-        pad.substickX >> pad.substickY >> pad.triggerLeft >> pad.triggerRight;
-
-    // Trusting server for good map value (>=0 && <4)
-    // add to pad buffer
-    m_pad_buffer.at(map).Push(pad);
+    u16 count = 0;
+    packet >> count;
+    for (u16 i = 0; i < count; ++i)
+    {
+      PadMapping map = 0;
+      GCPadStatus pad;
+      if (!m_input_decoder.DecodePad(packet, &map, &pad))
+        break;
+
+      // add to pad buffer
+      m_pad_buffer[map].Push(pad);
+    }
     m_gc_pad_event.Set();
   }
   break;
 
   case NP_MSG_WIIMOTE_DATA:
   {
-    PadMapping map = 0;
-    NetWiimote nw;
-    u8 size;
-    packet >> map >> size;
-
-    nw.resize(size);
-
-    for (unsigned int i = 0; i < size; ++i)
-      packet >> nw[i];
+    u16 count = 0;
+    packet >> count;
+    for (u16 i = 0; i < count; ++i)
+    {
+      PadMapping map = 0;
+      NetWiimote nw;
+      if (!m_input_decoder.DecodeWiimote(packet, &map, &nw))
+        break;
 
-    // Trusting server for good map value (>=0 && <4)
-    // add to Wiimote buffer
-    m_wiimote_buffer.at(map).Push(nw);
+      // add to Wiimote buffer
+      m_wiimote_buffer[map].Push(nw);
+    }
     m_wii_pad_event.Set();
   }
   break;
@@ -407,6 +489,8 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
     {
       std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
       packet >> m_current_game;
+      // The server starts encoding from scratch before it sends this.
+      m_input_decoder.Reset();
       packet >> g_NetPlaySettings.m_CPUthread;
       packet >> g_NetPlaySettings.m_CPUcore;
       packet >> g_NetPlaySettings.m_EnableCheats;
@@ -746,28 +830,26 @@ void NetPlayClient::SendChatMessage(const std::string& msg)
 }
 
 // called from ---CPU--- thread
-void NetPlayClient::SendPadState(const int in_game_pad, const GCPadStatus& pad)
+void NetPlayClient::SendPadStates(const std::vector<std::pair<PadMapping, GCPadStatus>>& pads)
 {
   sf::Packet packet;
   packet << static_cast<MessageId>(NP_MSG_PAD_DATA);
-  packet << static_cast<PadMapping>(in_game_pad);
-  packet << pad.button << pad.analogA << pad.analogB << pad.stickX << pad.stickY << pad.substickX
-         << pad.substickY << pad.triggerLeft << pad.triggerRight;
+  packet << static_cast<u16>(pads.size());
+  for (const auto& pad : pads)
+    m_input_encoder.EncodePad(packet, pad.first, pad.second);
 
   SendAsync(std::move(packet));
 }
 
 // called from ---CPU--- thread
-void NetPlayClient::SendWiimoteState(const int in_game_pad, const NetWiimote& nw)
+void NetPlayClient::SendWiimoteStates(
+    const std::vector<std::pair<PadMapping, NetWiimote>>& wiimotes)
 {
   sf::Packet packet;
   packet << static_cast<MessageId>(NP_MSG_WIIMOTE_DATA);
-  packet << static_cast<PadMapping>(in_game_pad);
-  packet << static_cast<u8>(nw.size());
-  for (auto it : nw)
-  {
-    packet << it;
-  }
+  packet << static_cast<u16>(wiimotes.size());
+  for (const auto& wiimote : wiimotes)
+    m_input_encoder.EncodeWiimote(packet, wiimote.first, wiimote.second);
 
   SendAsync(std::move(packet));
 }
@@ -795,6 +877,8 @@ void NetPlayClient::SendStopGamePacket()
 bool NetPlayClient::StartGame(const std::string& path)
 {
   std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+  // The server decodes our inputs from scratch once it gets the start game packet.
+  m_input_encoder.Reset();
   SendStartGamePacket();
 
   if (m_is_running.IsSet())
@@ -805,6 +889,19 @@ bool NetPlayClient::StartGame(const std::string& path)
 
   m_timebase_frame = 0;
 
+  // Rollback needs the GPU to be emulated on the CPU thread, and can't undo a recording.
+  m_rollback = m_dialog->IsRollbackEnabled() && !g_NetPlaySettings.m_CPUthread &&
+               !m_dialog->IsRecording();
+  m_rollback_inputs.Reset();
+  m_snapshots.Clear();
+  m_snapshot_infos.clear();
+  m_next_snapshot_id = 0;
+  m_snapshot_requested = false;
+  m_pending_timebases.clear();
+  m_timebase_frames_sent = 0;
+  Rollback::SetReplaying(false);
+  Rollback::SetSafePointCallback(m_rollback ? RollbackSafePoint : nullptr);
+
   m_is_running.Set();
   NetPlay_Enable(this);
 
@@ -965,8 +1062,12 @@ bool NetPlayClient::GetNetPads(const int pad_nb, GCPadStatus* pad_status)
   // will be polled as well. To reduce latency, we poll all local
   // controllers at once and then send the status to the other
   // clients.
-  if (IsFirstInGamePad(pad_nb))
+  //
+  // Polls that are replayed after a rollback already have their local states.
+  if (IsFirstInGamePad(pad_nb) && !(m_rollback && m_rollback_inputs.IsReplaying(pad_nb)))
   {
+    // All the states of this poll go out in one packet.
+    std::vector<std::pair<PadMapping, GCPadStatus>> sent_pads;
     const int num_local_pads = NumLocalPads();
     for (int local_pad = 0; local_pad < num_local_pads; local_pad++)
     {
@@ -990,10 +1091,21 @@ bool NetPlayClient::GetNetPads(const int pad_nb, GCPadStatus* pad_status)
         // add to buffer
         m_pad_buffer[ingame_pad].Push(*pad_status);
 
-        // send
-        SendPadState(ingame_pad, *pad_status);
+        sent_pads.emplace_back(static_cast<PadMapping>(ingame_pad), *pad_status);
       }
     }
+
+    if (!sent_pads.empty())
+      SendPadStates(sent_pads);
+  }
+
+  if (m_rollback)
+  {
+    // Take a snapshot at the next safe point, between this poll and the next one.
+    if (IsFirstInGamePad(pad_nb))
+      m_snapshot_requested = true;
+
+    return GetRollbackPad(pad_nb, pad_status);
   }
 
   // Now, we either use the data pushed earlier, or wait for the
@@ -1023,6 +1135,153 @@ bool NetPlayClient::GetNetPads(const int pad_nb, GCPadStatus* pad_status)
   return true;
 }
 
+// called from ---CPU--- thread
+bool NetPlayClient::GetRollbackPad(int pad_nb, GCPadStatus* pad_status)
+{
+  while (true)
+  {
+    // Check the predictions against the states that have arrived since.
+    while (m_rollback_inputs.HasUnconfirmed(pad_nb) && m_pad_buffer[pad_nb].Size())
+    {
+      GCPadStatus actual;
+      m_pad_buffer[pad_nb].Pop(actual);
+      m_rollback_inputs.Confirm(pad_nb, actual);
+    }
+    SendConfirmedTimeBases();
+
+    if (m_rollback_inputs.IsReplaying(pad_nb))
+    {
+      *pad_status = m_rollback_inputs.Replay(pad_nb);
+      return true;
+    }
+
+    // Once everything is confirmed, new states are used as they are.
+    if (m_pad_buffer[pad_nb].Size())
+    {
+      m_pad_buffer[pad_nb].Pop(*pad_status);
+      m_rollback_inputs.AddConfirmed(pad_nb, *pad_status);
+      return true;
+    }
+
+    if (CanPredictPad(pad_nb))
+    {
+      *pad_status = m_rollback_inputs.Predict(pad_nb);
+      return true;
+    }
+
+    if (!m_is_running.IsSet())
+      return false;
+
+    m_gc_pad_event.Wait();
+  }
+}
+
+// called from ---CPU--- thread
+bool NetPlayClient::CanPredictPad(int pad_nb) const
+{
+  if (m_pad_map[pad_nb] == m_local_player->pid || !m_rollback_inputs.CanPredict(pad_nb))
+    return false;
+
+  // The oldest snapshot has to be from before the first poll that isn't confirmed, or a wrong
+  // prediction couldn't be rolled back.
+  return !m_snapshot_infos.empty() &&
+         m_snapshot_infos.front().polls[pad_nb] <=
+             m_rollback_inputs.GetConfirmedCounts()[pad_nb];
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::OnRollbackSafePoint()
+{
+  // Wii games aren't supported, as Wiimotes can't be predicted.
+  if (SConfig::GetInstance().bWii)
+    return;
+
+  if (m_rollback_inputs.NeedsRollback())
+  {
+    const auto& limit = m_rollback_inputs.GetRollbackLimit();
+    const auto is_before_limit = [&limit](const SnapshotInfo& info) {
+      for (size_t i = 0; i < limit.size(); ++i)
+      {
+        if (info.polls[i] > limit[i])
+          return false;
+      }
+      return true;
+    };
+
+    const auto it = std::find_if(m_snapshot_infos.rbegin(), m_snapshot_infos.rend(),
+                                 is_before_limit);
+    if (it == m_snapshot_infos.rend() || !m_snapshots.Load(it->id))
+    {
+      // Can't happen as long as predictions stay within the snapshots. The desync detection
+      // will tell the players if it does.
+      ERROR_LOG(NETPLAY, "No snapshot to roll back to");
+      m_rollback_inputs.Rewind(m_rollback_inputs.GetPollCounts());
+    }
+    else
+    {
+      const SnapshotInfo info = *it;
+      m_snapshot_infos.erase(it.base(), m_snapshot_infos.end());
+
+      m_rollback_inputs.Rewind(info.polls);
+      m_timebase_frame = info.timebase_frame;
+      while (!m_pending_timebases.empty() &&
+             m_pending_timebases.back().frame >= info.timebase_frame)
+      {
+        m_pending_timebases.pop_back();
+      }
+
+      m_snapshot_requested = false;
+      Rollback::SetReplaying(true);
+      return;
+    }
+  }
+
+  if (Rollback::IsReplaying() && !m_rollback_inputs.IsReplaying())
+    Rollback::SetReplaying(false);
+
+  if (!m_snapshot_requested)
+    return;
+  m_snapshot_requested = false;
+
+  if (m_snapshot_infos.size() == m_snapshots.GetCapacity())
+    m_snapshot_infos.pop_front();
+  m_snapshots.Save(m_next_snapshot_id);
+  m_snapshot_infos.push_back(
+      {m_next_snapshot_id++, m_rollback_inputs.GetPollCounts(), m_timebase_frame});
+
+  // Nothing older than the oldest snapshot can be replayed.
+  m_rollback_inputs.Forget(m_snapshot_infos.front().polls);
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::SendConfirmedTimeBases()
+{
+  const auto confirmed = m_rollback_inputs.GetConfirmedCounts();
+  while (!m_pending_timebases.empty())
+  {
+    const PendingTimeBase& pending = m_pending_timebases.front();
+    for (size_t i = 0; i < confirmed.size(); ++i)
+    {
+      if (pending.polls[i] > confirmed[i])
+        return;
+    }
+
+    // Frames that are replayed after their timebase went out are the same as before.
+    if (pending.frame >= m_timebase_frames_sent)
+    {
+      sf::Packet packet;
+      packet << static_cast<MessageId>(NP_MSG_TIMEBASE);
+      packet << static_cast<u32>(pending.timebase);
+      packet << static_cast<u32>(pending.timebase << 32);
+      packet << pending.frame;
+      SendAsync(std::move(packet));
+      m_timebase_frames_sent = pending.frame + 1;
+    }
+
+    m_pending_timebases.pop_front();
+  }
+}
+
 // called from ---CPU--- thread
 bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size, u8 reporting_mode)
 {
@@ -1034,15 +1293,18 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size, u8 repor
     if (m_wiimote_map[_number] == m_local_player->pid)
     {
       nw.assign(data, data + size);
+      std::vector<std::pair<PadMapping, NetWiimote>> sent_wiimotes;
       do
       {
         // add to buffer
         m_wiimote_buffer[_number].Push(nw);
 
-        SendWiimoteState(_number, nw);
+        sent_wiimotes.emplace_back(static_cast<PadMapping>(_number), nw);
       } while (m_wiimote_buffer[_number].Size() <=
                m_target_buffer_size * 200 /
                    120);  // TODO: add a seperate setting for wiimote buffer?
+
+      SendWiimoteStates(sent_wiimotes);
     }
 
   }  // unlock players
@@ -1198,6 +1460,15 @@ void NetPlayClient::SendTimeBase()
 
   u64 timebase = SystemTimers::GetFakeTimeBase();
 
+  if (netplay_client->m_rollback)
+  {
+    netplay_client->m_pending_timebases.push_back(
+        {netplay_client->m_timebase_frame++, timebase,
+         netplay_client->m_rollback_inputs.GetPollCounts()});
+    netplay_client->SendConfirmedTimeBases();
+    return;
+  }
+
   sf::Packet packet;
   packet << static_cast<MessageId>(NP_MSG_TIMEBASE);
   packet << static_cast<u32>(timebase);
@@ -1239,14 +1510,20 @@ void NetPlayClient::ComputeMD5(const std::string& file_identifier)
   }
 
   m_MD5_thread = std::thread([this, file]() {
-    std::string sum = MD5::MD5Sum(file, [&](int progress) {
-      sf::Packet packet;
-      packet << static_cast<MessageId>(NP_MSG_MD5_PROGRESS);
-      packet << progress;
-      Send(packet);
-
-      return m_should_compute_MD5;
-    });
+    std::string sum = GetCachedHash(file);
+    if (sum.empty())
+    {
+      sum = MD5::MD5TreeSum(file, [&](int progress) {
+        sf::Packet packet;
+        packet << static_cast<MessageId>(NP_MSG_MD5_PROGRESS);
+        packet << progress;
+        Send(packet);
+
+        return m_should_compute_MD5;
+      });
+      if (!sum.empty())
+        CacheHash(file, sum);
+    }
 
     sf::Packet packet;
     packet << static_cast<MessageId>(NP_MSG_MD5_RESULT);
@@ -1321,4 +1598,5 @@ void NetPlay_Disable()
 {
   std::lock_guard<std::mutex> lk(crit_netplay_client);
   netplay_client = nullptr;
+  Rollback::SetSafePointCallback(nullptr);
 }
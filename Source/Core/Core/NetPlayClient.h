@@ -6,16 +6,20 @@
 
 #include <SFML/Network/Packet.hpp>
 #include <array>
+#include <deque>
 #include <map>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/FifoQueue.h"
 #include "Common/TraversalClient.h"
+#include "Core/NetPlayInput.h"
 #include "Core/NetPlayProto.h"
+#include "Core/Rollback.h"
 #include "InputCommon/GCPadStatus.h"
 
 class NetPlayUI
@@ -36,6 +40,7 @@ public:
   virtual void OnConnectionLost() = 0;
   virtual void OnTraversalError(int error) = 0;
   virtual bool IsRecording() = 0;
+  virtual bool IsRollbackEnabled() = 0;
   virtual std::string FindGame(const std::string& game) = 0;
   virtual void ShowMD5Dialog(const std::string& file_identifier) = 0;
   virtual void SetMD5Progress(int pid, int progress) = 0;
@@ -99,6 +104,9 @@ public:
   static void SendTimeBase();
   bool DoAllPlayersHaveGame();
 
+  // Called from the CPU thread at every rollback safe point.
+  void OnRollbackSafePoint();
+
 protected:
   void ClearBuffers();
 
@@ -115,6 +123,10 @@ protected:
   std::array<Common::FifoQueue<GCPadStatus>, 4> m_pad_buffer;
   std::array<Common::FifoQueue<NetWiimote>, 4> m_wiimote_buffer;
 
+  // The encoder is used by the CPU thread, the decoder by the NETPLAY thread.
+  NetPlay::InputCodec m_input_encoder;
+  NetPlay::InputCodec m_input_decoder;
+
   NetPlayUI* m_dialog = nullptr;
 
   ENetHost* m_client = nullptr;
@@ -153,8 +165,11 @@ private:
   void SendStopGamePacket();
 
   void UpdateDevices();
-  void SendPadState(int in_game_pad, const GCPadStatus& np);
-  void SendWiimoteState(int in_game_pad, const NetWiimote& nw);
+  void SendPadStates(const std::vector<std::pair<PadMapping, GCPadStatus>>& pads);
+  void SendWiimoteStates(const std::vector<std::pair<PadMapping, NetWiimote>>& wiimotes);
+  bool GetRollbackPad(int pad_nb, GCPadStatus* pad_status);
+  bool CanPredictPad(int pad_nb) const;
+  void SendConfirmedTimeBases();
   unsigned int OnData(sf::Packet& packet);
   void Send(const sf::Packet& packet);
   void Disconnect();
@@ -178,6 +193,33 @@ private:
   Common::Event m_wii_pad_event;
 
   u32 m_timebase_frame = 0;
+
+  // Rollback state, used by the CPU thread once the game has started. Remote pads that haven't
+  // arrived yet are predicted, and a snapshot is taken every frame to go back to if a prediction
+  // was wrong.
+  struct SnapshotInfo
+  {
+    u64 id;
+    NetPlay::RollbackInputs::PollCounts polls;
+    u32 timebase_frame;
+  };
+  struct PendingTimeBase
+  {
+    u32 frame;
+    u64 timebase;
+    NetPlay::RollbackInputs::PollCounts polls;
+  };
+
+  bool m_rollback = false;
+  NetPlay::RollbackInputs m_rollback_inputs;
+  Rollback::SnapshotRing m_snapshots{NetPlay::RollbackInputs::MAX_PREDICTED_POLLS + 2};
+  std::deque<SnapshotInfo> m_snapshot_infos;
+  u64 m_next_snapshot_id = 0;
+  bool m_snapshot_requested = false;
+  // Timebases are only sent once the inputs before them are confirmed, as the server compares
+  // them to detect desyncs.
+  std::deque<PendingTimeBase> m_pending_timebases;
+  u32 m_timebase_frames_sent = 0;
 };
 
 void NetPlay_Enable(NetPlayClient* const np);
@@ -0,0 +1,347 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/NetPlayInput.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace NetPlay
+{
+namespace
+{
+// Wiimote reports up to this size can be sent as a byte mask plus the changed bytes.
+constexpr size_t MAX_MASKED_WIIMOTE_SIZE = 32;
+
+// The buffer is counted in pad polls, which most games do at twice the frame rate.
+constexpr double MS_PER_BUFFERED_POLL = 1000.0 / 120.0;
+
+bool IsValidMapping(PadMapping map)
+{
+  return map >= 0 && map < 4;
+}
+
+GCPadStatus GetInitialPadStatus()
+{
+  GCPadStatus pad{};
+  pad.stickX = GCPadStatus::MAIN_STICK_CENTER_X;
+  pad.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+  pad.substickX = GCPadStatus::C_STICK_CENTER_X;
+  pad.substickY = GCPadStatus::C_STICK_CENTER_Y;
+  return pad;
+}
+
+// The fields sent over the network, in the order of the bits of the change mask. The button
+// field is sent as a whole and handled separately.
+constexpr std::array<u8 GCPadStatus::*, 8> PAD_BYTE_FIELDS = {
+    {&GCPadStatus::analogA, &GCPadStatus::analogB, &GCPadStatus::stickX, &GCPadStatus::stickY,
+     &GCPadStatus::substickX, &GCPadStatus::substickY, &GCPadStatus::triggerLeft,
+     &GCPadStatus::triggerRight}};
+constexpr u16 PAD_BUTTON_CHANGED = 1 << PAD_BYTE_FIELDS.size();
+
+bool IsSamePad(const GCPadStatus& a, const GCPadStatus& b)
+{
+  for (const auto field : PAD_BYTE_FIELDS)
+  {
+    if (a.*field != b.*field)
+      return false;
+  }
+  return a.button == b.button;
+}
+
+constexpr u64 NO_ROLLBACK_LIMIT = std::numeric_limits<u64>::max();
+}  // Anonymous namespace
+
+InputCodec::InputCodec()
+{
+  Reset();
+}
+
+void InputCodec::Reset()
+{
+  m_pads.fill(GetInitialPadStatus());
+  for (NetWiimote& nw : m_wiimotes)
+    nw.clear();
+}
+
+// A pad is its mapping, a mask of the changed fields and the values of those fields.
+void InputCodec::EncodePad(sf::Packet& packet, PadMapping map, const GCPadStatus& pad)
+{
+  GCPadStatus& previous = m_pads.at(map);
+
+  u16 changed = 0;
+  for (size_t i = 0; i < PAD_BYTE_FIELDS.size(); ++i)
+  {
+    if (pad.*PAD_BYTE_FIELDS[i] != previous.*PAD_BYTE_FIELDS[i])
+      changed |= 1 << i;
+  }
+  if (pad.button != previous.button)
+    changed |= PAD_BUTTON_CHANGED;
+
+  packet << map << changed;
+  for (size_t i = 0; i < PAD_BYTE_FIELDS.size(); ++i)
+  {
+    if (changed & (1 << i))
+      packet << pad.*PAD_BYTE_FIELDS[i];
+  }
+  if (changed & PAD_BUTTON_CHANGED)
+    packet << pad.button;
+
+  previous = pad;
+}
+
+bool InputCodec::DecodePad(sf::Packet& packet, PadMapping* map, GCPadStatus* pad)
+{
+  u16 changed = 0;
+  packet >> *map >> changed;
+  if (!packet || !IsValidMapping(*map))
+    return false;
+
+  GCPadStatus& previous = m_pads[*map];
+  for (size_t i = 0; i < PAD_BYTE_FIELDS.size(); ++i)
+  {
+    if (changed & (1 << i))
+      packet >> previous.*PAD_BYTE_FIELDS[i];
+  }
+  if (changed & PAD_BUTTON_CHANGED)
+    packet >> previous.button;
+  if (!packet)
+    return false;
+
+  *pad = previous;
+  return true;
+}
+
+// A Wiimote report is its mapping and size, followed by either a mask of the changed bytes and
+// their values, if the report is small and has the same size as the previous one, or all bytes.
+void InputCodec::EncodeWiimote(sf::Packet& packet, PadMapping map, const NetWiimote& nw)
+{
+  NetWiimote& previous = m_wiimotes.at(map);
+
+  packet << map << static_cast<u8>(nw.size());
+  if (nw.size() == previous.size() && nw.size() <= MAX_MASKED_WIIMOTE_SIZE)
+  {
+    u32 changed = 0;
+    for (size_t i = 0; i < nw.size(); ++i)
+    {
+      if (nw[i] != previous[i])
+        changed |= 1u << i;
+    }
+
+    packet << changed;
+    for (size_t i = 0; i < nw.size(); ++i)
+    {
+      if (changed & (1u << i))
+        packet << nw[i];
+    }
+  }
+  else
+  {
+    for (u8 byte : nw)
+      packet << byte;
+  }
+
+  previous = nw;
+}
+
+bool InputCodec::DecodeWiimote(sf::Packet& packet, PadMapping* map, NetWiimote* nw)
+{
+  u8 size = 0;
+  packet >> *map >> size;
+  if (!packet || !IsValidMapping(*map))
+    return false;
+
+  NetWiimote& previous = m_wiimotes[*map];
+  if (size == previous.size() && size <= MAX_MASKED_WIIMOTE_SIZE)
+  {
+    u32 changed = 0;
+    packet >> changed;
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (changed & (1u << i))
+        packet >> previous[i];
+    }
+  }
+  else
+  {
+    previous.resize(size);
+    for (u8& byte : previous)
+      packet >> byte;
+  }
+  if (!packet)
+    return false;
+
+  *nw = previous;
+  return true;
+}
+
+void BufferEstimator::Reset()
+{
+  m_round_trips.clear();
+  m_lower_samples = 0;
+}
+
+void BufferEstimator::AddSample(PlayerId pid, u32 rtt_ms)
+{
+  const double sample = rtt_ms;
+  auto it = m_round_trips.find(pid);
+  if (it == m_round_trips.end())
+  {
+    m_round_trips.emplace(pid, RoundTrip{sample, sample / 2});
+    return;
+  }
+
+  RoundTrip& rtt = it->second;
+  rtt.variation = 0.75 * rtt.variation + 0.25 * std::abs(rtt.smoothed - sample);
+  rtt.smoothed = 0.875 * rtt.smoothed + 0.125 * sample;
+}
+
+void BufferEstimator::RemovePlayer(PlayerId pid)
+{
+  m_round_trips.erase(pid);
+}
+
+u32 BufferEstimator::GetTarget() const
+{
+  if (m_round_trips.empty())
+    return 0;
+
+  double delay_ms = 0;
+  for (const auto& entry : m_round_trips)
+    delay_ms = std::max(delay_ms, entry.second.smoothed + 4 * entry.second.variation);
+
+  const u32 target = static_cast<u32>(std::ceil(delay_ms / MS_PER_BUFFERED_POLL));
+  return std::min(std::max(target, MIN_BUFFER), MAX_BUFFER);
+}
+
+bool BufferEstimator::Update(u32 current_size, u32* new_size)
+{
+  const u32 target = GetTarget();
+  if (target == 0 || target == current_size)
+  {
+    m_lower_samples = 0;
+    return false;
+  }
+
+  if (target < current_size && ++m_lower_samples < DECREASE_SAMPLES)
+    return false;
+
+  m_lower_samples = 0;
+  *new_size = target;
+  return true;
+}
+
+RollbackInputs::RollbackInputs()
+{
+  Reset();
+}
+
+void RollbackInputs::Reset()
+{
+  for (PadHistory& pad : m_pads)
+    pad = PadHistory();
+  m_polls.fill(0);
+  m_needs_rollback = false;
+  m_rollback_limit.fill(NO_ROLLBACK_LIMIT);
+}
+
+RollbackInputs::PollCounts RollbackInputs::GetConfirmedCounts() const
+{
+  PollCounts counts;
+  for (size_t i = 0; i < m_pads.size(); ++i)
+    counts[i] = m_pads[i].confirmed;
+  return counts;
+}
+
+bool RollbackInputs::IsReplaying(int pad) const
+{
+  const PadHistory& history = m_pads[pad];
+  return m_polls[pad] < history.first + history.states.size();
+}
+
+bool RollbackInputs::IsReplaying() const
+{
+  for (size_t i = 0; i < m_pads.size(); ++i)
+  {
+    if (IsReplaying(static_cast<int>(i)))
+      return true;
+  }
+  return false;
+}
+
+GCPadStatus RollbackInputs::Replay(int pad)
+{
+  const PadHistory& history = m_pads[pad];
+  return history.states[m_polls[pad]++ - history.first];
+}
+
+void RollbackInputs::AddConfirmed(int pad, const GCPadStatus& status)
+{
+  PadHistory& history = m_pads[pad];
+  history.states.push_back(status);
+  history.confirmed = history.first + history.states.size();
+  ++m_polls[pad];
+}
+
+bool RollbackInputs::CanPredict(int pad) const
+{
+  const PadHistory& history = m_pads[pad];
+  return !history.states.empty() && m_polls[pad] - history.confirmed < MAX_PREDICTED_POLLS;
+}
+
+GCPadStatus RollbackInputs::Predict(int pad)
+{
+  PadHistory& history = m_pads[pad];
+  history.states.push_back(history.states.back());
+  ++m_polls[pad];
+  return history.states.back();
+}
+
+bool RollbackInputs::HasUnconfirmed(int pad) const
+{
+  const PadHistory& history = m_pads[pad];
+  return history.confirmed < history.first + history.states.size();
+}
+
+void RollbackInputs::Confirm(int pad, const GCPadStatus& actual)
+{
+  PadHistory& history = m_pads[pad];
+  const u64 poll = history.confirmed++;
+  GCPadStatus& predicted = history.states[poll - history.first];
+  if (IsSamePad(predicted, actual))
+    return;
+
+  // The later predictions repeated the wrong state as well.
+  for (size_t i = poll - history.first; i < history.states.size(); ++i)
+    history.states[i] = actual;
+
+  if (poll < m_polls[pad])
+  {
+    m_needs_rollback = true;
+    m_rollback_limit[pad] = std::min(m_rollback_limit[pad], poll);
+  }
+}
+
+void RollbackInputs::Rewind(const PollCounts& polls)
+{
+  m_polls = polls;
+  m_needs_rollback = false;
+  m_rollback_limit.fill(NO_ROLLBACK_LIMIT);
+}
+
+void RollbackInputs::Forget(const PollCounts& polls)
+{
+  for (size_t i = 0; i < m_pads.size(); ++i)
+  {
+    PadHistory& history = m_pads[i];
+    // The last state is kept for predicting.
+    while (history.first < std::min(polls[i], history.confirmed) && history.states.size() > 1)
+    {
+      history.states.pop_front();
+      ++history.first;
+    }
+  }
+}
+}
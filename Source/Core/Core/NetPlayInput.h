@@ -0,0 +1,133 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <SFML/Network/Packet.hpp>
+#include <array>
+#include <deque>
+#include <map>
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayProto.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace NetPlay
+{
+// Writes pad and Wiimote states as the difference to the previous state of the same slot.
+// Both ends of a connection must run the same states through their codec in the same order,
+// which holds as long as everything is sent as reliable packets on the same ENet channel.
+class InputCodec
+{
+public:
+  InputCodec();
+
+  // Forgets the previous states. Has to happen at the same point of the stream on both ends.
+  void Reset();
+
+  void EncodePad(sf::Packet& packet, PadMapping map, const GCPadStatus& pad);
+  bool DecodePad(sf::Packet& packet, PadMapping* map, GCPadStatus* pad);
+
+  void EncodeWiimote(sf::Packet& packet, PadMapping map, const NetWiimote& nw);
+  bool DecodeWiimote(sf::Packet& packet, PadMapping* map, NetWiimote* nw);
+
+private:
+  std::array<GCPadStatus, 4> m_pads;
+  std::array<NetWiimote, 4> m_wiimotes;
+};
+
+// Suggests a pad buffer size from the round trip times measured by the pings. Every player's
+// round trip time is smoothed like a TCP retransmission timer (RFC 6298), and the buffer is made
+// large enough to cover the slowest player's smoothed time plus four times its variation.
+class BufferEstimator
+{
+public:
+  static constexpr u32 MIN_BUFFER = 1;
+  static constexpr u32 MAX_BUFFER = 40;
+  // How many samples in a row have to ask for a smaller buffer before it is lowered.
+  static constexpr u32 DECREASE_SAMPLES = 5;
+
+  void Reset();
+  void AddSample(PlayerId pid, u32 rtt_ms);
+  void RemovePlayer(PlayerId pid);
+
+  // The buffer size that covers the current measurements, or 0 without any.
+  u32 GetTarget() const;
+
+  // Returns true and sets new_size if the buffer should change from current_size. Increases
+  // apply at once, as a buffer that is too small stalls the game; decreases only after
+  // DECREASE_SAMPLES calls in a row agree, so that a short calm period doesn't cause stutter.
+  bool Update(u32 current_size, u32* new_size);
+
+private:
+  struct RoundTrip
+  {
+    double smoothed;
+    double variation;
+  };
+
+  std::map<PlayerId, RoundTrip> m_round_trips;
+  u32 m_lower_samples = 0;
+};
+
+// Keeps the pad states a game has polled when pads that haven't arrived yet are predicted rather
+// than waited for. Predictions repeat the last known state, and are checked as the real states
+// arrive; if a prediction the game already used was wrong, the game has to roll back to a point
+// before that poll and replay the polls since then, which come from here.
+class RollbackInputs
+{
+public:
+  // How many polls of a pad may run ahead of its last real state.
+  static constexpr u32 MAX_PREDICTED_POLLS = 8;
+
+  using PollCounts = std::array<u64, 4>;
+
+  RollbackInputs();
+
+  void Reset();
+
+  // How many times every pad has been polled.
+  const PollCounts& GetPollCounts() const { return m_polls; }
+  // How many polls of every pad are known to have used the right state.
+  PollCounts GetConfirmedCounts() const;
+
+  // Whether the next poll of the pad is a replay, and the state for it.
+  bool IsReplaying(int pad) const;
+  bool IsReplaying() const;
+  GCPadStatus Replay(int pad);
+
+  // A poll of a state that is known to be right. Only when nothing is unconfirmed.
+  void AddConfirmed(int pad, const GCPadStatus& status);
+
+  bool CanPredict(int pad) const;
+  GCPadStatus Predict(int pad);
+
+  // Checks the oldest prediction against the real state.
+  bool HasUnconfirmed(int pad) const;
+  void Confirm(int pad, const GCPadStatus& actual);
+
+  // Whether a prediction that was already used turned out wrong. A snapshot can be rolled back
+  // to if it was taken after at most GetRollbackLimit()[pad] polls of every pad.
+  bool NeedsRollback() const { return m_needs_rollback; }
+  const PollCounts& GetRollbackLimit() const { return m_rollback_limit; }
+  // After loading a snapshot that was taken after these polls.
+  void Rewind(const PollCounts& polls);
+
+  // Drops the states before these polls, as nothing older than that is rolled back to anymore.
+  void Forget(const PollCounts& polls);
+
+private:
+  struct PadHistory
+  {
+    // states[i] is the state of poll first + i.
+    std::deque<GCPadStatus> states;
+    u64 first = 0;
+    u64 confirmed = 0;
+  };
+
+  std::array<PadHistory, 4> m_pads;
+  PollCounts m_polls;
+  bool m_needs_rollback;
+  PollCounts m_rollback_limit;
+};
+}
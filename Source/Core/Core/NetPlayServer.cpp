@@ -10,6 +10,7 @@
 #include <string>
 #include <thread>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "Common/Common.h"
@@ -377,6 +378,11 @@ unsigned int NetPlayServer::OnDisconnect(const Client& player)
 
   enet_peer_disconnect(player.socket, 0);
 
+  {
+    std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+    m_buffer_estimator.RemovePlayer(pid);
+  }
+
   std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
   auto it = m_players.find(player.pid);
   if (it != m_players.end())
@@ -455,6 +461,13 @@ void NetPlayServer::UpdateWiimoteMapping()
   SendToClients(spac);
 }
 
+// called from ---GUI--- thread
+void NetPlayServer::SetAutoPadBuffer(bool enabled)
+{
+  std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+  m_auto_buffer = enabled;
+}
+
 // called from ---GUI--- thread and ---NETPLAY--- thread
 void NetPlayServer::AdjustPadBufferSize(unsigned int size)
 {
@@ -507,27 +520,32 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 
   case NP_MSG_PAD_DATA:
   {
+    std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+
     // if this is pad data from the last game still being received, ignore it
     if (player.current_game != m_current_game)
       break;
 
-    PadMapping map = 0;
-    GCPadStatus pad;
-    packet >> map >> pad.button >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >>
-        pad.substickX >> pad.substickY >> pad.triggerLeft >> pad.triggerRight;
-
-    // If the data is not from the correct player,
-    // then disconnect them.
-    if (m_pad_map.at(map) != player.pid)
+    u16 count = 0;
+    packet >> count;
+    std::vector<std::pair<PadMapping, GCPadStatus>> pads(count);
+    for (auto& pad : pads)
     {
-      return 1;
+      if (!player.input_decoder.DecodePad(packet, &pad.first, &pad.second))
+        return 1;
+
+      // If the data is not from the correct player,
+      // then disconnect them.
+      if (m_pad_map[pad.first] != player.pid)
+        return 1;
     }
 
     // Relay to clients
     sf::Packet spac;
     spac << (MessageId)NP_MSG_PAD_DATA;
-    spac << map << pad.button << pad.analogA << pad.analogB << pad.stickX << pad.stickY
-         << pad.substickX << pad.substickY << pad.triggerLeft << pad.triggerRight;
+    spac << count;
+    for (const auto& pad : pads)
+      m_input_encoder.EncodePad(spac, pad.first, pad.second);
 
     SendToClients(spac, player.pid);
   }
@@ -535,31 +553,32 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 
   case NP_MSG_WIIMOTE_DATA:
   {
+    std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+
     // if this is Wiimote data from the last game still being received, ignore it
     if (player.current_game != m_current_game)
       break;
 
-    PadMapping map = 0;
-    u8 size;
-    packet >> map >> size;
-    std::vector<u8> data(size);
-    for (size_t i = 0; i < data.size(); ++i)
-      packet >> data[i];
-
-    // If the data is not from the correct player,
-    // then disconnect them.
-    if (m_wiimote_map.at(map) != player.pid)
+    u16 count = 0;
+    packet >> count;
+    std::vector<std::pair<PadMapping, NetWiimote>> wiimotes(count);
+    for (auto& wiimote : wiimotes)
     {
-      return 1;
+      if (!player.input_decoder.DecodeWiimote(packet, &wiimote.first, &wiimote.second))
+        return 1;
+
+      // If the data is not from the correct player,
+      // then disconnect them.
+      if (m_wiimote_map[wiimote.first] != player.pid)
+        return 1;
     }
 
     // relay to clients
     sf::Packet spac;
     spac << (MessageId)NP_MSG_WIIMOTE_DATA;
-    spac << map;
-    spac << size;
-    for (const u8& byte : data)
-      spac << byte;
+    spac << count;
+    for (const auto& wiimote : wiimotes)
+      m_input_encoder.EncodeWiimote(spac, wiimote.first, wiimote.second);
 
     SendToClients(spac, player.pid);
   }
@@ -574,6 +593,15 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
     if (m_ping_key == ping_key)
     {
       player.ping = ping;
+
+      std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+      m_buffer_estimator.AddSample(player.pid, ping);
+      u32 new_size;
+      if (m_auto_buffer && m_is_running &&
+          m_buffer_estimator.Update(m_target_buffer_size, &new_size))
+      {
+        AdjustPadBufferSize(new_size);
+      }
     }
 
     sf::Packet spac;
@@ -588,6 +616,8 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
   case NP_MSG_START_GAME:
   {
     packet >> player.current_game;
+    // The player's inputs for this game are encoded from scratch.
+    player.input_decoder.Reset();
   }
   break;
 
@@ -791,6 +821,9 @@ bool NetPlayServer::StartGame()
   m_desync_detected = false;
   std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
   m_current_game = Common::Timer::GetTimeMs();
+  // Nothing is relayed for the new game before the clients get the start game packet, where they
+  // reset their decoders.
+  m_input_encoder.Reset();
 
   // no change, just update with clients
   AdjustPadBufferSize(m_target_buffer_size);
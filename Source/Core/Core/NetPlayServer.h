@@ -15,6 +15,7 @@
 #include "Common/FifoQueue.h"
 #include "Common/Timer.h"
 #include "Common/TraversalClient.h"
+#include "Core/NetPlayInput.h"
 #include "Core/NetPlayProto.h"
 
 enum class PlayerGameStatus;
@@ -47,6 +48,8 @@ public:
   void SetWiimoteMapping(const PadMappingArray& mappings);
 
   void AdjustPadBufferSize(unsigned int size);
+  // Lets the server pick the pad buffer size from the measured pings.
+  void SetAutoPadBuffer(bool enabled);
 
   void KickPlayer(PlayerId player);
 
@@ -74,6 +77,8 @@ private:
     ENetPeer* socket;
     u32 ping;
     u32 current_game;
+    // Decodes the inputs this player sends, reset when the player starts a game.
+    NetPlay::InputCodec input_decoder;
 
     bool operator==(const Client& other) const { return this == &other; }
   };
@@ -100,6 +105,11 @@ private:
   bool m_update_pings = false;
   u32 m_current_game = 0;
   unsigned int m_target_buffer_size = 0;
+  bool m_auto_buffer = false;
+  NetPlay::BufferEstimator m_buffer_estimator;
+  // Encodes the inputs relayed to the clients. Every relayed input goes to all players but its
+  // owner, and each slot has one owner during a game, so all clients see the same stream per slot.
+  NetPlay::InputCodec m_input_encoder;
   PadMappingArray m_pad_map;
   PadMappingArray m_wiimote_map;
 
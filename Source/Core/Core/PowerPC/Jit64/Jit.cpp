@@ -388,6 +388,61 @@ void Jit64::FakeBLCall(u32 after)
   SetJumpTarget(skip_exit);
 }
 
+// Flushes the register caches before an exit to a known destination. Registers which are
+// overwritten before being read at the destination don't have to be stored back.
+void Jit64::FlushRegistersBeforeExit(u32 destination, RegCache::FlushMode mode)
+{
+  BitSet32 dead_gprs, dead_fprs;
+  if (analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_EXIT_LIVENESS))
+  {
+    const bool translated = UReg_MSR(MSR).IR;
+    const u32 physical_address = PowerPC::JitCache_TranslateAddress(destination).address;
+    const PPCAnalyst::ExitLiveness* cached =
+        js.exitLiveness.Find(destination, physical_address, translated);
+    if (!cached)
+    {
+      PPCAnalyst::ExitLiveness result;
+      analyzer.AnalyzeExitLiveness(destination, &result);
+      cached = &js.exitLiveness.Insert(destination, std::move(result));
+    }
+    const PPCAnalyst::ExitLiveness& liveness = *cached;
+    u32 skipped = 0;
+    for (int i : liveness.deadGPRs)
+    {
+      if (gpr.IsDirty(i))
+      {
+        dead_gprs[i] = true;
+        skipped++;
+      }
+    }
+    for (int i : liveness.deadFPRs)
+    {
+      if (fpr.IsDirty(i))
+      {
+        dead_fprs[i] = true;
+        skipped++;
+      }
+    }
+
+    // This block now depends on the code at the destination, so it has to be invalidated
+    // together with it.
+    if (skipped)
+    {
+      code_block.m_physical_addresses.insert(liveness.physical_addresses.begin(),
+                                             liveness.physical_addresses.end());
+    }
+    js.skippedStores += skipped;
+  }
+
+  if (mode == RegCache::FlushMode::All)
+  {
+    gpr.Discard(dead_gprs);
+    fpr.Discard(dead_fprs);
+  }
+  gpr.Flush(mode, ~dead_gprs);
+  fpr.Flush(mode, ~dead_fprs);
+}
+
 void Jit64::WriteExit(u32 destination, bool bl, u32 after)
 {
   if (!m_enable_blr_optimization)
@@ -572,6 +627,9 @@ void Jit64::Jit(u32 em_address)
     EnableBlockLink();
     EnableOptimization();
 
+    // Registers shown by the debugger at the destination of an exit must be up to date.
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_EXIT_LIVENESS);
+
     // Comment out the following to disable breakpoints (speed-up)
     if (!Profiler::g_ProfileBlocks)
     {
@@ -621,6 +679,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
   js.curBlock = b;
   js.numLoadStoreInst = 0;
   js.numFloatingPointInst = 0;
+  js.skippedStores = 0;
 
   PPCAnalyst::CodeOp* ops = code_buf->codebuffer;
 
@@ -946,12 +1005,12 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 
   if (code_block.m_broken)
   {
-    gpr.Flush();
-    fpr.Flush();
+    FlushRegistersBeforeExit(nextPC);
     WriteExit(nextPC);
   }
 
   b->codeSize = (u32)(GetCodePtr() - start);
+  b->skippedStores = js.skippedStores;
   b->originalSize = code_block.m_num_instructions;
 
 #ifdef JIT_LOG_X86
@@ -993,6 +1052,7 @@ void Jit64::EnableOptimization()
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+  analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_EXIT_LIVENESS);
 }
 
 void Jit64::IntializeSpeculativeConstants()
@@ -67,6 +67,8 @@ public:
   // Utilities for use by opcodes
 
   void FakeBLCall(u32 after);
+  void FlushRegistersBeforeExit(u32 destination,
+                                RegCache::FlushMode mode = RegCache::FlushMode::All);
   void WriteExit(u32 destination, bool bl = false, u32 after = 0);
   void JustWriteExit(u32 destination, bool bl, u32 after);
   void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
@@ -230,6 +232,10 @@ public:
 
   void eieio(UGeckoInstruction inst);
 
+protected:
+  GPRRegCache gpr{*this};
+  FPURegCache fpr{*this};
+
 private:
   static void InitializeInstructionTables();
   void CompileInstruction(PPCAnalyst::CodeOp& op);
@@ -237,9 +243,6 @@ private:
   void AllocStack();
   void FreeStack();
 
-  GPRRegCache gpr{*this};
-  FPURegCache fpr{*this};
-
   // The default code buffer. We keep it around to not have to alloc/dealloc a
   // large chunk of memory for each recompiled block.
   PPCAnalyst::CodeBuffer code_buffer;
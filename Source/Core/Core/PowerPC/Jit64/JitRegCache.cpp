@@ -70,6 +70,25 @@ void RegCache::DiscardRegContentsIfCached(size_t preg)
   }
 }
 
+void RegCache::Discard(BitSet32 pregs)
+{
+  for (unsigned int i : pregs)
+  {
+    if (m_regs[i].locked)
+      PanicAlert("Someone forgot to unlock PPC reg %u.", i);
+
+    if (m_regs[i].location.IsImm())
+    {
+      m_regs[i].away = false;
+      m_regs[i].location = GetDefaultLocation(i);
+    }
+    else
+    {
+      DiscardRegContentsIfCached(i);
+    }
+  }
+}
+
 void RegCache::SetEmitter(XEmitter* emitter)
 {
   m_emitter = emitter;
@@ -273,6 +292,15 @@ bool RegCache::IsBound(size_t preg) const
   return m_regs[preg].away && m_regs[preg].location.IsSimpleReg();
 }
 
+bool RegCache::IsDirty(size_t preg) const
+{
+  if (!m_regs[preg].away)
+    return false;
+  if (m_regs[preg].location.IsImm())
+    return true;
+  return m_xregs[m_regs[preg].location.GetSimpleReg()].dirty;
+}
+
 X64Reg RegCache::GetFreeXReg()
 {
   size_t aCount;
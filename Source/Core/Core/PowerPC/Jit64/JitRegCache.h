@@ -48,6 +48,9 @@ public:
   void Start();
 
   void DiscardRegContentsIfCached(size_t preg);
+  // Drops the given registers without storing them back, whether they are cached in a host
+  // register or as an immediate. Only valid for registers which are dead.
+  void Discard(BitSet32 pregs);
   void SetEmitter(Gen::XEmitter* emitter);
 
   void Flush(FlushMode mode = FlushMode::All, BitSet32 regsToFlush = BitSet32::AllTrue(32));
@@ -118,6 +121,8 @@ public:
 
   bool IsFreeX(size_t xreg) const;
   bool IsBound(size_t preg) const;
+  // Whether flushing this register would emit a store.
+  bool IsDirty(size_t preg) const;
 
   Gen::X64Reg GetFreeXReg();
   int NumFreeRegisters();
@@ -84,14 +84,13 @@ void Jit64::bx(UGeckoInstruction inst)
     return;
   }
 
-  gpr.Flush();
-  fpr.Flush();
-
   u32 destination;
   if (inst.AA)
     destination = SignExt26(inst.LI << 2);
   else
     destination = js.compilerPC + SignExt26(inst.LI << 2);
+
+  FlushRegistersBeforeExit(destination);
 #ifdef ACID_TEST
   if (inst.LK)
     AND(32, PPCSTATE(cr), Imm32(~(0xFF000000)));
@@ -160,8 +159,7 @@ void Jit64::bcx(UGeckoInstruction inst)
   else
     destination = js.compilerPC + SignExt16(inst.BD << 2);
 
-  gpr.Flush(RegCache::FlushMode::MaintainState);
-  fpr.Flush(RegCache::FlushMode::MaintainState);
+  FlushRegistersBeforeExit(destination, RegCache::FlushMode::MaintainState);
   WriteExit(destination, inst.LK, js.compilerPC + 4);
 
   if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
@@ -171,8 +169,7 @@ void Jit64::bcx(UGeckoInstruction inst)
 
   if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
-    gpr.Flush();
-    fpr.Flush();
+    FlushRegistersBeforeExit(js.compilerPC + 4);
     WriteExit(js.compilerPC + 4);
   }
 }
@@ -223,8 +220,7 @@ void Jit64::bcctrx(UGeckoInstruction inst)
 
     if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
     {
-      gpr.Flush();
-      fpr.Flush();
+      FlushRegistersBeforeExit(js.compilerPC + 4);
       WriteExit(js.compilerPC + 4);
     }
   }
@@ -280,8 +276,7 @@ void Jit64::bclrx(UGeckoInstruction inst)
 
   if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
-    gpr.Flush();
-    fpr.Flush();
+    FlushRegistersBeforeExit(js.compilerPC + 4);
     WriteExit(js.compilerPC + 4);
   }
 }
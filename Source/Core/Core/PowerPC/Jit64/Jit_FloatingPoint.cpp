@@ -319,16 +319,15 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
   {
     // We implement nmsub a little differently ((b - a*c) instead of -(a*c - b)), so handle it
     // separately.
-    MOVAPD(XMM1, fpr.R(b));
     if (packed)
     {
       MULPD(XMM0, fpr.R(a));
-      SUBPD(XMM1, R(XMM0));
+      avx_op(&XEmitter::VSUBPD, &XEmitter::SUBPD, XMM1, fpr.R(b), R(XMM0));
     }
     else
     {
       MULSD(XMM0, fpr.R(a));
-      SUBSD(XMM1, R(XMM0));
+      avx_op(&XEmitter::VSUBSD, &XEmitter::SUBSD, XMM1, fpr.R(b), R(XMM0));
     }
   }
   else
@@ -425,6 +424,20 @@ void Jit64::fselx(UGeckoInstruction inst)
   else
     CMPSD(XMM0, fpr.R(a), CMP_NLE);
 
+  if (packed && cpu_info.bAVX)
+  {
+    // The four-operand blend lets us skip the copy through XMM1.
+    fpr.BindToRegister(d, d == b || d == c);
+    X64Reg src = XMM1;
+    if (fpr.R(c).IsSimpleReg())
+      src = fpr.RX(c);
+    else
+      MOVAPD(XMM1, fpr.R(c));
+    VBLENDVPD(fpr.RX(d), src, fpr.R(b), XMM0);
+    fpr.UnlockAll();
+    return;
+  }
+
   if (cpu_info.bSSE4_1)
   {
     MOVAPD(XMM1, fpr.R(c));
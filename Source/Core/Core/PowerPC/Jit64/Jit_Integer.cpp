@@ -425,8 +425,7 @@ void Jit64::DoMergedBranchCondition()
 
   if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
-    gpr.Flush();
-    fpr.Flush();
+    FlushRegistersBeforeExit(nextPC + 4);
     WriteExit(nextPC + 4);
   }
 }
@@ -460,8 +459,7 @@ void Jit64::DoMergedBranchImmediate(s64 val)
   }
   else if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
-    gpr.Flush();
-    fpr.Flush();
+    FlushRegistersBeforeExit(nextPC + 4);
     WriteExit(nextPC + 4);
   }
 }
@@ -1917,8 +1915,7 @@ void Jit64::twX(UGeckoInstruction inst)
 
   if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
-    gpr.Flush();
-    fpr.Flush();
+    FlushRegistersBeforeExit(js.compilerPC + 4);
     WriteExit(js.compilerPC + 4);
   }
 }
@@ -7,6 +7,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/MsgHandler.h"
 #include "Common/x64Emitter.h"
+#include "Core/ConfigManager.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 
 using namespace Gen;
@@ -42,13 +43,21 @@ void Jit64::ps_sum(UGeckoInstruction inst)
   X64Reg tmp = XMM1;
   MOVDDUP(tmp, op_a);    // {a.ps0, a.ps0}
   ADDPD(tmp, fpr.R(b));  // {a.ps0 + b.ps0, a.ps0 + b.ps1}
+  // With AVX the final shuffle can write d directly, unless HandleNaNs still needs the inputs.
+  X64Reg dest = cpu_info.bAVX && !SConfig::GetInstance().bAccurateNaNs ? fpr.RX(d) : tmp;
   switch (inst.SUBOP5)
   {
   case 10:  // ps_sum0: {a.ps0 + b.ps1, c.ps1}
-    UNPCKHPD(tmp, fpr.R(c));
+    avx_op(&XEmitter::VUNPCKHPD, &XEmitter::UNPCKHPD, dest, R(tmp), fpr.R(c));
+    tmp = dest;
     break;
   case 11:  // ps_sum1: {c.ps0, a.ps0 + b.ps1}
-    if (fpr.R(c).IsSimpleReg())
+    if (cpu_info.bAVX)
+    {
+      VBLENDPD(dest, tmp, fpr.R(c), 1);
+      tmp = dest;
+    }
+    else if (fpr.R(c).IsSimpleReg())
     {
       if (cpu_info.bSSE4_1)
       {
@@ -99,9 +108,19 @@ void Jit64::ps_muls(UGeckoInstruction inst)
   }
   if (round_input)
     Force25BitPrecision(XMM1, R(XMM1), XMM0);
-  MULPD(XMM1, fpr.R(a));
-  fpr.BindToRegister(d, false);
-  HandleNaNs(inst, fpr.RX(d), XMM1);
+  X64Reg dest = XMM1;
+  if (cpu_info.bAVX && !SConfig::GetInstance().bAccurateNaNs)
+  {
+    fpr.BindToRegister(d, d == a);
+    dest = fpr.RX(d);
+    VMULPD(dest, XMM1, fpr.R(a));
+  }
+  else
+  {
+    MULPD(XMM1, fpr.R(a));
+    fpr.BindToRegister(d, false);
+  }
+  HandleNaNs(inst, fpr.RX(d), dest);
   ForceSinglePrecision(fpr.RX(d), fpr.R(d));
   SetFPRFIfNeeded(fpr.RX(d));
   fpr.UnlockAll();
@@ -99,6 +99,9 @@ protected:
     std::unordered_set<u32> fifoWriteAddresses;
     std::unordered_set<u32> pairedQuantizeAddresses;
     std::unordered_set<u32> noSpeculativeConstantsAddresses;
+
+    PPCAnalyst::ExitLivenessCache exitLiveness;
+    u32 skippedStores;
   };
 
   PPCAnalyst::CodeBlock code_block;
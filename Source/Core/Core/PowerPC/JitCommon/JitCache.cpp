@@ -64,6 +64,7 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
+  m_jit.js.exitLiveness.Clear();
   for (auto& e : block_map)
   {
     DestroyBlock(e.second);
@@ -103,6 +104,7 @@ JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address)
   b.msrBits = MSR & JIT_CACHE_MSR_MASK;
   b.linkData.clear();
   b.fast_block_map_index = 0;
+  b.skippedStores = 0;
   return &b;
 }
 
@@ -184,6 +186,10 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
     return;
   u32 pAddr = translated.address;
 
+  // Liveness results may depend on code that no longer belongs to any block, so they can't
+  // take part in the fast path below.
+  m_jit.js.exitLiveness.InvalidatePhysicalRange(pAddr, length);
+
   // Optimize the common case of length == 32 which is used by Interpreter::dcb*
   bool destroy_block = true;
   if (length == 32)
@@ -50,6 +50,9 @@ struct JitBlock
   // useful for logging.
   u32 originalSize;
   int runCount;  // for profiling.
+  // The number of register stores skipped at exits because the register was dead at the
+  // destination. Mostly useful for profiling.
+  u32 skippedStores;
 
   // Information about exits to a known address from this block.
   // This is used to implement block linking.
@@ -15,6 +15,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/StringUtil.h"
 #include "Core/ConfigManager.h"
+#include "Core/HLE/HLE.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PPCTables.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -41,6 +42,13 @@ constexpr u32 BRANCH_FOLLOWING_THRESHOLD = 2;
 
 constexpr u32 INVALID_BRANCH_TARGET = 0xFFFFFFFF;
 
+// Limits for the exit liveness lookahead: the total number of instructions looked at, how many
+// conditional branches deep both paths are followed, and how far away from the destination the
+// walk may go.
+constexpr u32 LIVENESS_MAX_INSTRUCTIONS = 64;
+constexpr u32 LIVENESS_MAX_DEPTH = 3;
+constexpr u32 LIVENESS_MAX_DISTANCE = 0x400;
+
 CodeBuffer::CodeBuffer(int size)
 {
   codebuffer = new PPCAnalyst::CodeOp[size];
@@ -971,4 +979,212 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
   return address;
 }
 
+static bool WritesWholeFPR(const CodeOp& op)
+{
+  // Double precision instructions leave ps1 alone, so only instructions which also write ps1
+  // actually end the lifetime of the old value.
+  return op.opinfo->type == OPTYPE_SINGLEFP || op.opinfo->type == OPTYPE_PS ||
+         op.opinfo->type == OPTYPE_LOADPS || !strncmp(op.opinfo->opname, "lfs", 3);
+}
+
+static bool UsesRegisterRange(UGeckoInstruction inst)
+{
+  // lmw, stmw, lswx, lswi, stswx and stswi use a range of registers which isn't described by
+  // the flags.
+  if (inst.OPCD == 46 || inst.OPCD == 47)
+    return true;
+  return inst.OPCD == 31 && (inst.SUBOP10 == 533 || inst.SUBOP10 == 597 ||
+                             inst.SUBOP10 == 661 || inst.SUBOP10 == 725);
+}
+
+PPCAnalyzer::LivenessWalk PPCAnalyzer::WalkLiveness(u32 address, u32 region_start, u32 region_end,
+                                                    u32 depth, u32* budget, LivenessWalk walk,
+                                                    ExitLiveness* liveness)
+{
+  // Anything that isn't known to be dead by the time the walk stops is treated as live.
+  std::set<u32> visited;
+  while (*budget > 0 && address >= region_start && address < region_end &&
+         visited.insert(address).second)
+  {
+    // HLE functions read their arguments straight out of ppcState.
+    if (HLE::GetFunctionIndex(address))
+      break;
+
+    auto result = PowerPC::TryReadInstruction(address);
+    if (!result.valid)
+      break;
+    UGeckoInstruction inst = result.hex;
+    GekkoOPInfo* opinfo = GetOpInfo(inst);
+    if (!opinfo || opinfo->type == OPTYPE_UNKNOWN || UsesRegisterRange(inst))
+      break;
+
+    --*budget;
+    liveness->physical_addresses.insert(result.physical_address);
+
+    CodeOp op = {};
+    op.inst = inst;
+    op.opinfo = opinfo;
+    op.address = address;
+    BlockRegStats gpa, fpa;
+    gpa.Clear();
+    fpa.Clear();
+    CodeBlock block;
+    block.m_gpa = &gpa;
+    block.m_fpa = &fpa;
+    SetInstructionStats(&block, &op, opinfo, 0);
+
+    walk.read_gprs |= op.regsIn & ~walk.dead_gprs;
+    walk.dead_gprs |= op.regsOut & ~walk.read_gprs;
+    walk.read_fprs |= op.fregsIn & ~walk.dead_fprs;
+    if (op.fregOut >= 0 && WritesWholeFPR(op) && !walk.read_fprs[op.fregOut])
+      walk.dead_fprs[op.fregOut] = true;
+
+    if (!(opinfo->flags & FL_ENDBLOCK))
+    {
+      address += 4;
+      continue;
+    }
+
+    // Calls stop the walk. There is no way to tell whether the callee actually follows the EABI,
+    // so nothing can be assumed about the registers it reads.
+    if (inst.OPCD == 18 && !inst.LK)  // bx
+    {
+      address = SignExt26(inst.LI << 2) + (inst.AA ? 0 : address);
+      continue;
+    }
+
+    if (inst.OPCD == 16 && !inst.LK)  // bcx
+    {
+      const u32 destination = SignExt16(inst.BD << 2) + (inst.AA ? 0 : address);
+      if ((inst.BO & BO_DONT_DECREMENT_FLAG) && (inst.BO & BO_DONT_CHECK_CONDITION))
+      {
+        address = destination;
+        continue;
+      }
+      if (depth == 0)
+        break;
+
+      // A register is only dead if it is dead on both paths.
+      LivenessWalk taken =
+          WalkLiveness(destination, region_start, region_end, depth - 1, budget, walk, liveness);
+      LivenessWalk not_taken =
+          WalkLiveness(address + 4, region_start, region_end, depth - 1, budget, walk, liveness);
+      walk.dead_gprs = taken.dead_gprs & not_taken.dead_gprs;
+      walk.dead_fprs = taken.dead_fprs & not_taken.dead_fprs;
+      break;
+    }
+
+    // Indirect branches, system calls, rfi, etc.
+    break;
+  }
+  return walk;
+}
+
+void PPCAnalyzer::AnalyzeExitLiveness(u32 address, ExitLiveness* liveness)
+{
+  liveness->deadGPRs = BitSet32(0);
+  liveness->deadFPRs = BitSet32(0);
+  liveness->translated = UReg_MSR(MSR).IR;
+  liveness->physical_address = PowerPC::JitCache_TranslateAddress(address).address;
+  liveness->physical_addresses.clear();
+
+  // Wandering into unrelated code through tail calls only wastes the budget.
+  const u32 region_start = address - std::min(address, LIVENESS_MAX_DISTANCE);
+  const u32 region_end = address + std::min(0xFFFFFFFFu - address, LIVENESS_MAX_DISTANCE);
+
+  u32 budget = LIVENESS_MAX_INSTRUCTIONS;
+  LivenessWalk walk = WalkLiveness(address, region_start, region_end, LIVENESS_MAX_DEPTH,
+                                   &budget, LivenessWalk(), liveness);
+  liveness->deadGPRs = walk.dead_gprs;
+  liveness->deadFPRs = walk.dead_fprs;
+}
+
+const ExitLiveness* ExitLivenessCache::Find(u32 address, u32 physical_address,
+                                            bool translated) const
+{
+  auto iter = m_entries.find(address);
+  if (iter == m_entries.end() || iter->second.physical_address != physical_address ||
+      iter->second.translated != translated)
+  {
+    return nullptr;
+  }
+  return &iter->second;
+}
+
+const ExitLiveness& ExitLivenessCache::Insert(u32 address, ExitLiveness liveness)
+{
+  auto iter = m_entries.find(address);
+  if (iter != m_entries.end())
+    RemoveFromRangeMap(address, iter->second);
+
+  ExitLiveness& entry = m_entries[address] = std::move(liveness);
+  for (u32 physical_address : entry.physical_addresses)
+    m_range_map[physical_address & ~(RANGE_MAP_ELEMENTS - 1)].insert(address);
+  return entry;
+}
+
+void ExitLivenessCache::Clear()
+{
+  m_entries.clear();
+  m_range_map.clear();
+}
+
+void ExitLivenessCache::RemoveFromRangeMap(u32 address, const ExitLiveness& liveness)
+{
+  for (u32 physical_address : liveness.physical_addresses)
+  {
+    auto range = m_range_map.find(physical_address & ~(RANGE_MAP_ELEMENTS - 1));
+    if (range == m_range_map.end())
+      continue;
+    range->second.erase(address);
+    if (range->second.empty())
+      m_range_map.erase(range);
+  }
+}
+
+void ExitLivenessCache::InvalidatePhysicalRange(u32 address, u32 length)
+{
+  // Iterate over all regions which overlap the given range.
+  const u32 range_mask = ~(RANGE_MAP_ELEMENTS - 1);
+  auto start = m_range_map.lower_bound(address & range_mask);
+  auto end = m_range_map.lower_bound(address + length);
+  while (start != end)
+  {
+    // Only drop the entries which were actually derived from the given range; the others in
+    // the region have to stay indexed.
+    auto iter = start->second.begin();
+    while (iter != start->second.end())
+    {
+      const u32 destination = *iter;
+      auto entry = m_entries.find(destination);
+      if (entry != m_entries.end())
+      {
+        const std::set<u32>& addresses = entry->second.physical_addresses;
+        if (addresses.lower_bound(address) == addresses.lower_bound(address + length))
+        {
+          ++iter;
+          continue;
+        }
+
+        // Also remove the entry from the other regions it occupies.
+        // This may leave empty regions behind, but they are reused or cleared later on.
+        for (u32 physical_address : addresses)
+        {
+          auto other = m_range_map.find(physical_address & range_mask);
+          if (other != start && other != m_range_map.end())
+            other->second.erase(destination);
+        }
+        m_entries.erase(entry);
+      }
+      iter = start->second.erase(iter);
+    }
+
+    // If the region is empty, drop it.
+    if (start->second.empty())
+      start = m_range_map.erase(start);
+    else
+      ++start;
+  }
+}
+
 }  // namespace
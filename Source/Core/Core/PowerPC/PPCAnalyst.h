@@ -164,6 +164,41 @@ struct CodeBlock
   std::set<u32> m_physical_addresses;
 };
 
+// Registers which are known to be overwritten before they are read once execution reaches a
+// given address. The JIT uses this to skip storing dead registers back at block exits.
+struct ExitLiveness
+{
+  BitSet32 deadGPRs;
+  BitSet32 deadFPRs;
+  // The MSR.IR bit and the translated destination address the result was computed with.
+  bool translated;
+  u32 physical_address;
+  // All instructions the result was derived from. A block relying on the result has to be
+  // invalidated when any of them change.
+  std::set<u32> physical_addresses;
+};
+
+// Caches ExitLiveness results per destination address. Entries are also indexed by the code
+// region they were derived from, so that invalidating a range of memory only has to look at
+// nearby entries.
+class ExitLivenessCache
+{
+public:
+  // Returns nullptr if there is no result for the destination under the current translation.
+  const ExitLiveness* Find(u32 address, u32 physical_address, bool translated) const;
+  const ExitLiveness& Insert(u32 address, ExitLiveness liveness);
+  void Clear();
+  void InvalidatePhysicalRange(u32 address, u32 length);
+
+private:
+  static constexpr u32 RANGE_MAP_ELEMENTS = 0x100;
+
+  void RemoveFromRangeMap(u32 address, const ExitLiveness& liveness);
+
+  std::map<u32, ExitLiveness> m_entries;  // destination -> liveness
+  std::map<u32, std::set<u32>> m_range_map;
+};
+
 class PPCAnalyzer
 {
 private:
@@ -178,6 +213,18 @@ private:
   void ReorderInstructions(u32 instructions, CodeOp* code);
   void SetInstructionStats(CodeBlock* block, CodeOp* code, const GekkoOPInfo* opinfo, u32 index);
 
+  struct LivenessWalk
+  {
+    // Registers read before being written on the current path.
+    BitSet32 read_gprs;
+    BitSet32 read_fprs;
+    // Registers written before being read on the current path.
+    BitSet32 dead_gprs;
+    BitSet32 dead_fprs;
+  };
+  LivenessWalk WalkLiveness(u32 address, u32 region_start, u32 region_end, u32 depth,
+                            u32* budget, LivenessWalk walk, ExitLiveness* liveness);
+
   // Options
   u32 m_options;
 
@@ -218,6 +265,11 @@ public:
 
     // Reorder cror instructions next to their associated fcmp.
     OPTION_CROR_MERGE = (1 << 6),
+
+    // Look ahead at the destination of block exits to find registers which are overwritten
+    // before being read there, so the register caches can skip storing them back.
+    // Requires JIT support to be enabled.
+    OPTION_EXIT_LIVENESS = (1 << 7),
   };
 
   PPCAnalyzer() : m_options(0) {}
@@ -226,6 +278,7 @@ public:
   void ClearOption(AnalystOption option) { m_options &= ~(option); }
   bool HasOption(AnalystOption option) const { return !!(m_options & option); }
   u32 Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32 blockSize);
+  void AnalyzeExitLiveness(u32 address, ExitLiveness* liveness);
 };
 
 void LogFunctionCall(u32 addr);
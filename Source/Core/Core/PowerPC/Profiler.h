@@ -43,8 +43,9 @@
 
 struct BlockStat
 {
-  BlockStat(u32 _addr, u64 c, u64 ticks, u64 run, u32 size)
-      : addr(_addr), cost(c), tick_counter(ticks), run_count(run), block_size(size)
+  BlockStat(u32 _addr, u64 c, u64 ticks, u64 run, u32 size, u32 skipped)
+      : addr(_addr), cost(c), tick_counter(ticks), run_count(run), block_size(size),
+        skipped_stores(skipped)
   {
   }
   u32 addr;
@@ -52,6 +53,7 @@ struct BlockStat
   u64 tick_counter;
   u64 run_count;
   u32 block_size;
+  u32 skipped_stores;
 
   bool operator<(const BlockStat& other) const { return cost > other.cost; }
 };
@@ -0,0 +1,316 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/SamplingProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/File.h"
+#include "Common/Flag.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Core/Core.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
+#include "Core/PowerPC/PowerPC.h"
+
+namespace Profiler
+{
+namespace
+{
+constexpr size_t MAX_STACK_DEPTH = 32;
+// How many samples are kept with their timestamps for the Chrome trace.
+constexpr size_t MAX_TIMED_SAMPLES = 1 << 16;
+
+// Guest addresses, innermost first.
+using Stack = std::vector<u32>;
+
+struct StackHash
+{
+  size_t operator()(const Stack& stack) const
+  {
+    size_t hash = 0;
+    for (u32 address : stack)
+      hash = hash * 31 + address;
+    return hash;
+  }
+};
+
+struct TimedSample
+{
+  u64 timestamp_us;
+  u32 stack_index;
+};
+
+std::thread s_thread;
+Common::Flag s_sampling;
+Common::Event s_stop_event;
+
+// Samples are only ever added by the sampling thread, so the CPU thread is never slowed down.
+// The lock only keeps exports consistent.
+std::mutex s_lock;
+std::unordered_map<Stack, u32, StackHash> s_stack_indices;
+std::vector<Stack> s_stacks;
+std::vector<u64> s_stack_counts;
+std::vector<TimedSample> s_timed_samples;
+size_t s_next_timed_sample = 0;
+u64 s_sample_count = 0;
+std::chrono::steady_clock::time_point s_start_time = std::chrono::steady_clock::now();
+
+bool IsStackBottom(u32 address)
+{
+  return !address || !PowerPC::HostIsRAMAddress(address);
+}
+
+// The JIT only updates PC when entering a block, so PC is the start of the block the CPU thread
+// is currently executing. The callers are found by walking the back chain, like the debugger's
+// call stack does.
+void TakeSample(Stack* stack)
+{
+  stack->clear();
+  stack->push_back(PowerPC::ppcState.pc);
+  const u32 lr = PowerPC::ppcState.spr[SPR_LR];
+  if (lr)
+    stack->push_back(lr - 4);
+
+  u32 address = PowerPC::ppcState.gpr[1];
+  if (IsStackBottom(address))
+    return;
+  address = PowerPC::HostRead_U32(address);
+  while (stack->size() < MAX_STACK_DEPTH && !IsStackBottom(address) &&
+         !IsStackBottom(address + 4))
+  {
+    const u32 return_address = PowerPC::HostRead_U32(address + 4);
+    if (return_address)
+      stack->push_back(return_address - 4);
+
+    // Stack frames only ever grow towards lower addresses, anything else is garbage.
+    const u32 next = PowerPC::HostRead_U32(address);
+    if (next <= address)
+      break;
+    address = next;
+  }
+}
+
+void AddSample(const Stack& stack)
+{
+  std::lock_guard<std::mutex> lk(s_lock);
+
+  auto iter = s_stack_indices.find(stack);
+  if (iter == s_stack_indices.end())
+  {
+    iter = s_stack_indices.emplace(stack, static_cast<u32>(s_stacks.size())).first;
+    s_stacks.push_back(stack);
+    s_stack_counts.push_back(0);
+  }
+  s_stack_counts[iter->second]++;
+  s_sample_count++;
+
+  const u64 timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - s_start_time)
+                               .count();
+  const TimedSample sample{timestamp_us, iter->second};
+  if (s_timed_samples.size() < MAX_TIMED_SAMPLES)
+    s_timed_samples.push_back(sample);
+  else
+    s_timed_samples[s_next_timed_sample] = sample;
+  s_next_timed_sample = (s_next_timed_sample + 1) % MAX_TIMED_SAMPLES;
+}
+
+void SamplingThread(std::chrono::microseconds interval)
+{
+  Common::SetCurrentThreadName("Sampling Profiler");
+
+  Stack stack;
+  stack.reserve(MAX_STACK_DEPTH);
+  while (!s_stop_event.WaitFor(interval))
+  {
+    if (Core::GetState() != Core::State::Running)
+      continue;
+
+    TakeSample(&stack);
+    AddSample(stack);
+  }
+}
+
+std::string GetFrameName(u32 address)
+{
+  const Symbol* symbol = g_symbolDB.GetSymbolFromAddr(address);
+  if (!symbol)
+    return StringFromFormat("%08x", address);
+
+  // Semicolons separate the frames in the folded format.
+  std::string name = symbol->name;
+  std::replace(name.begin(), name.end(), ';', ':');
+  return name;
+}
+
+// Returns the frame names outermost first, ending with the current block. Consecutive frames in
+// the same function are merged, since the LR register and the saved LR often point to the same
+// caller.
+std::vector<std::string> ResolveStack(const Stack& stack)
+{
+  std::vector<std::string> frames;
+  for (auto iter = stack.rbegin(); iter != stack.rend(); ++iter)
+  {
+    std::string name = GetFrameName(*iter);
+    if (frames.empty() || frames.back() != name)
+      frames.push_back(std::move(name));
+  }
+  frames.push_back(StringFromFormat("block %08x", stack.front()));
+  return frames;
+}
+
+std::string EscapeJSON(const std::string& str)
+{
+  std::string result;
+  result.reserve(str.size());
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    if (static_cast<unsigned char>(c) < 0x20)
+      result += StringFromFormat("\\u%04x", c);
+    else
+      result += c;
+  }
+  return result;
+}
+}  // Anonymous namespace
+
+void StartSampling(u32 interval_us)
+{
+  if (s_sampling.TestAndSet())
+  {
+    s_stop_event.Reset();
+    s_thread = std::thread(SamplingThread, std::chrono::microseconds(interval_us));
+  }
+}
+
+void StopSampling()
+{
+  if (s_sampling.TestAndClear())
+  {
+    s_stop_event.Set();
+    s_thread.join();
+  }
+}
+
+bool IsSampling()
+{
+  return s_sampling.IsSet();
+}
+
+void ClearSamples()
+{
+  std::lock_guard<std::mutex> lk(s_lock);
+  s_stack_indices.clear();
+  s_stacks.clear();
+  s_stack_counts.clear();
+  s_timed_samples.clear();
+  s_next_timed_sample = 0;
+  s_sample_count = 0;
+  s_start_time = std::chrono::steady_clock::now();
+}
+
+u64 GetSampleCount()
+{
+  std::lock_guard<std::mutex> lk(s_lock);
+  return s_sample_count;
+}
+
+bool WriteFoldedStacks(const std::string& filename)
+{
+  std::map<std::string, u64> folded;
+  {
+    std::lock_guard<std::mutex> lk(s_lock);
+    for (size_t i = 0; i < s_stacks.size(); ++i)
+    {
+      const std::vector<std::string> frames = ResolveStack(s_stacks[i]);
+      folded[JoinStrings(frames, ";")] += s_stack_counts[i];
+    }
+  }
+
+  File::IOFile f(filename, "w");
+  if (!f)
+  {
+    ERROR_LOG(POWERPC, "Failed to open %s for writing", filename.c_str());
+    return false;
+  }
+  for (const auto& entry : folded)
+    fprintf(f.GetHandle(), "%s %" PRIu64 "\n", entry.first.c_str(), entry.second);
+  return true;
+}
+
+bool WriteChromeTrace(const std::string& filename)
+{
+  // Frames are shared between stacks with the same callers, as the format expects.
+  std::map<std::pair<u32, std::string>, u32> frame_ids;
+  std::vector<std::pair<u32, std::string>> frames;  // parent id (0 for none) and name
+  std::vector<TimedSample> samples;
+  std::vector<u32> leaf_frames;
+  {
+    std::lock_guard<std::mutex> lk(s_lock);
+    const size_t oldest = s_timed_samples.size() < MAX_TIMED_SAMPLES ? 0 : s_next_timed_sample;
+    for (size_t i = 0; i < s_timed_samples.size(); ++i)
+      samples.push_back(s_timed_samples[(oldest + i) % s_timed_samples.size()]);
+
+    leaf_frames.reserve(s_stacks.size());
+    for (const Stack& stack : s_stacks)
+    {
+      u32 parent = 0;
+      for (std::string& name : ResolveStack(stack))
+      {
+        auto key = std::make_pair(parent, std::move(name));
+        auto iter = frame_ids.find(key);
+        if (iter == frame_ids.end())
+        {
+          frames.push_back(key);
+          iter = frame_ids.emplace(std::move(key), static_cast<u32>(frames.size())).first;
+        }
+        parent = iter->second;
+      }
+      leaf_frames.push_back(parent);
+    }
+  }
+
+  File::IOFile f(filename, "w");
+  if (!f)
+  {
+    ERROR_LOG(POWERPC, "Failed to open %s for writing", filename.c_str());
+    return false;
+  }
+
+  fprintf(f.GetHandle(), "{\"traceEvents\":[{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                         "\"tid\":1,\"args\":{\"name\":\"Emulated CPU\"}}],\n\"stackFrames\":{");
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    fprintf(f.GetHandle(), "%s\n\"%zu\":{\"category\":\"guest\",\"name\":\"%s\"", i ? "," : "",
+            i + 1, EscapeJSON(frames[i].second).c_str());
+    if (frames[i].first)
+      fprintf(f.GetHandle(), ",\"parent\":\"%u\"", frames[i].first);
+    fprintf(f.GetHandle(), "}");
+  }
+  fprintf(f.GetHandle(), "},\n\"samples\":[");
+  for (size_t i = 0; i < samples.size(); ++i)
+  {
+    fprintf(f.GetHandle(),
+            "%s\n{\"cpu\":0,\"tid\":1,\"pid\":1,\"ts\":%" PRIu64 ",\"name\":\"sample\","
+            "\"sf\":\"%u\",\"weight\":1}",
+            i ? "," : "", samples[i].timestamp_us, leaf_frames[samples[i].stack_index]);
+  }
+  fprintf(f.GetHandle(), "]}\n");
+  return true;
+}
+}
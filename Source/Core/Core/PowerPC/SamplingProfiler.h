@@ -0,0 +1,32 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// A sampling profiler for guest code. A host thread periodically records the JIT block the CPU
+// thread is executing together with the guest call stack, without instrumenting the generated
+// code. The results can be exported as folded stacks (for flamegraph.pl, speedscope, etc.) or as
+// a Chrome trace (chrome://tracing).
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace Profiler
+{
+constexpr u32 DEFAULT_SAMPLING_INTERVAL_US = 1000;
+
+void StartSampling(u32 interval_us = DEFAULT_SAMPLING_INTERVAL_US);
+void StopSampling();
+bool IsSampling();
+void ClearSamples();
+u64 GetSampleCount();
+
+// Writes one line per distinct call stack, with the frames separated by semicolons, root first,
+// followed by the number of samples.
+bool WriteFoldedStacks(const std::string& filename);
+// Writes the samples as a Chrome trace, keeping their timestamps. Only the most recent samples
+// are kept for this.
+bool WriteChromeTrace(const std::string& filename);
+}
@@ -0,0 +1,135 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/Rollback.h"
+
+#include <atomic>
+
+#include "Common/Assert.h"
+#include "Core/Core.h"
+#include "Core/State.h"
+#include "VideoCommon/RenderBase.h"
+
+namespace Rollback
+{
+static std::atomic<SafePointCallback> s_callback{nullptr};
+// How late the VI update of the current safe point is. Saved with every snapshot, since the
+// update has to continue with the lateness of the snapshot after a load.
+static s64 s_cycles_late;
+
+static bool s_replaying = false;
+static bool s_was_throttler_disabled = false;
+
+void SetSafePointCallback(SafePointCallback callback)
+{
+  s_callback.store(callback);
+}
+
+s64 RunSafePoint(s64 cycles_late)
+{
+  const SafePointCallback callback = s_callback.load(std::memory_order_relaxed);
+  if (!callback)
+    return cycles_late;
+
+  s_cycles_late = cycles_late;
+  callback();
+  return s_cycles_late;
+}
+
+void SetReplaying(bool replaying)
+{
+  if (replaying == s_replaying)
+    return;
+  s_replaying = replaying;
+
+  if (g_renderer)
+    g_renderer->SetOutputSuppressed(replaying);
+
+  if (replaying)
+  {
+    s_was_throttler_disabled = Core::GetIsThrottlerTempDisabled();
+    Core::SetIsThrottlerTempDisabled(true);
+  }
+  else
+  {
+    Core::SetIsThrottlerTempDisabled(s_was_throttler_disabled);
+  }
+}
+
+bool IsReplaying()
+{
+  return s_replaying;
+}
+
+SnapshotRing::SnapshotRing(size_t capacity) : m_snapshots(capacity)
+{
+  _assert_(capacity > 0);
+}
+
+void SnapshotRing::Save(u64 id)
+{
+  _assert_(m_count == 0 || m_snapshots[(m_first + m_count - 1) % m_snapshots.size()].id < id);
+
+  if (m_count == m_snapshots.size())
+  {
+    m_first = (m_first + 1) % m_snapshots.size();
+    --m_count;
+  }
+
+  Snapshot& snapshot = m_snapshots[(m_first + m_count) % m_snapshots.size()];
+  ++m_count;
+
+  snapshot.id = id;
+  snapshot.cycles_late = s_cycles_late;
+  State::SaveToBufferOnCPUThread(snapshot.state);
+}
+
+bool SnapshotRing::Load(u64 id)
+{
+  size_t position;
+  if (!Find(id, &position))
+    return false;
+
+  Snapshot& snapshot = m_snapshots[(m_first + position) % m_snapshots.size()];
+  State::LoadFromBufferOnCPUThread(snapshot.state);
+  s_cycles_late = snapshot.cycles_late;
+
+  m_count = position + 1;
+  return true;
+}
+
+bool SnapshotRing::Contains(u64 id) const
+{
+  size_t position;
+  return Find(id, &position);
+}
+
+size_t SnapshotRing::GetSnapshotSize() const
+{
+  if (m_count == 0)
+    return 0;
+  return m_snapshots[(m_first + m_count - 1) % m_snapshots.size()].state.size();
+}
+
+void SnapshotRing::Clear()
+{
+  for (Snapshot& snapshot : m_snapshots)
+    std::vector<u8>().swap(snapshot.state);
+  m_first = 0;
+  m_count = 0;
+}
+
+bool SnapshotRing::Find(u64 id, size_t* position) const
+{
+  for (size_t i = 0; i < m_count; ++i)
+  {
+    if (m_snapshots[(m_first + i) % m_snapshots.size()].id == id)
+    {
+      *position = i;
+      return true;
+    }
+  }
+  return false;
+}
+}
@@ -0,0 +1,71 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Keeps savestates in memory and goes back to them, so that the emulation since then can be run
+// again, e.g. once NetPlay finds out that an input it predicted was wrong.
+//
+// Snapshots are only saved and loaded at the start of a VI update, on the CPU thread. Saving and
+// loading happen at exactly the same point, so after a load the machine continues as it did
+// after the save, and nothing extra is scheduled that could change the timing of the emulation.
+// This needs single core mode, in which the GPU is emulated on the CPU thread as well.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Rollback
+{
+using SafePointCallback = void (*)();
+
+// The callback is run on the CPU thread at every safe point, and may save or load snapshots.
+// Passing nullptr removes it.
+void SetSafePointCallback(SafePointCallback callback);
+
+// Called by the VI update. Returns how late the update is, which changes if a snapshot was loaded.
+s64 RunSafePoint(s64 cycles_late);
+
+// While replaying, frames aren't shown and the emulation isn't throttled.
+void SetReplaying(bool replaying);
+bool IsReplaying();
+
+// Holds the newest snapshots, replacing the oldest one once it is full. The memory of replaced
+// snapshots is reused, so that saving doesn't allocate once the ring has filled up.
+class SnapshotRing
+{
+public:
+  explicit SnapshotRing(size_t capacity);
+
+  // Only from the safe point callback. IDs have to increase from one save to the next.
+  void Save(u64 id);
+  // Loads the snapshot and forgets all newer ones. Returns false if it isn't held anymore.
+  bool Load(u64 id);
+
+  bool Contains(u64 id) const;
+  size_t GetSize() const { return m_count; }
+  size_t GetCapacity() const { return m_snapshots.size(); }
+  // Bytes used by the most recently saved snapshot.
+  size_t GetSnapshotSize() const;
+
+  // Forgets all snapshots and frees their memory.
+  void Clear();
+
+private:
+  struct Snapshot
+  {
+    u64 id;
+    s64 cycles_late;
+    std::vector<u8> state;
+  };
+
+  // Sets position to how many snapshots are older than the one with the ID.
+  bool Find(u64 id, size_t* position) const;
+
+  std::vector<Snapshot> m_snapshots;
+  size_t m_first = 0;
+  size_t m_count = 0;
+};
+}
@@ -26,7 +26,9 @@
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/DSPEmulator.h"
 #include "Core/GeckoCode.h"
+#include "Core/HW/DSP.h"
 #include "Core/HW/HW.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
@@ -234,6 +236,36 @@ void SaveToBuffer(std::vector<u8>& buffer)
   Core::PauseAndLock(false, wasUnpaused);
 }
 
+void SaveToBufferOnCPUThread(std::vector<u8>& buffer)
+{
+  // The DSP thread of LLE could still be running.
+  DSP::GetDSPEmulator()->PauseAndLock(true, false);
+
+  u8* ptr = nullptr;
+  PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+
+  DoState(p);
+  const size_t buffer_size = reinterpret_cast<size_t>(ptr);
+  buffer.resize(buffer_size);
+
+  ptr = &buffer[0];
+  p.SetMode(PointerWrap::MODE_WRITE);
+  DoState(p);
+
+  DSP::GetDSPEmulator()->PauseAndLock(false, false);
+}
+
+void LoadFromBufferOnCPUThread(std::vector<u8>& buffer)
+{
+  DSP::GetDSPEmulator()->PauseAndLock(true, false);
+
+  u8* ptr = &buffer[0];
+  PointerWrap p(&ptr, PointerWrap::MODE_READ);
+  DoState(p);
+
+  DSP::GetDSPEmulator()->PauseAndLock(false, false);
+}
+
 void VerifyBuffer(std::vector<u8>& buffer)
 {
   bool wasUnpaused = Core::PauseAndLock(true);
@@ -298,6 +330,8 @@ struct CompressAndDumpState_args
   std::mutex* buffer_mutex;
   std::string filename;
   bool wait;
+  // Keyframes of a movie are saved without the movie and without keeping the previous file.
+  bool keyframe;
 };
 
 static void CompressAndDumpState(CompressAndDumpState_args save_args)
@@ -325,7 +359,7 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
   Common::SetCurrentThreadName("SaveState thread");
 
   // Moving to last overwritten save-state
-  if (File::Exists(filename))
+  if (!save_args.keyframe && File::Exists(filename))
   {
     if (File::Exists(File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav"))
       File::Delete((File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav"));
@@ -338,10 +372,13 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
       File::Rename(filename + ".dtm", File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav.dtm");
   }
 
-  if ((Movie::IsMovieActive()) && !Movie::IsJustStartingRecordingInputFromSaveState())
-    Movie::SaveRecording(filename + ".dtm");
-  else if (!Movie::IsMovieActive())
-    File::Delete(filename + ".dtm");
+  if (!save_args.keyframe)
+  {
+    if ((Movie::IsMovieActive()) && !Movie::IsJustStartingRecordingInputFromSaveState())
+      Movie::SaveRecording(filename + ".dtm");
+    else if (!Movie::IsMovieActive())
+      File::Delete(filename + ".dtm");
+  }
 
   File::IOFile f(filename, "wb");
   if (!f)
@@ -393,11 +430,14 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
     f.WriteBytes(buffer_data, buffer_size);
   }
 
+  if (save_args.keyframe)
+    return;
+
   Core::DisplayMessage(StringFromFormat("Saved State to %s", filename.c_str()), 2000);
   Host_UpdateMainFrame();
 }
 
-void SaveAs(const std::string& filename, bool wait)
+static void SaveAsInternal(const std::string& filename, bool wait, bool keyframe)
 {
   // Pause the core while we save the state
   bool wasUnpaused = Core::PauseAndLock(true);
@@ -419,19 +459,22 @@ void SaveAs(const std::string& filename, bool wait)
 
   if (p.GetMode() == PointerWrap::MODE_WRITE)
   {
-    Core::DisplayMessage("Saving State...", 1000);
+    if (!keyframe)
+      Core::DisplayMessage("Saving State...", 1000);
 
     CompressAndDumpState_args save_args;
     save_args.buffer_vector = &g_current_buffer;
     save_args.buffer_mutex = &g_cs_current_buffer;
     save_args.filename = filename;
     save_args.wait = wait;
+    save_args.keyframe = keyframe;
 
     Flush();
     g_save_thread = std::thread(CompressAndDumpState, save_args);
     g_compressAndDumpStateSyncEvent.Wait();
 
-    g_last_filename = filename;
+    if (!keyframe)
+      g_last_filename = filename;
   }
   else
   {
@@ -443,6 +486,16 @@ void SaveAs(const std::string& filename, bool wait)
   Core::PauseAndLock(false, wasUnpaused);
 }
 
+void SaveAs(const std::string& filename, bool wait)
+{
+  SaveAsInternal(filename, wait, false);
+}
+
+void SaveAsKeyframe(const std::string& filename)
+{
+  SaveAsInternal(filename, false, true);
+}
+
 bool ReadHeader(const std::string& filename, StateHeader& header)
 {
   Flush();
@@ -617,6 +670,26 @@ void LoadAs(const std::string& filename)
   Core::PauseAndLock(false, wasUnpaused);
 }
 
+bool LoadKeyframe(const std::string& filename)
+{
+  bool wasUnpaused = Core::PauseAndLock(true);
+
+  std::vector<u8> buffer;
+  LoadFileStateData(filename, buffer);
+
+  bool loaded = false;
+  if (!buffer.empty())
+  {
+    u8* ptr = &buffer[0];
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    DoState(p);
+    loaded = p.GetMode() == PointerWrap::MODE_READ;
+  }
+
+  Core::PauseAndLock(false, wasUnpaused);
+  return loaded;
+}
+
 void SetOnAfterLoadCallback(AfterLoadCallbackFunc callback)
 {
   s_on_after_load_callback = std::move(callback);
@@ -49,10 +49,21 @@ void SaveAs(const std::string& filename, bool wait = false);
 void LoadAs(const std::string& filename);
 void VerifyAt(const std::string& filename);
 
+// For the keyframes of a movie, which belong to the movie that is running: the movie isn't saved
+// or loaded with them, and nothing is shown.
+void SaveAsKeyframe(const std::string& filename);
+bool LoadKeyframe(const std::string& filename);
+
 void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 void VerifyBuffer(std::vector<u8>& buffer);
 
+// For the CPU thread itself in single core mode, at a point where the emulated machine is
+// consistent, such as a CoreTiming callback. Nothing is paused, and loading works during
+// NetPlay, so that rollback can use these. The buffer is reused if it is already large enough.
+void SaveToBufferOnCPUThread(std::vector<u8>& buffer);
+void LoadFromBufferOnCPUThread(std::vector<u8>& buffer);
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
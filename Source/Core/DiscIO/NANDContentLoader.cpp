@@ -189,22 +189,38 @@ void NANDContentLoader::InitializeContentEntries(const std::vector<u8>& data_app
   const std::array<u8, 16> title_key = m_ticket.GetTitleKey();
   IOS::ES::SharedContentMap shared_content{m_root};
 
+  // The contents of a WAD are encrypted independently, so they are decrypted at the same time.
+  std::vector<std::vector<u8>> decrypted_contents;
+  if (m_IsWAD)
+  {
+    decrypted_contents.resize(contents.size());
+    std::vector<Common::AES::BatchEntry> batch;
+    for (size_t i = 0; i < contents.size(); ++i)
+    {
+      const auto& content = contents.at(i);
+      const u32 rounded_size = Common::AlignUp(static_cast<u32>(content.size), 0x40);
+      decrypted_contents[i].resize(rounded_size);
+
+      // The content index is used as IV (2 bytes); the remaining 14 bytes are zeroes.
+      Common::AES::BatchEntry entry{&data_app[data_app_offset], decrypted_contents[i].data(),
+                                    rounded_size};
+      entry.iv[0] = static_cast<u8>(content.index >> 8) & 0xFF;
+      entry.iv[1] = static_cast<u8>(content.index) & 0xFF;
+      batch.push_back(entry);
+
+      data_app_offset += rounded_size;
+    }
+    Common::AES::DecryptEncryptBatch(title_key.data(), &batch, Common::AES::Mode::Decrypt);
+  }
+
   for (size_t i = 0; i < contents.size(); ++i)
   {
     const auto& content = contents.at(i);
 
     if (m_IsWAD)
     {
-      // The content index is used as IV (2 bytes); the remaining 14 bytes are zeroes.
-      std::array<u8, 16> iv{};
-      iv[0] = static_cast<u8>(content.index >> 8) & 0xFF;
-      iv[1] = static_cast<u8>(content.index) & 0xFF;
-
-      u32 rounded_size = Common::AlignUp(static_cast<u32>(content.size), 0x40);
-
-      m_Content[i].m_Data = std::make_unique<NANDContentDataBuffer>(Common::AES::Decrypt(
-          title_key.data(), iv.data(), &data_app[data_app_offset], rounded_size));
-      data_app_offset += rounded_size;
+      m_Content[i].m_Data =
+          std::make_unique<NANDContentDataBuffer>(std::move(decrypted_contents[i]));
     }
     else
     {
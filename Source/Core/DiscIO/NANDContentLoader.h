@@ -8,6 +8,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -57,7 +58,7 @@ private:
 class NANDContentDataBuffer final : public NANDContentData
 {
 public:
-  explicit NANDContentDataBuffer(const std::vector<u8>& buffer) : m_buffer(buffer) {}
+  explicit NANDContentDataBuffer(std::vector<u8> buffer) : m_buffer(std::move(buffer)) {}
   std::vector<u8> Get() override { return m_buffer; }
   bool GetRange(u32 start, u32 size, u8* buffer) override;
 
@@ -8,7 +8,9 @@
 #include <array>
 #include <cinttypes>
 #include <cstring>
+#include <vector>
 
+#include "Common/Align.h"
 #include "Common/Crypto/AES.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
@@ -175,19 +177,20 @@ void NANDImporter::ProcessFile(const NANDFSTEntry& entry, const std::string& par
   std::array<u8, 16> key{};
   std::copy(&m_nand_keys[NAND_AES_KEY_OFFSET], &m_nand_keys[NAND_AES_KEY_OFFSET + key.size()],
             key.begin());
-  u16 sub = Common::swap16(entry.sub);
-  u32 remaining_bytes = Common::swap32(entry.size);
+  const u32 size = Common::swap32(entry.size);
 
-  while (remaining_bytes > 0)
+  // Every block is encrypted on its own, so the blocks of a file are decrypted all at once.
+  std::vector<u8> data(Common::AlignUp(size, NAND_FAT_BLOCK_SIZE));
+  std::vector<Common::AES::BatchEntry> blocks;
+  u16 sub = Common::swap16(entry.sub);
+  for (size_t offset = 0; offset < data.size(); offset += NAND_FAT_BLOCK_SIZE)
   {
-    std::array<u8, 16> iv{};
-    std::vector<u8> block = Common::AES::Decrypt(
-        key.data(), iv.data(), &m_nand[NAND_FAT_BLOCK_SIZE * sub], NAND_FAT_BLOCK_SIZE);
-    u32 size = remaining_bytes < NAND_FAT_BLOCK_SIZE ? remaining_bytes : NAND_FAT_BLOCK_SIZE;
-    file.WriteBytes(block.data(), size);
-    remaining_bytes -= size;
+    blocks.push_back({&m_nand[NAND_FAT_BLOCK_SIZE * sub], &data[offset], NAND_FAT_BLOCK_SIZE});
     sub = Common::swap16(&m_nand[m_nand_fat_offset + 2 * sub]);
   }
+  Common::AES::DecryptEncryptBatch(key.data(), &blocks, Common::AES::Mode::Decrypt);
+
+  file.WriteBytes(data.data(), size);
 }
 
 bool NANDImporter::ExtractCertificates(const std::string& nand_root)
@@ -10,7 +10,6 @@
 #include <cstring>
 #include <map>
 #include <mbedtls/aes.h>
-#include <mbedtls/sha1.h>
 #include <memory>
 #include <optional>
 #include <string>
@@ -19,6 +18,7 @@
 
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
@@ -387,12 +387,11 @@ bool VolumeWii::CheckIntegrity(const Partition& partition) const
 
     for (u32 hashID = 0; hashID < 31; ++hashID)
     {
-      u8 hash[20];
-
-      mbedtls_sha1(clusterData + hashID * 0x400, 0x400, hash);
+      const Common::SHA1::Digest hash =
+          Common::SHA1::CalculateDigest(clusterData + hashID * 0x400, 0x400);
 
       // Note that we do not use strncmp here
-      if (memcmp(hash, clusterMD + hashID * 20, 20))
+      if (memcmp(hash.data(), clusterMD + hashID * 20, 20))
       {
         WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: hash %d is invalid", clusterID,
                  hashID);
@@ -0,0 +1,133 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DolphinNoGUI/CryptoBenchmark.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <mbedtls/aes.h>
+#include <mbedtls/sha1.h>
+#include <random>
+#include <vector>
+
+#include "Common/CPUDetect.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Crypto/SHA1.h"
+
+namespace CryptoBenchmark
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// As many buffers as a title typically has contents, for the batch.
+constexpr size_t BATCH_SIZE = 16;
+
+double MeasureSeconds(const std::function<void()>& function)
+{
+  const Clock::time_point start = Clock::now();
+  function();
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void PrintResult(const char* name, size_t size, double mbedtls_seconds, double seconds, bool match)
+{
+  const double megabytes = size / (1024.0 * 1024.0);
+  printf("%-14s mbedtls %8.1f MiB/s   Common/Crypto %8.1f MiB/s   %5.2fx%s\n", name,
+         megabytes / mbedtls_seconds, megabytes / seconds, mbedtls_seconds / seconds,
+         match ? "" : "   MISMATCH");
+}
+
+void CryptMbedTLS(const u8* key, u8* iv, const u8* src, u8* dst, size_t size,
+                  Common::AES::Mode mode)
+{
+  mbedtls_aes_context context;
+  mbedtls_aes_init(&context);
+  if (mode == Common::AES::Mode::Encrypt)
+    mbedtls_aes_setkey_enc(&context, key, 128);
+  else
+    mbedtls_aes_setkey_dec(&context, key, 128);
+  mbedtls_aes_crypt_cbc(&context,
+                        mode == Common::AES::Mode::Encrypt ? MBEDTLS_AES_ENCRYPT :
+                                                             MBEDTLS_AES_DECRYPT,
+                        size, iv, src, dst);
+  mbedtls_aes_free(&context);
+}
+}  // Anonymous namespace
+
+int Run(u32 megabytes)
+{
+  const size_t size = static_cast<size_t>(megabytes) * 1024 * 1024;
+  std::vector<u8> data(size);
+  std::mt19937 generator;
+  for (u8& byte : data)
+    byte = static_cast<u8>(generator());
+  const std::array<u8, 16> key = {{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7,
+                                   0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c}};
+
+  printf("%s\n", cpu_info.Summarize().c_str());
+  bool all_match = true;
+
+  {
+    std::array<u8, 20> expected;
+    Common::SHA1::Digest digest;
+    const double mbedtls_seconds =
+        MeasureSeconds([&] { mbedtls_sha1(data.data(), size, expected.data()); });
+    const double seconds =
+        MeasureSeconds([&] { digest = Common::SHA1::CalculateDigest(data.data(), size); });
+    const bool match = digest == expected;
+    PrintResult("SHA-1", size, mbedtls_seconds, seconds, match);
+    all_match &= match;
+  }
+
+  for (const Common::AES::Mode mode : {Common::AES::Mode::Decrypt, Common::AES::Mode::Encrypt})
+  {
+    std::vector<u8> expected(size);
+    std::vector<u8> output;
+    std::array<u8, 16> mbedtls_iv{};
+    std::array<u8, 16> iv{};
+    const double mbedtls_seconds = MeasureSeconds([&] {
+      CryptMbedTLS(key.data(), mbedtls_iv.data(), data.data(), expected.data(), size, mode);
+    });
+    const double seconds = MeasureSeconds([&] {
+      output = Common::AES::DecryptEncrypt(key.data(), iv.data(), data.data(), size, mode);
+    });
+    const bool match = output == expected && iv == mbedtls_iv;
+    PrintResult(mode == Common::AES::Mode::Decrypt ? "AES decrypt" : "AES encrypt", size,
+                mbedtls_seconds, seconds, match);
+    all_match &= match;
+  }
+
+  {
+    // Pieces like the contents of a title, which are decrypted one after another by mbedtls.
+    const size_t piece_size = size / BATCH_SIZE / 16 * 16;
+    std::vector<u8> expected(piece_size * BATCH_SIZE);
+    std::vector<u8> output(expected.size());
+    std::vector<Common::AES::BatchEntry> batch;
+    for (size_t i = 0; i < BATCH_SIZE; ++i)
+    {
+      Common::AES::BatchEntry entry{&data[i * piece_size], &output[i * piece_size], piece_size};
+      entry.iv[0] = static_cast<u8>(i);
+      batch.push_back(entry);
+    }
+    const double mbedtls_seconds = MeasureSeconds([&] {
+      for (size_t i = 0; i < BATCH_SIZE; ++i)
+      {
+        std::array<u8, 16> iv = batch[i].iv;
+        CryptMbedTLS(key.data(), iv.data(), &data[i * piece_size], &expected[i * piece_size],
+                     piece_size, Common::AES::Mode::Decrypt);
+      }
+    });
+    const double seconds = MeasureSeconds(
+        [&] { Common::AES::DecryptEncryptBatch(key.data(), &batch, Common::AES::Mode::Decrypt); });
+    const bool match = output == expected;
+    PrintResult("AES batch", expected.size(), mbedtls_seconds, seconds, match);
+    all_match &= match;
+  }
+
+  return all_match ? 0 : 1;
+}
+}
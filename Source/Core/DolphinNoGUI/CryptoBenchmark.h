@@ -0,0 +1,16 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Compares the SHA-1 and AES-128-CBC of Common/Crypto with calling mbedtls directly, which is what
+// title imports and the NAND importer used to do, on random data.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace CryptoBenchmark
+{
+// Returns the exit code of the program, which is not 0 if the results differ.
+int Run(u32 megabytes);
+}
@@ -0,0 +1,258 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DolphinNoGUI/FifoBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/StringUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
+#include "VideoCommon/PhaseTimer.h"
+
+namespace FifoBenchmark
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct FrameTiming
+{
+  u32 play;
+  u32 frame;
+  u64 total_ns;
+  PhaseTimer::Totals phase_ns;
+};
+
+struct Summary
+{
+  double mean;
+  double median;
+  double p95;
+  double p99;
+  double min;
+  double max;
+};
+
+u32 s_play_count = 0;
+u32 s_play = 0;
+std::vector<FrameTiming> s_frames;
+Clock::time_point s_frame_start;
+PhaseTimer::Totals s_frame_start_totals;
+Clock::time_point s_first_frame_start;
+Clock::time_point s_last_frame_end;
+
+void FrameWritten()
+{
+  s_frame_start = Clock::now();
+  s_frame_start_totals = PhaseTimer::GetTotals();
+  if (s_frames.empty())
+    s_first_frame_start = s_frame_start;
+}
+
+void FrameFinished()
+{
+  s_last_frame_end = Clock::now();
+  const PhaseTimer::Totals totals = PhaseTimer::GetTotals();
+
+  // Playback starts over at the beginning of the frame range.
+  const u32 frame = FifoPlayer::GetInstance().GetCurrentFrameNum();
+  if (!s_frames.empty() && frame <= s_frames.back().frame)
+    ++s_play;
+
+  FrameTiming timing;
+  timing.play = s_play;
+  timing.frame = frame;
+  timing.total_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(s_last_frame_end - s_frame_start)
+          .count();
+  for (size_t i = 0; i < PhaseTimer::NUM_PHASES; ++i)
+    timing.phase_ns[i] = totals[i] - s_frame_start_totals[i];
+  s_frames.push_back(timing);
+}
+
+// The first play compiles shaders and fills the caches, so it's left out of the statistics
+// unless there's nothing else.
+std::vector<const FrameTiming*> GetMeasuredFrames()
+{
+  const u32 first_play = s_play > 0 ? 1 : 0;
+  std::vector<const FrameTiming*> frames;
+  for (const FrameTiming& frame : s_frames)
+  {
+    if (frame.play >= first_play)
+      frames.push_back(&frame);
+  }
+  return frames;
+}
+
+// Takes nanoseconds and returns milliseconds.
+Summary Summarize(std::vector<u64> values)
+{
+  Summary summary{};
+  if (values.empty())
+    return summary;
+
+  std::sort(values.begin(), values.end());
+  const auto at = [&values](double fraction) {
+    const size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[index] / 1e6;
+  };
+
+  u64 sum = 0;
+  for (u64 value : values)
+    sum += value;
+
+  summary.mean = sum / 1e6 / values.size();
+  summary.median = at(0.5);
+  summary.p95 = at(0.95);
+  summary.p99 = at(0.99);
+  summary.min = values.front() / 1e6;
+  summary.max = values.back() / 1e6;
+  return summary;
+}
+
+Summary SummarizeTotal(const std::vector<const FrameTiming*>& frames)
+{
+  std::vector<u64> values;
+  for (const FrameTiming* frame : frames)
+    values.push_back(frame->total_ns);
+  return Summarize(std::move(values));
+}
+
+Summary SummarizePhase(const std::vector<const FrameTiming*>& frames, size_t phase)
+{
+  std::vector<u64> values;
+  for (const FrameTiming* frame : frames)
+    values.push_back(frame->phase_ns[phase]);
+  return Summarize(std::move(values));
+}
+
+std::string SummaryToJSON(const Summary& summary)
+{
+  return StringFromFormat("{\"mean\":%.4f,\"median\":%.4f,\"p95\":%.4f,\"p99\":%.4f,"
+                          "\"min\":%.4f,\"max\":%.4f}",
+                          summary.mean, summary.median, summary.p95, summary.p99, summary.min,
+                          summary.max);
+}
+
+std::string EscapeJSON(const std::string& str)
+{
+  std::string result;
+  result.reserve(str.size());
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    if (static_cast<unsigned char>(c) < 0x20)
+      result += StringFromFormat("\\u%04x", c);
+    else
+      result += c;
+  }
+  return result;
+}
+}  // Anonymous namespace
+
+void Start(u32 play_count)
+{
+  s_play_count = play_count;
+  s_play = 0;
+  s_frames.clear();
+
+  // Run the GPU as fast as it can.
+  SConfig::GetInstance().m_EmulationSpeed = 0.0f;
+
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  player.SetPlayCount(play_count);
+  player.SetFrameWrittenCallback(FrameWritten);
+  player.SetFrameFinishedCallback(FrameFinished);
+  PhaseTimer::SetEnabled(true);
+}
+
+void Stop()
+{
+  PhaseTimer::SetEnabled(false);
+
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  player.SetPlayCount(0);
+  player.SetFrameWrittenCallback(nullptr);
+  player.SetFrameFinishedCallback(nullptr);
+}
+
+void PrintSummary()
+{
+  const std::vector<const FrameTiming*> frames = GetMeasuredFrames();
+  printf("Played %u of %u times, %zu frames measured%s\n", s_frames.empty() ? 0 : s_play + 1,
+         s_play_count, frames.size(), s_play > 0 ? " (first play excluded)" : "");
+  if (frames.empty())
+    return;
+
+  printf("%-16s %10s %10s %10s %10s\n", "ms per frame", "mean", "median", "p95", "max");
+  const Summary total = SummarizeTotal(frames);
+  printf("%-16s %10.3f %10.3f %10.3f %10.3f\n", "total", total.mean, total.median, total.p95,
+         total.max);
+  for (size_t i = 0; i < PhaseTimer::NUM_PHASES; ++i)
+  {
+    const Summary phase = SummarizePhase(frames, i);
+    printf("%-16s %10.3f %10.3f %10.3f %10.3f\n",
+           PhaseTimer::GetPhaseName(static_cast<PhaseTimer::Phase>(i)), phase.mean, phase.median,
+           phase.p95, phase.max);
+  }
+}
+
+bool WriteJSON(const std::string& filename, const std::string& fifolog)
+{
+  File::IOFile f(filename, "w");
+  if (!f)
+  {
+    fprintf(stderr, "Failed to open %s for writing\n", filename.c_str());
+    return false;
+  }
+
+  const std::vector<const FrameTiming*> measured = GetMeasuredFrames();
+  const double wall_time_ms =
+      s_frames.empty() ? 0.0 : std::chrono::duration<double, std::milli>(s_last_frame_end -
+                                                                         s_first_frame_start)
+                                   .count();
+
+  std::FILE* const file = f.GetHandle();
+  fprintf(file, "{\n\"fifolog\":\"%s\",\n", EscapeJSON(fifolog).c_str());
+  fprintf(file, "\"video_backend\":\"%s\",\n",
+          EscapeJSON(SConfig::GetInstance().m_strVideoBackend).c_str());
+  fprintf(file, "\"play_count\":%u,\n\"plays_completed\":%u,\n", s_play_count,
+          s_frames.empty() ? 0 : s_play + 1);
+  fprintf(file, "\"first_play_excluded\":%s,\n\"measured_frames\":%zu,\n",
+          s_play > 0 ? "true" : "false", measured.size());
+  fprintf(file, "\"wall_time_ms\":%.3f,\n", wall_time_ms);
+  fprintf(file, "\"frame_time_ms\":%s,\n", SummaryToJSON(SummarizeTotal(measured)).c_str());
+  fprintf(file, "\"phase_time_ms\":{");
+  for (size_t i = 0; i < PhaseTimer::NUM_PHASES; ++i)
+  {
+    fprintf(file, "%s\n\"%s\":%s", i ? "," : "",
+            PhaseTimer::GetPhaseName(static_cast<PhaseTimer::Phase>(i)),
+            SummaryToJSON(SummarizePhase(measured, i)).c_str());
+  }
+  fprintf(file, "},\n\"frames\":[");
+  for (size_t i = 0; i < s_frames.size(); ++i)
+  {
+    const FrameTiming& frame = s_frames[i];
+    fprintf(file, "%s\n{\"play\":%u,\"frame\":%u,\"total_us\":%.1f", i ? "," : "", frame.play,
+            frame.frame, frame.total_ns / 1e3);
+    for (size_t phase = 0; phase < PhaseTimer::NUM_PHASES; ++phase)
+    {
+      fprintf(file, ",\"%s_us\":%.1f",
+              PhaseTimer::GetPhaseName(static_cast<PhaseTimer::Phase>(phase)),
+              frame.phase_ns[phase] / 1e3);
+    }
+    fprintf(file, "}");
+  }
+  fprintf(file, "]\n}\n");
+  return true;
+}
+}
@@ -0,0 +1,23 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Plays a fifolog a number of times as fast as possible and times every frame, split into the
+// phases of PhaseTimer.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace FifoBenchmark
+{
+// Must be called before booting the fifolog.
+void Start(u32 play_count);
+// Must be called once emulation has stopped.
+void Stop();
+
+void PrintSummary();
+bool WriteJSON(const std::string& filename, const std::string& fifolog);
+}
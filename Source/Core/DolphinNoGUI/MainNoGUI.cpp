@@ -3,13 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <OptionParser.h>
+#include <algorithm>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <memory>
 #include <signal.h>
 #include <string>
 #include <thread>
 #include <unistd.h>
+#include <variant>
 
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
@@ -28,8 +31,15 @@
 #include "Core/IOS/STM/STM.h"
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/IOS/USB/Bluetooth/WiimoteDevice.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 #include "Core/State.h"
 
+#include "DolphinNoGUI/CryptoBenchmark.h"
+#include "DolphinNoGUI/FifoBenchmark.h"
+#include "DolphinNoGUI/MovieFarm.h"
+#include "DolphinNoGUI/MovieVerifier.h"
+#include "DolphinNoGUI/RollbackBenchmark.h"
+
 #include "UICommon/CommandLineParse.h"
 #include "UICommon/UICommon.h"
 
@@ -376,9 +386,117 @@ static Platform* GetPlatform()
 int main(int argc, char* argv[])
 {
   auto parser = CommandLineParse::CreateParser(CommandLineParse::ParserOptions::OmitGUIOptions);
+  parser->add_option("--profile-folded")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Sample the guest CPU and write folded stacks to the file on exit");
+  parser->add_option("--profile-trace")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Sample the guest CPU and write a Chrome trace to the file on exit");
+  parser->add_option("--fifo-benchmark")
+      .action("store")
+      .metavar("<count>")
+      .type("int")
+      .help("Play the fifolog <count> times as fast as possible and print frame timings");
+  parser->add_option("--fifo-benchmark-json")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Write the frame timings of --fifo-benchmark to the file as JSON");
+  parser->add_option("--rollback-benchmark")
+      .action("store")
+      .metavar("<frames>")
+      .type("int")
+      .help("Run <frames> frames with NetPlay rollback snapshots and rollbacks, and print timings");
+  parser->add_option("--rollback-benchmark-depth")
+      .action("store")
+      .metavar("<frames>")
+      .type("int")
+      .set_default(8)
+      .help("How many frames --rollback-benchmark rolls back at a time");
+  parser->add_option("--crypto-benchmark")
+      .action("store")
+      .metavar("<MiB>")
+      .type("int")
+      .help("Hash, decrypt and encrypt <MiB> MiB with mbedtls and with the accelerated paths of "
+            "Common/Crypto, and print the throughputs");
+  parser->add_option("--verify-movies")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Verify the movies in the file, which has a game and a movie separated by a tab on "
+            "every line, each in its own process");
+  parser->add_option("--verify-jobs")
+      .action("store")
+      .metavar("<count>")
+      .type("int")
+      .set_default(std::max(1u, std::thread::hardware_concurrency()))
+      .help("How many movies --verify-movies runs at the same time");
+  parser->add_option("--verify-movie")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Play the movie as fast as possible and compare the RAM hashes to the ones of an "
+            "earlier run, or save them if there are none yet");
+  parser->add_option("--verify-hashes")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Where --verify-movie keeps the hashes instead of next to the movie");
+  parser->add_option("--verify-interval")
+      .action("store")
+      .metavar("<fields>")
+      .type("int")
+      .set_default(60)
+      .help("How many fields there are between two RAM hashes of --verify-movie");
+  parser->add_option("--verify-result")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Write the result of --verify-movie to the file");
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
 
+  std::string user_directory;
+  if (options.is_set("user"))
+  {
+    user_directory = static_cast<const char*>(options.get("user"));
+  }
+
+  const int verify_interval = options.get("verify_interval");
+  if (verify_interval < 1)
+  {
+    fprintf(stderr, "--verify-interval needs at least 1 field\n");
+    return 1;
+  }
+
+  if (options.is_set("crypto_benchmark"))
+  {
+    const int megabytes = options.get("crypto_benchmark");
+    if (megabytes < 1)
+    {
+      fprintf(stderr, "--crypto-benchmark needs at least 1 MiB\n");
+      return 1;
+    }
+    return CryptoBenchmark::Run(static_cast<u32>(megabytes));
+  }
+
+  if (options.is_set("verify_movies"))
+  {
+    const int jobs = options.get("verify_jobs");
+    if (jobs < 1)
+    {
+      fprintf(stderr, "--verify-jobs needs at least 1 job\n");
+      return 1;
+    }
+    UICommon::SetUserDirectory(user_directory);
+    return MovieFarm::Run(argv[0], static_cast<const char*>(options.get("verify_movies")),
+                          static_cast<u32>(jobs), static_cast<u32>(verify_interval));
+  }
+
   std::string boot_filename;
   if (options.is_set("exec"))
   {
@@ -395,12 +513,6 @@ int main(int argc, char* argv[])
     return 0;
   }
 
-  std::string user_directory;
-  if (options.is_set("user"))
-  {
-    user_directory = static_cast<const char*>(options.get("user"));
-  }
-
   platform = GetPlatform();
   if (!platform)
   {
@@ -411,6 +523,13 @@ int main(int argc, char* argv[])
   UICommon::SetUserDirectory(user_directory);
   UICommon::Init();
 
+  if (options.is_set("video_backend"))
+  {
+    SConfig::GetInstance().m_strVideoBackend =
+        static_cast<const char*>(options.get("video_backend"));
+    VideoBackendBase::ActivateBackend(SConfig::GetInstance().m_strVideoBackend);
+  }
+
   Core::SetOnStoppedCallback([]() { s_running.Clear(); });
   platform->Init();
 
@@ -424,7 +543,44 @@ int main(int argc, char* argv[])
 
   DolphinAnalytics::Instance()->ReportDolphinStart("nogui");
 
-  if (!BootManager::BootCore(BootParameters::GenerateFromFile(boot_filename)))
+  std::unique_ptr<BootParameters> boot = BootParameters::GenerateFromFile(boot_filename);
+  const bool fifo_benchmark = options.is_set("fifo_benchmark");
+  if (fifo_benchmark)
+  {
+    const int play_count = options.get("fifo_benchmark");
+    if (!boot || !std::holds_alternative<BootParameters::DFF>(boot->parameters) || play_count < 1)
+    {
+      fprintf(stderr, "--fifo-benchmark needs a fifolog and a play count of at least 1\n");
+      return 1;
+    }
+    FifoBenchmark::Start(static_cast<u32>(play_count));
+  }
+
+  const bool rollback_benchmark = options.is_set("rollback_benchmark");
+  if (rollback_benchmark)
+  {
+    const int frames = options.get("rollback_benchmark");
+    const int depth = options.get("rollback_benchmark_depth");
+    if (frames < 1 || depth < 1)
+    {
+      fprintf(stderr, "--rollback-benchmark needs at least 1 frame and a depth of at least 1\n");
+      return 1;
+    }
+    RollbackBenchmark::Start(static_cast<u32>(frames), static_cast<u32>(depth));
+  }
+
+  const bool verify_movie = options.is_set("verify_movie");
+  if (verify_movie)
+  {
+    const std::string movie = static_cast<const char*>(options.get("verify_movie"));
+    const std::string hashes = options.is_set("verify_hashes") ?
+                                   static_cast<const char*>(options.get("verify_hashes")) :
+                                   movie + ".hashes";
+    if (!MovieVerifier::Start(movie, hashes, static_cast<u32>(verify_interval)))
+      return 1;
+  }
+
+  if (!BootManager::BootCore(std::move(boot)))
   {
     fprintf(stderr, "Could not boot %s\n", boot_filename.c_str());
     return 1;
@@ -436,15 +592,57 @@ int main(int argc, char* argv[])
     updateMainFrameEvent.Wait();
   }
 
+  const bool sampling = options.is_set("profile_folded") || options.is_set("profile_trace");
+  if (sampling && s_running.IsSet())
+    Profiler::StartSampling();
+
   if (s_running.IsSet())
     platform->MainLoop();
+
+  if (sampling)
+  {
+    Profiler::StopSampling();
+    if (options.is_set("profile_folded"))
+      Profiler::WriteFoldedStacks(static_cast<const char*>(options.get("profile_folded")));
+    if (options.is_set("profile_trace"))
+      Profiler::WriteChromeTrace(static_cast<const char*>(options.get("profile_trace")));
+  }
   Core::Stop();
 
   Core::Shutdown();
+
+  if (fifo_benchmark)
+  {
+    FifoBenchmark::Stop();
+    FifoBenchmark::PrintSummary();
+    if (options.is_set("fifo_benchmark_json"))
+    {
+      FifoBenchmark::WriteJSON(static_cast<const char*>(options.get("fifo_benchmark_json")),
+                               boot_filename);
+    }
+  }
+  if (rollback_benchmark)
+  {
+    RollbackBenchmark::Stop();
+    RollbackBenchmark::PrintSummary();
+  }
+  int exit_code = 0;
+  if (verify_movie)
+  {
+    MovieVerifier::Stop();
+    MovieVerifier::PrintSummary();
+    if (options.is_set("verify_result"))
+      MovieVerifier::WriteResult(static_cast<const char*>(options.get("verify_result")));
+
+    if (MovieVerifier::GetStatus() == MovieVerifier::Status::Desynced)
+      exit_code = 2;
+    else if (MovieVerifier::GetStatus() == MovieVerifier::Status::Failed)
+      exit_code = 1;
+  }
   platform->Shutdown();
   UICommon::Shutdown();
 
   delete platform;
 
-  return 0;
+  return exit_code;
 }
@@ -0,0 +1,230 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DolphinNoGUI/MovieFarm.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/IniFile.h"
+#include "Common/StringUtil.h"
+
+namespace MovieFarm
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Job
+{
+  std::string game;
+  std::string movie;
+  std::string user_directory;
+  pid_t pid = -1;
+};
+
+struct Totals
+{
+  u32 passed = 0;
+  u32 recorded = 0;
+  u32 desynced = 0;
+  u32 failed = 0;
+  u64 frames = 0;
+};
+
+bool ReadList(const std::string& filename, std::vector<Job>* jobs)
+{
+  std::string contents;
+  if (!File::ReadFileToString(filename, contents))
+    return false;
+
+  std::istringstream stream(contents);
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    line = StripSpaces(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    const size_t tab = line.find('\t');
+    if (tab == std::string::npos)
+    {
+      fprintf(stderr, "Ignoring a line without a tab: %s\n", line.c_str());
+      continue;
+    }
+
+    Job job;
+    job.game = StripSpaces(line.substr(0, tab));
+    job.movie = StripSpaces(line.substr(tab + 1));
+    jobs->push_back(std::move(job));
+  }
+  return true;
+}
+
+bool Spawn(const std::string& executable, u32 interval, Job* job)
+{
+  job->user_directory = File::CreateTempDir();
+  if (job->user_directory.empty())
+    return false;
+
+  // The settings of the farm's user directory are the starting point of every movie, but
+  // nothing a movie writes ends up there.
+  File::CopyDir(File::GetUserPath(D_CONFIG_IDX), job->user_directory + DIR_SEP CONFIG_DIR);
+
+  const std::string log_filename = job->user_directory + DIR_SEP "log.txt";
+  const std::string interval_string = StringFromFormat("%u", interval);
+  const std::vector<std::string> args = {
+      executable,
+      "--user",
+      job->user_directory,
+      "--video_backend",
+      "Null",
+      "--verify-movie",
+      job->movie,
+      "--verify-hashes",
+      job->movie + ".hashes",
+      "--verify-interval",
+      interval_string,
+      "--verify-result",
+      job->user_directory + DIR_SEP "result.ini",
+      job->game,
+  };
+
+  job->pid = fork();
+  if (job->pid < 0)
+    return false;
+
+  if (job->pid == 0)
+  {
+    const int log = open(log_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log >= 0)
+    {
+      dup2(log, STDOUT_FILENO);
+      dup2(log, STDERR_FILENO);
+      close(log);
+    }
+
+    std::vector<char*> argv;
+    for (const std::string& arg : args)
+      argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+
+  return true;
+}
+
+// Prints the result of a job which has exited and cleans up after it.
+void Finish(const Job& job, int wait_status, Totals* totals)
+{
+  IniFile ini;
+  std::string status = "failed";
+  u64 frames = 0;
+  double seconds = 0;
+  u64 desync_field = 0;
+  if (ini.Load(job.user_directory + DIR_SEP "result.ini"))
+  {
+    const IniFile::Section* result = ini.GetOrCreateSection("Result");
+    result->Get("Status", &status, "failed");
+    result->Get("Frames", &frames, 0);
+    result->Get("Seconds", &seconds, 0.0);
+    result->Get("DesyncField", &desync_field, 0);
+  }
+  if (!WIFEXITED(wait_status))
+    status = "failed";
+
+  printf("%-8s %10" PRIu64 " frames %8.1f frames/s  %s", status.c_str(), frames,
+         seconds > 0 ? frames / seconds : 0.0, job.movie.c_str());
+  if (status == "desynced")
+    printf(" (around field %" PRIu64 ")", desync_field);
+  printf("\n");
+
+  totals->frames += frames;
+  if (status == "passed")
+    ++totals->passed;
+  else if (status == "recorded")
+    ++totals->recorded;
+  else if (status == "desynced")
+    ++totals->desynced;
+  else
+    ++totals->failed;
+
+  // What went wrong is in the log of the job, so keep it.
+  if (status == "failed")
+    printf("         log: %s\n", (job.user_directory + DIR_SEP "log.txt").c_str());
+  else
+    File::DeleteDirRecursively(job.user_directory);
+  fflush(stdout);
+}
+}  // Anonymous namespace
+
+int Run(const std::string& executable, const std::string& list_filename, u32 jobs, u32 interval)
+{
+  std::vector<Job> pending;
+  if (!ReadList(list_filename, &pending))
+  {
+    fprintf(stderr, "Could not read %s\n", list_filename.c_str());
+    return 1;
+  }
+
+  const Clock::time_point start = Clock::now();
+  Totals totals;
+  std::vector<Job> running;
+  size_t next = 0;
+  while (next < pending.size() || !running.empty())
+  {
+    while (next < pending.size() && running.size() < jobs)
+    {
+      Job& job = pending[next++];
+      if (!Spawn(executable, interval, &job))
+      {
+        fprintf(stderr, "Could not start a job for %s\n", job.movie.c_str());
+        ++totals.failed;
+        continue;
+      }
+      running.push_back(job);
+    }
+
+    int wait_status;
+    const pid_t pid = waitpid(-1, &wait_status, 0);
+    if (pid < 0)
+    {
+      // Interrupted by a signal, which the jobs got as well.
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    for (auto it = running.begin(); it != running.end(); ++it)
+    {
+      if (it->pid == pid)
+      {
+        Finish(*it, wait_status, &totals);
+        running.erase(it);
+        break;
+      }
+    }
+  }
+
+  const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  printf("%u passed, %u recorded, %u desynced, %u failed\n", totals.passed, totals.recorded,
+         totals.desynced, totals.failed);
+  printf("%" PRIu64 " frames in %.1f s with %u jobs: %.1f frames/s\n", totals.frames, seconds,
+         jobs, seconds > 0 ? totals.frames / seconds : 0.0);
+
+  return totals.desynced == 0 && totals.failed == 0 ? 0 : 1;
+}
+}
@@ -0,0 +1,21 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Verifies a list of movies with MovieVerifier, running a number of them at the same time. Every
+// movie gets its own process and its own user directory, so the emulators can't affect each
+// other through global state or the files they write.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace MovieFarm
+{
+// Every line of the list is the path of a game and the path of a movie, separated by a tab.
+// The hashes of a movie are kept next to it with the extension .hashes; a movie which doesn't
+// have them yet gets them from this run. Returns the exit code of the program.
+int Run(const std::string& executable, const std::string& list_filename, u32 jobs, u32 interval);
+}
@@ -0,0 +1,248 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DolphinNoGUI/MovieVerifier.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/IniFile.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/HW/VideoInterface.h"
+#include "Core/Movie.h"
+#include "Core/Rollback.h"
+
+namespace MovieVerifier
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Mark
+{
+  u64 ticks;
+  u64 hash;
+};
+
+Status s_status = Status::Failed;
+std::string s_hashes_filename;
+u32 s_interval = 0;
+bool s_verifying = false;
+bool s_stopping = false;
+
+// The marks of the earlier run when verifying, or of this run when recording.
+std::vector<Mark> s_marks;
+size_t s_mark_count = 0;
+u64 s_next_mark_ticks = 0;
+bool s_finished = false;
+bool s_desynced = false;
+
+Clock::time_point s_start;
+double s_seconds = 0;
+// Fields of the video interface, which go on even when a game doesn't draw anything.
+u64 s_frames = 0;
+
+void StopEmulation()
+{
+  if (s_stopping)
+    return;
+  s_stopping = true;
+  s_frames = CoreTiming::GetTicks() / VideoInterface::GetTicksPerField();
+  s_seconds = std::chrono::duration<double>(Clock::now() - s_start).count();
+  Core::QueueHostJob([] { Core::Stop(); });
+}
+
+// The framebuffers are in RAM too, since XFB copies go there.
+u64 HashRAM()
+{
+  // This hash doesn't depend on the features of the host CPU, unlike GetHash64.
+  u64 hash = GetHashHiresTexture(Memory::m_pRAM, Memory::REALRAM_SIZE);
+  if (SConfig::GetInstance().bWii && Memory::m_pEXRAM)
+    hash ^= GetHashHiresTexture(Memory::m_pEXRAM, Memory::EXRAM_SIZE) * 31;
+  return hash;
+}
+
+void AddMark(u64 ticks)
+{
+  const u64 hash = HashRAM();
+  if (!s_verifying)
+  {
+    s_marks.push_back({ticks, hash});
+    ++s_mark_count;
+    return;
+  }
+
+  if (s_mark_count >= s_marks.size() || s_marks[s_mark_count].ticks != ticks ||
+      s_marks[s_mark_count].hash != hash)
+  {
+    s_desynced = true;
+    StopEmulation();
+    return;
+  }
+  ++s_mark_count;
+}
+
+// Runs on the CPU thread at every VI update, where the emulated time is the same every run.
+void SafePoint()
+{
+  if (s_finished || s_desynced)
+    return;
+
+  // Like the movie itself, playback ends once the last input was reached, even if the game
+  // doesn't poll for it.
+  const u64 ticks = CoreTiming::GetTicks();
+  if (!Movie::IsPlayingInput() ||
+      (ticks > Movie::GetTotalTickCount() && !Movie::IsRecordingInputFromSaveState()))
+  {
+    s_finished = true;
+    StopEmulation();
+    return;
+  }
+
+  if (ticks < s_next_mark_ticks)
+    return;
+
+  AddMark(ticks);
+  s_next_mark_ticks = ticks + u64{s_interval} * VideoInterface::GetTicksPerField();
+}
+
+bool LoadMarks(const std::string& filename)
+{
+  std::string contents;
+  if (!File::ReadFileToString(filename, contents))
+    return false;
+
+  std::istringstream stream(contents);
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    Mark mark;
+    if (sscanf(line.c_str(), "%" SCNx64 " %" SCNx64, &mark.ticks, &mark.hash) == 2)
+      s_marks.push_back(mark);
+  }
+  return true;
+}
+
+bool SaveMarks(const std::string& filename)
+{
+  File::IOFile file(filename, "w");
+  for (const Mark& mark : s_marks)
+  {
+    if (fprintf(file.GetHandle(), "%016" PRIx64 " %016" PRIx64 "\n", mark.ticks, mark.hash) < 0)
+      return false;
+  }
+  return file.IsGood();
+}
+
+const char* GetStatusName(Status status)
+{
+  switch (status)
+  {
+  case Status::Passed:
+    return "passed";
+  case Status::Recorded:
+    return "recorded";
+  case Status::Desynced:
+    return "desynced";
+  default:
+    return "failed";
+  }
+}
+}  // Anonymous namespace
+
+bool Start(const std::string& movie, const std::string& hashes_filename, u32 interval)
+{
+  s_status = Status::Failed;
+  s_hashes_filename = hashes_filename;
+  s_interval = interval;
+  s_stopping = false;
+  s_marks.clear();
+  s_mark_count = 0;
+  s_next_mark_ticks = 0;
+  s_finished = false;
+  s_desynced = false;
+  s_seconds = 0;
+  s_frames = 0;
+
+  s_verifying = File::Exists(hashes_filename);
+  if (s_verifying && !LoadMarks(hashes_filename))
+  {
+    fprintf(stderr, "Could not read %s\n", hashes_filename.c_str());
+    return false;
+  }
+
+  // Nothing is shown or heard, and nothing waits for real time. The settings the movie was
+  // recorded with are applied by the boot itself.
+  SConfig& config = SConfig::GetInstance();
+  config.m_EmulationSpeed = 0.0f;
+  config.sBackend = BACKEND_NULLSOUND;
+  config.m_DumpAudio = false;
+  config.m_PauseMovie = false;
+  config.m_MovieKeyframeInterval = 0;
+  Movie::SetReadOnly(true);
+
+  if (!Movie::PlayInput(movie))
+  {
+    fprintf(stderr, "Could not play %s\n", movie.c_str());
+    return false;
+  }
+
+  Rollback::SetSafePointCallback(SafePoint);
+  s_start = Clock::now();
+  return true;
+}
+
+void Stop()
+{
+  Rollback::SetSafePointCallback(nullptr);
+
+  if (s_desynced || (s_finished && s_verifying && s_mark_count != s_marks.size()))
+    s_status = Status::Desynced;
+  else if (!s_finished || s_frames == 0)
+    s_status = Status::Failed;
+  else if (s_verifying)
+    s_status = Status::Passed;
+  else
+    s_status = SaveMarks(s_hashes_filename) ? Status::Recorded : Status::Failed;
+}
+
+Status GetStatus()
+{
+  return s_status;
+}
+
+void PrintSummary()
+{
+  printf("%s: %" PRIu64 " frames in %.2f s (%.1f frames/s), %zu marks\n", GetStatusName(s_status),
+         s_frames, s_seconds, s_seconds > 0 ? s_frames / s_seconds : 0.0, s_mark_count);
+  if (s_status == Status::Desynced)
+  {
+    printf("First mismatch at mark %zu, field %" PRIu64 "\n", s_mark_count,
+           static_cast<u64>(s_mark_count) * s_interval);
+  }
+}
+
+bool WriteResult(const std::string& filename)
+{
+  IniFile ini;
+  IniFile::Section* result = ini.GetOrCreateSection("Result");
+  result->Set("Status", std::string(GetStatusName(s_status)));
+  result->Set("Frames", s_frames);
+  result->Set("Seconds", s_seconds);
+  result->Set("Marks", static_cast<u64>(s_mark_count));
+  if (s_status == Status::Desynced)
+    result->Set("DesyncField", static_cast<u64>(s_mark_count) * s_interval);
+  return ini.Save(filename);
+}
+}
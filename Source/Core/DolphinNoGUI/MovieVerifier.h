@@ -0,0 +1,33 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Plays a movie as fast as possible and hashes the emulated RAM every few fields. The hashes are
+// compared to the ones of an earlier run, or saved if there are none yet, to find desyncs.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace MovieVerifier
+{
+enum class Status
+{
+  Passed,
+  Recorded,
+  Desynced,
+  Failed,
+};
+
+// Must be called before booting the game.
+bool Start(const std::string& movie, const std::string& hashes_filename, u32 interval);
+// Must be called once emulation has stopped.
+void Stop();
+
+Status GetStatus();
+void PrintSummary();
+// For MovieFarm, which runs every movie in its own process.
+bool WriteResult(const std::string& filename);
+}
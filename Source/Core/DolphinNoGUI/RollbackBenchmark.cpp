@@ -0,0 +1,207 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DolphinNoGUI/RollbackBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/VideoInterface.h"
+#include "Core/Rollback.h"
+
+namespace RollbackBenchmark
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Frames between two rollbacks.
+constexpr u32 ROLLBACK_INTERVAL = 30;
+constexpr double FRAME_BUDGET_MS = 1000.0 / 60;
+
+struct Summary
+{
+  double mean;
+  double p95;
+};
+
+u32 s_frame_count = 0;
+u32 s_depth = 0;
+std::unique_ptr<Rollback::SnapshotRing> s_snapshots;
+bool s_stopping = false;
+
+// The emulated time at which every frame started, so that frames are counted the same way when
+// they are replayed.
+std::vector<u64> s_frame_ticks;
+u32 s_frame = 0;
+u32 s_replay_end = 0;
+bool s_measure_frame = false;
+Clock::time_point s_frame_start;
+Clock::time_point s_replay_start;
+
+size_t s_snapshot_size = 0;
+std::vector<u64> s_frame_ns;
+std::vector<u64> s_save_ns;
+std::vector<u64> s_load_ns;
+std::vector<u64> s_replay_ns;
+
+u64 GetElapsedNs(Clock::time_point start)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+void StopEmulation()
+{
+  if (s_stopping)
+    return;
+  s_stopping = true;
+  Core::QueueHostJob([] { Core::Stop(); });
+}
+
+void SafePoint()
+{
+  if (SConfig::GetInstance().bCPUThread)
+  {
+    fprintf(stderr, "Rollback needs single core mode\n");
+    StopEmulation();
+    return;
+  }
+
+  const u64 ticks = CoreTiming::GetTicks();
+  if (s_frame_ticks.empty())
+    s_frame_ticks.push_back(ticks);
+
+  const bool is_known_frame = s_frame + 1 < s_frame_ticks.size();
+  const u64 next_frame_ticks = is_known_frame ?
+                                   s_frame_ticks[s_frame + 1] :
+                                   s_frame_ticks[s_frame] + VideoInterface::GetTicksPerField();
+  if (ticks < next_frame_ticks)
+    return;
+  if (!is_known_frame)
+    s_frame_ticks.push_back(ticks);
+  ++s_frame;
+
+  if (Rollback::IsReplaying())
+  {
+    if (s_frame == s_replay_end)
+    {
+      s_replay_ns.push_back(GetElapsedNs(s_replay_start) / s_depth);
+      Rollback::SetReplaying(false);
+    }
+  }
+  else if (s_measure_frame)
+  {
+    s_frame_ns.push_back(GetElapsedNs(s_frame_start));
+  }
+
+  if (s_frame >= s_frame_count)
+  {
+    StopEmulation();
+    return;
+  }
+
+  Clock::time_point start = Clock::now();
+  s_snapshots->Save(s_frame);
+  s_save_ns.push_back(GetElapsedNs(start));
+  s_snapshot_size = s_snapshots->GetSnapshotSize();
+
+  if (!Rollback::IsReplaying() && s_frame > s_replay_end && s_frame % ROLLBACK_INTERVAL == 0 &&
+      s_snapshots->Contains(s_frame - s_depth))
+  {
+    start = Clock::now();
+    s_snapshots->Load(s_frame - s_depth);
+    s_load_ns.push_back(GetElapsedNs(start));
+
+    s_replay_end = s_frame;
+    s_frame -= s_depth;
+    s_measure_frame = false;
+    Rollback::SetReplaying(true);
+    s_replay_start = Clock::now();
+    return;
+  }
+
+  s_measure_frame = !Rollback::IsReplaying();
+  s_frame_start = Clock::now();
+}
+
+// Takes nanoseconds and returns milliseconds.
+Summary Summarize(std::vector<u64> values)
+{
+  Summary summary{};
+  if (values.empty())
+    return summary;
+
+  std::sort(values.begin(), values.end());
+  u64 sum = 0;
+  for (u64 value : values)
+    sum += value;
+
+  summary.mean = sum / 1e6 / values.size();
+  summary.p95 = values[static_cast<size_t>(0.95 * (values.size() - 1) + 0.5)] / 1e6;
+  return summary;
+}
+}  // Anonymous namespace
+
+void Start(u32 frames, u32 depth)
+{
+  s_frame_count = frames;
+  s_depth = depth;
+  s_snapshots = std::make_unique<Rollback::SnapshotRing>(depth + 1);
+  s_stopping = false;
+  s_frame_ticks.clear();
+  s_frame = 0;
+  s_replay_end = 0;
+  s_measure_frame = false;
+  s_snapshot_size = 0;
+  s_frame_ns.clear();
+  s_save_ns.clear();
+  s_load_ns.clear();
+  s_replay_ns.clear();
+
+  // Snapshots can only be taken with the GPU on the CPU thread, and everything runs as fast as
+  // it can so that the time of a frame is what it costs.
+  SConfig::GetInstance().bCPUThread = false;
+  SConfig::GetInstance().m_EmulationSpeed = 0.0f;
+  Rollback::SetSafePointCallback(SafePoint);
+}
+
+void Stop()
+{
+  Rollback::SetSafePointCallback(nullptr);
+  Rollback::SetReplaying(false);
+  s_snapshots.reset();
+}
+
+void PrintSummary()
+{
+  printf("%u frames, %zu rollbacks of %u frames, snapshots of %.2f MiB\n", s_frame_count,
+         s_load_ns.size(), s_depth, s_snapshot_size / 1048576.0);
+
+  const Summary frame = Summarize(s_frame_ns);
+  const Summary save = Summarize(s_save_ns);
+  const Summary load = Summarize(s_load_ns);
+  const Summary replay = Summarize(s_replay_ns);
+  printf("%-24s %10s %10s\n", "ms", "mean", "p95");
+  printf("%-24s %10.3f %10.3f\n", "frame", frame.mean, frame.p95);
+  printf("%-24s %10.3f %10.3f\n", "save snapshot", save.mean, save.p95);
+  printf("%-24s %10.3f %10.3f\n", "load snapshot", load.mean, load.p95);
+  printf("%-24s %10.3f %10.3f\n", "replayed frame", replay.mean, replay.p95);
+
+  // A frame with a rollback of n frames runs the frame itself, saves a snapshot, loads one and
+  // replays n frames, each of which saves a snapshot too.
+  if (replay.mean > 0)
+  {
+    const double spare_ms = FRAME_BUDGET_MS - frame.mean - save.mean - load.mean;
+    const int depth = std::max(0, static_cast<int>(spare_ms / replay.mean));
+    printf("Rollbacks of up to %d frames fit in a %.2f ms frame\n", depth, FRAME_BUDGET_MS);
+  }
+}
+}
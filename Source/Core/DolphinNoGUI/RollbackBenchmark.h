@@ -0,0 +1,20 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Runs a game while taking a rollback snapshot every frame, and rolls back a number of frames
+// every half second, to measure what NetPlay rollback costs with that game on this machine.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace RollbackBenchmark
+{
+// Must be called before booting the game. Stops emulation after the given number of frames.
+void Start(u32 frames, u32 depth);
+// Must be called once emulation has stopped.
+void Stop();
+
+void PrintSummary();
+}
@@ -2,7 +2,6 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
-#include <QCryptographicHash>
 #include <QDataStream>
 #include <QDir>
 #include <QImage>
@@ -24,9 +23,6 @@
 #include "DolphinQt2/Resources.h"
 #include "DolphinQt2/Settings.h"
 
-static const int CACHE_VERSION = 13;  // Last changed in PR #3261
-static const int DATASTREAM_VERSION = QDataStream::Qt_5_5;
-
 QList<DiscIO::Language> GameFile::GetAvailableLanguages() const
 {
   return m_long_names.keys();
@@ -41,23 +37,40 @@ ConvertLanguageMap(const std::map<DiscIO::Language, std::string>& map)
   return result;
 }
 
-GameFile::GameFile(const QString& path) : m_path(path)
+static void WriteLanguageMap(QDataStream& stream, const QMap<DiscIO::Language, QString>& map)
+{
+  stream << static_cast<qint32>(map.size());
+  for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+    stream << static_cast<qint32>(it.key()) << it.value();
+}
+
+static QMap<DiscIO::Language, QString> ReadLanguageMap(QDataStream& stream)
 {
-  m_valid = false;
+  QMap<DiscIO::Language, QString> map;
+  qint32 size = 0;
+  stream >> size;
+  for (qint32 i = 0; i < size && stream.status() == QDataStream::Ok; ++i)
+  {
+    qint32 language;
+    QString string;
+    stream >> language >> string;
+    map.insert(static_cast<DiscIO::Language>(language), string);
+  }
+  return map;
+}
 
+GameFile::GameFile(const QString& path) : m_path(path)
+{
   if (!LoadFileInfo(path))
     return;
 
-  if (!TryLoadCache())
+  if (TryLoadVolume())
   {
-    if (TryLoadVolume())
-    {
-      LoadState();
-    }
-    else if (!TryLoadElfDol())
-    {
-      return;
-    }
+    LoadState();
+  }
+  else if (!TryLoadElfDol())
+  {
+    return;
   }
 
   m_valid = true;
@@ -74,16 +87,6 @@ bool GameFile::IsValid() const
   return true;
 }
 
-QString GameFile::GetCacheFileName() const
-{
-  QString folder = QString::fromStdString(File::GetUserPath(D_CACHE_IDX));
-  // Append a hash of the full path to prevent name clashes between
-  // files with the same names in different folders.
-  QString hash =
-      QString::fromUtf8(QCryptographicHash::hash(m_path.toUtf8(), QCryptographicHash::Md5).toHex());
-  return folder + m_file_name + hash;
-}
-
 void GameFile::ReadBanner(const DiscIO::Volume& volume)
 {
   int width, height;
@@ -96,6 +99,7 @@ void GameFile::ReadBanner(const DiscIO::Volume& volume)
                                (buffer[i] & 0x0000FF) >> 0));
   }
 
+  m_banner_image = banner;
   if (!banner.isNull())
     m_banner = QPixmap::fromImage(banner);
   else
@@ -131,25 +135,15 @@ bool GameFile::IsElfOrDol()
   return m_extension == QStringLiteral("elf") || m_extension == QStringLiteral("dol");
 }
 
-bool GameFile::TryLoadCache()
+bool GameFile::ReloadState()
 {
-  QFile cache(GetCacheFileName());
-  if (!cache.exists())
-    return false;
-  if (!cache.open(QIODevice::ReadOnly))
+  if (m_platform == DiscIO::Platform::ELF_DOL)
     return false;
-  if (QFileInfo(cache).lastModified() < m_last_modified)
-    return false;
-
-  QDataStream in(&cache);
-  in.setVersion(DATASTREAM_VERSION);
 
-  int cache_version;
-  in >> cache_version;
-  if (cache_version != CACHE_VERSION)
-    return false;
-
-  return false;
+  const int old_rating = m_rating;
+  const QString old_issues = m_issues;
+  LoadState();
+  return m_rating != old_rating || m_issues != old_issues;
 }
 
 bool GameFile::TryLoadVolume()
@@ -181,7 +175,6 @@ bool GameFile::TryLoadVolume()
 
   ReadBanner(*volume);
 
-  SaveCache();
   return true;
 }
 
@@ -203,9 +196,85 @@ bool GameFile::TryLoadElfDol()
   return true;
 }
 
-void GameFile::SaveCache()
+void GameFile::Serialize(QDataStream& stream) const
 {
-  // TODO
+  stream << m_path << m_file_name << m_extension << m_folder << m_last_modified << m_size;
+  stream << m_game_id << m_maker << m_maker_id << m_revision << static_cast<quint64>(m_title_id)
+         << m_internal_name;
+  WriteLanguageMap(stream, m_short_names);
+  WriteLanguageMap(stream, m_long_names);
+  WriteLanguageMap(stream, m_short_makers);
+  WriteLanguageMap(stream, m_long_makers);
+  WriteLanguageMap(stream, m_descriptions);
+  stream << m_company << m_disc_number << static_cast<qint32>(m_region)
+         << static_cast<qint32>(m_platform) << static_cast<qint32>(m_country)
+         << static_cast<qint32>(m_blob_type) << static_cast<quint64>(m_raw_size);
+
+  // Only the pixels, which is a lot smaller than what QImage's own operator<< writes (a PNG).
+  stream << static_cast<qint32>(m_banner_image.width())
+         << static_cast<qint32>(m_banner_image.height());
+  if (!m_banner_image.isNull())
+  {
+    stream.writeRawData(reinterpret_cast<const char*>(m_banner_image.constBits()),
+                        m_banner_image.bytesPerLine() * m_banner_image.height());
+  }
+
+  stream << m_issues << static_cast<qint32>(m_rating) << m_apploader_date;
+}
+
+QSharedPointer<GameFile> GameFile::Deserialize(QDataStream& stream)
+{
+  QSharedPointer<GameFile> game(new GameFile);
+
+  quint64 title_id, raw_size;
+  qint32 region, platform, country, blob_type;
+  stream >> game->m_path >> game->m_file_name >> game->m_extension >> game->m_folder >>
+      game->m_last_modified >> game->m_size;
+  stream >> game->m_game_id >> game->m_maker >> game->m_maker_id >> game->m_revision >> title_id >>
+      game->m_internal_name;
+  game->m_short_names = ReadLanguageMap(stream);
+  game->m_long_names = ReadLanguageMap(stream);
+  game->m_short_makers = ReadLanguageMap(stream);
+  game->m_long_makers = ReadLanguageMap(stream);
+  game->m_descriptions = ReadLanguageMap(stream);
+  stream >> game->m_company >> game->m_disc_number >> region >> platform >> country >> blob_type >>
+      raw_size;
+  game->m_title_id = title_id;
+  game->m_region = static_cast<DiscIO::Region>(region);
+  game->m_platform = static_cast<DiscIO::Platform>(platform);
+  game->m_country = static_cast<DiscIO::Country>(country);
+  game->m_blob_type = static_cast<DiscIO::BlobType>(blob_type);
+  game->m_raw_size = raw_size;
+
+  qint32 banner_width, banner_height;
+  stream >> banner_width >> banner_height;
+  if (banner_width < 0 || banner_height < 0 || banner_width > 1024 || banner_height > 1024)
+  {
+    stream.setStatus(QDataStream::ReadCorruptData);
+    return {};
+  }
+  if (banner_width != 0 && banner_height != 0)
+  {
+    QImage banner(banner_width, banner_height, QImage::Format_RGB888);
+    stream.readRawData(reinterpret_cast<char*>(banner.bits()),
+                       banner.bytesPerLine() * banner.height());
+    game->m_banner_image = banner;
+    game->m_banner = QPixmap::fromImage(banner);
+  }
+  else
+  {
+    game->m_banner = Resources::GetMisc(Resources::BANNER_MISSING);
+  }
+
+  qint32 rating;
+  stream >> game->m_issues >> rating >> game->m_apploader_date;
+  game->m_rating = rating;
+
+  if (stream.status() != QDataStream::Ok)
+    return {};
+
+  game->m_valid = true;
+  return game;
 }
 
 QString GameFile::GetBannerString(const QMap<DiscIO::Language, QString>& m) const
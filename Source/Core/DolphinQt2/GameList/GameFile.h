@@ -5,8 +5,10 @@
 #pragma once
 
 #include <QDateTime>
+#include <QImage>
 #include <QMap>
 #include <QPixmap>
+#include <QSharedPointer>
 #include <QString>
 
 #include "Common/CommonTypes.h"
@@ -21,7 +23,8 @@ enum class Platform;
 class Volume;
 }
 
-// TODO cache
+class QDataStream;
+
 class GameFile final
 {
 public:
@@ -34,6 +37,7 @@ public:
   QString GetFileExtension() const { return m_extension; }
   QString GetFileFolder() const { return m_folder; }
   qint64 GetFileSize() const { return m_size; }
+  QDateTime GetLastModified() const { return m_last_modified; }
   // The rest will not.
   QString GetGameID() const { return m_game_id; }
   QString GetMakerID() const { return m_maker_id; }
@@ -72,20 +76,28 @@ public:
   bool Uninstall();
   bool ExportWiiSave();
 
+  // Reads the rating and the issues from the game INIs again, since they can change without the
+  // file changing. Returns whether they changed.
+  bool ReloadState();
+
+  // For GameFileCache. The file isn't opened when deserializing, so it's up to the caller to
+  // check whether the file still has the size and the modification time of the serialized game.
+  void Serialize(QDataStream& stream) const;
+  static QSharedPointer<GameFile> Deserialize(QDataStream& stream);
+
 private:
+  GameFile() = default;
+
   QString GetBannerString(const QMap<DiscIO::Language, QString>& m) const;
 
-  QString GetCacheFileName() const;
   void ReadBanner(const DiscIO::Volume& volume);
   bool LoadFileInfo(const QString& path);
   void LoadState();
   bool IsElfOrDol();
   bool TryLoadElfDol();
-  bool TryLoadCache();
   bool TryLoadVolume();
-  void SaveCache();
 
-  bool m_valid;
+  bool m_valid = false;
   QString m_path;
   QString m_file_name;
   QString m_extension;
@@ -112,6 +124,8 @@ private:
   DiscIO::BlobType m_blob_type;
   u64 m_raw_size = 0;
   QPixmap m_banner;
+  // The banner as read from the volume, which is null if it doesn't have one.
+  QImage m_banner_image;
   QString m_issues;
   int m_rating = 0;
   QString m_apploader_date;
@@ -0,0 +1,114 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "DolphinQt2/GameList/GameFileCache.h"
+
+// Increase this when GameFile::Serialize changes.
+static const qint32 CACHE_VERSION = 1;
+static const int DATASTREAM_VERSION = QDataStream::Qt_5_5;
+
+GameFileCache::GameFileCache()
+    : m_path(QString::fromStdString(File::GetUserPath(D_CACHE_IDX)) +
+             QStringLiteral("qt_gamelist.cache"))
+{
+}
+
+void GameFileCache::Load()
+{
+  QFile file(m_path);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  QDataStream stream(&file);
+  stream.setVersion(DATASTREAM_VERSION);
+
+  qint32 version, count;
+  stream >> version >> count;
+  if (stream.status() != QDataStream::Ok || version != CACHE_VERSION || count < 0)
+    return;
+
+  m_games.clear();
+  m_games.reserve(count);
+  for (qint32 i = 0; i < count; ++i)
+  {
+    QSharedPointer<GameFile> game = GameFile::Deserialize(stream);
+    if (!game)
+    {
+      ERROR_LOG(COMMON, "Game list cache %s is corrupted", m_path.toStdString().c_str());
+      m_games.clear();
+      return;
+    }
+    m_games.insert(game->GetFilePath(), game);
+  }
+  m_dirty = false;
+}
+
+void GameFileCache::Save()
+{
+  if (!m_dirty)
+    return;
+
+  QSaveFile file(m_path);
+  if (!file.open(QIODevice::WriteOnly))
+    return;
+
+  QDataStream stream(&file);
+  stream.setVersion(DATASTREAM_VERSION);
+
+  stream << CACHE_VERSION << static_cast<qint32>(m_games.size());
+  for (const auto& game : m_games)
+    game->Serialize(stream);
+
+  // The old index stays in place if anything went wrong.
+  if (stream.status() == QDataStream::Ok && file.commit())
+    m_dirty = false;
+}
+
+QSharedPointer<GameFile> GameFileCache::Get(const QString& path) const
+{
+  return m_games.value(path);
+}
+
+QList<QSharedPointer<GameFile>> GameFileCache::GetGamesInDirectory(const QString& dir) const
+{
+  QList<QSharedPointer<GameFile>> games;
+  // Paths in the index are canonical.
+  QString prefix = QFileInfo(dir).canonicalFilePath();
+  if (prefix.isEmpty())
+    return games;
+  if (!prefix.endsWith(QLatin1Char('/')))
+    prefix += QLatin1Char('/');
+
+  for (const auto& game : m_games)
+  {
+    if (game->GetFilePath().startsWith(prefix))
+      games.append(game);
+  }
+  return games;
+}
+
+void GameFileCache::Update(const QSharedPointer<GameFile>& game)
+{
+  m_games.insert(game->GetFilePath(), game);
+  m_dirty = true;
+}
+
+void GameFileCache::Remove(const QString& path)
+{
+  if (m_games.remove(path) != 0)
+    m_dirty = true;
+}
+
+bool GameFileCache::IsUpToDate(const GameFile& game, const QFileInfo& info)
+{
+  return info.exists() && info.size() == game.GetFileSize() &&
+         info.lastModified() == game.GetLastModified();
+}
@@ -0,0 +1,40 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+#include "DolphinQt2/GameList/GameFile.h"
+
+class QFileInfo;
+
+// An index of the games which have been loaded, stored in the cache directory, so that the game
+// list can be filled without opening every file again. Games are keyed by their path, and are only
+// up to date as long as the size and the modification time of their file are the same.
+// This isn't thread safe; GameTracker only uses it from the GUI thread.
+class GameFileCache final
+{
+public:
+  GameFileCache();
+
+  void Load();
+  void Save();
+
+  // Returns null if the path isn't in the index.
+  QSharedPointer<GameFile> Get(const QString& path) const;
+  QList<QSharedPointer<GameFile>> GetGamesInDirectory(const QString& dir) const;
+  void Update(const QSharedPointer<GameFile>& game);
+  void Remove(const QString& path);
+
+  static bool IsUpToDate(const GameFile& game, const QFileInfo& info);
+
+private:
+  QString m_path;
+  QHash<QString, QSharedPointer<GameFile>> m_games;
+  bool m_dirty = false;
+};
@@ -143,10 +143,14 @@ void GameListModel::UpdateGame(QSharedPointer<GameFile> game)
   QString path = game->GetFilePath();
 
   int entry = FindGame(path);
-  if (entry < 0)
-    entry = m_games.size();
-  else
+  if (entry >= 0)
+  {
+    // GameTracker emits games from its cache first, and again if the file changed.
+    m_games[entry] = game;
+    emit dataChanged(index(entry, 0), index(entry, NUM_COLS - 1));
     return;
+  }
+  entry = m_games.size();
 
   beginInsertRows(QModelIndex(), entry, entry);
   m_games.insert(entry, game);
@@ -2,9 +2,15 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <utility>
+
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
+#include <QRunnable>
+#include <QThread>
+#include <QTimer>
 
 #include "DolphinQt2/GameList/GameTracker.h"
 #include "DolphinQt2/Settings.h"
@@ -14,28 +20,73 @@ static const QStringList game_filters{
     QStringLiteral("*.ciso"), QStringLiteral("*.gcz"), QStringLiteral("*.wbfs"),
     QStringLiteral("*.wad"),  QStringLiteral("*.elf"), QStringLiteral("*.dol")};
 
+// Scanning mostly waits for the storage, which can be a network share, so it's worth having more
+// threads than cores, but not so many that a slow disk gets swamped.
+static const int MIN_SCAN_THREADS = 2;
+static const int MAX_SCAN_THREADS = 8;
+
+namespace
+{
+// Checks a game in the cache against its file, and opens the file again if it changed.
+class GameScanner final : public QRunnable
+{
+public:
+  GameScanner(GameTracker* tracker, const QString& path, QSharedPointer<GameFile> cached)
+      : m_tracker(tracker), m_path(path), m_cached(std::move(cached))
+  {
+  }
+
+  void run() override
+  {
+    QSharedPointer<GameFile> game;
+    if (m_cached && GameFileCache::IsUpToDate(*m_cached, QFileInfo(m_path)))
+    {
+      // The file didn't change, but the game INIs might have.
+      QSharedPointer<GameFile> reloaded(new GameFile(*m_cached));
+      if (reloaded->ReloadState())
+        game = reloaded;
+    }
+    else
+    {
+      game = QSharedPointer<GameFile>(new GameFile(m_path));
+    }
+    emit m_tracker->GameScanned(m_path, game);
+  }
+
+private:
+  GameTracker* m_tracker;
+  QString m_path;
+  QSharedPointer<GameFile> m_cached;
+};
+}  // Anonymous namespace
+
 GameTracker::GameTracker(QObject* parent) : QFileSystemWatcher(parent)
 {
-  m_loader = new GameLoader;
-  m_loader->moveToThread(&m_loader_thread);
+  m_scan_pool.setMaxThreadCount(
+      std::min(std::max(QThread::idealThreadCount(), MIN_SCAN_THREADS), MAX_SCAN_THREADS));
 
   qRegisterMetaType<QSharedPointer<GameFile>>();
-  connect(&m_loader_thread, &QThread::finished, m_loader, &QObject::deleteLater);
   connect(this, &QFileSystemWatcher::directoryChanged, this, &GameTracker::UpdateDirectory);
   connect(this, &QFileSystemWatcher::fileChanged, this, &GameTracker::UpdateFile);
-  connect(this, &GameTracker::PathChanged, m_loader, &GameLoader::LoadGame);
-  connect(m_loader, &GameLoader::GameLoaded, this, &GameTracker::GameLoaded);
-
-  m_loader_thread.start();
-
-  for (QString dir : Settings::Instance().GetPaths())
-    AddDirectory(dir);
+  connect(this, &GameTracker::PathChanged, this, &GameTracker::LoadGame);
+  // Emitted from the pool, so this is queued.
+  connect(this, &GameTracker::GameScanned, this, &GameTracker::OnGameScanned);
+
+  m_cache.Load();
+
+  // Games from the cache are emitted as soon as their directory is added, so wait until whoever
+  // created us is listening.
+  QTimer::singleShot(0, this, [this] {
+    for (QString dir : Settings::Instance().GetPaths())
+      AddDirectory(dir);
+  });
 }
 
 GameTracker::~GameTracker()
 {
-  m_loader_thread.quit();
-  m_loader_thread.wait();
+  m_scan_pool.clear();
+  m_scan_pool.waitForDone();
+  m_cache.Save();
 }
 
 void GameTracker::AddDirectory(const QString& dir)
@@ -43,6 +94,20 @@ void GameTracker::AddDirectory(const QString& dir)
   if (!QFileInfo(dir).exists())
     return;
   addPath(dir);
+
+  // Show what the cache knows about right away, since walking a big directory on a network share
+  // takes a while. UpdateDirectory drops the games whose file is gone.
+  for (const auto& game : m_cache.GetGamesInDirectory(dir))
+  {
+    const QString path = game->GetFilePath();
+    if (m_tracked_files.contains(path))
+      continue;
+
+    addPath(path);
+    m_tracked_files[path] = QSet<QString>{dir};
+    emit PathChanged(path);
+  }
+
   UpdateDirectory(dir);
 }
 
@@ -60,6 +125,7 @@ void GameTracker::RemoveDirectory(const QString& dir)
       {
         removePath(path);
         m_tracked_files.remove(path);
+        m_cache.Remove(path);
         emit GameRemoved(path);
       }
     }
@@ -68,10 +134,12 @@ void GameTracker::RemoveDirectory(const QString& dir)
 
 void GameTracker::UpdateDirectory(const QString& dir)
 {
+  QSet<QString> found_files;
   QDirIterator it(dir, game_filters, QDir::NoFilter, QDirIterator::Subdirectories);
   while (it.hasNext())
   {
     QString path = QFileInfo(it.next()).canonicalFilePath();
+    found_files.insert(path);
 
     if (m_tracked_files.contains(path))
     {
@@ -87,7 +155,7 @@ void GameTracker::UpdateDirectory(const QString& dir)
     }
   }
 
-  for (const auto& missing : FindMissingFiles(dir))
+  for (const auto& missing : FindMissingFiles(dir, found_files))
   {
     auto& tracked_file = m_tracked_files[missing];
 
@@ -95,30 +163,22 @@ void GameTracker::UpdateDirectory(const QString& dir)
     if (tracked_file.empty())
     {
       m_tracked_files.remove(missing);
+      m_cache.Remove(missing);
       GameRemoved(missing);
     }
   }
 }
 
-QSet<QString> GameTracker::FindMissingFiles(const QString& dir)
+QSet<QString> GameTracker::FindMissingFiles(const QString& dir, const QSet<QString>& found_files)
 {
-  QDirIterator it(dir, game_filters, QDir::NoFilter, QDirIterator::Subdirectories);
-
   QSet<QString> missing_files;
 
   for (const auto& key : m_tracked_files.keys())
   {
-    if (m_tracked_files[key].contains(dir))
+    if (m_tracked_files[key].contains(dir) && !found_files.contains(key))
       missing_files.insert(key);
   }
 
-  while (it.hasNext())
-  {
-    QString path = QFileInfo(it.next()).canonicalFilePath();
-    if (m_tracked_files.contains(path))
-      missing_files.remove(path);
-  }
-
   return missing_files;
 }
 
@@ -127,6 +187,7 @@ void GameTracker::UpdateFile(const QString& file)
   if (QFileInfo(file).exists())
   {
     GameRemoved(file);
+    m_cache.Remove(file);
     addPath(file);
 
     emit PathChanged(file);
@@ -134,6 +195,41 @@ void GameTracker::UpdateFile(const QString& file)
   else if (removePath(file))
   {
     m_tracked_files.remove(file);
+    m_cache.Remove(file);
     emit GameRemoved(file);
   }
 }
+
+void GameTracker::LoadGame(const QString& path)
+{
+  QSharedPointer<GameFile> cached = m_cache.Get(path);
+  if (cached)
+    emit GameLoaded(cached);
+
+  ++m_pending_scans;
+  m_scan_pool.start(new GameScanner(this, path, cached));
+}
+
+void GameTracker::OnGameScanned(const QString& path, QSharedPointer<GameFile> game)
+{
+  --m_pending_scans;
+
+  // The game might have been removed while it was being scanned.
+  if (game && m_tracked_files.contains(path))
+  {
+    if (game->IsValid())
+    {
+      m_cache.Update(game);
+      emit GameLoaded(game);
+    }
+    else if (m_cache.Get(path))
+    {
+      m_cache.Remove(path);
+      emit GameRemoved(path);
+    }
+  }
+
+  // Write the cache once everything has been scanned rather than after every game.
+  if (m_pending_scans == 0)
+    m_cache.Save();
+}
@@ -10,17 +10,18 @@
 #include <QSharedPointer>
 #include <QString>
 #include <QStringList>
-#include <QThread>
+#include <QThreadPool>
 
 #include "DolphinQt2/GameList/GameFile.h"
+#include "DolphinQt2/GameList/GameFileCache.h"
 
-class GameLoader;
-
-// Watches directories and loads GameFiles in a separate thread.
+// Watches directories and loads GameFiles on a pool of threads.
 // To use this, just add directories using AddDirectory, and listen for the
-// GameLoaded and GameRemoved signals. Ignore the PathChanged signal, it's
-// only there because the Qt people made fileChanged and directoryChanged
-// private.
+// GameLoaded and GameRemoved signals. Ignore the PathChanged and GameScanned
+// signals, they're only there because the Qt people made fileChanged and
+// directoryChanged private, and to get results back from the pool.
+// Games which are in the GameFileCache are emitted right away, and are then
+// checked in the background, so GameLoaded can be emitted more than once for a path.
 class GameTracker final : public QFileSystemWatcher
 {
   Q_OBJECT
@@ -38,32 +39,21 @@ signals:
   void GameRemoved(const QString& path);
 
   void PathChanged(const QString& path);
+  // game is null if the game in the cache is still up to date.
+  void GameScanned(const QString& path, QSharedPointer<GameFile> game);
 
 private:
   void UpdateDirectory(const QString& dir);
   void UpdateFile(const QString& path);
-  QSet<QString> FindMissingFiles(const QString& dir);
+  void LoadGame(const QString& path);
+  void OnGameScanned(const QString& path, QSharedPointer<GameFile> game);
+  QSet<QString> FindMissingFiles(const QString& dir, const QSet<QString>& found_files);
 
   // game path -> directories that track it
   QMap<QString, QSet<QString>> m_tracked_files;
-  QThread m_loader_thread;
-  GameLoader* m_loader;
-};
-
-class GameLoader final : public QObject
-{
-  Q_OBJECT
-
-public slots:
-  void LoadGame(const QString& path)
-  {
-    GameFile* game = new GameFile(path);
-    if (game->IsValid())
-      emit GameLoaded(QSharedPointer<GameFile>(game));
-  }
-
-signals:
-  void GameLoaded(QSharedPointer<GameFile> game);
+  GameFileCache m_cache;
+  QThreadPool m_scan_pool;
+  int m_pending_scans = 0;
 };
 
 Q_DECLARE_METATYPE(QSharedPointer<GameFile>)
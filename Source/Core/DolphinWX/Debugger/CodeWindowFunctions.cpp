@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cinttypes>
 #include <cstddef>
 #include <cstdlib>
 #include <fstream>
@@ -39,6 +40,7 @@
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 #include "Core/PowerPC/SignatureDB/MEGASignatureDB.h"
 #include "Core/PowerPC/SignatureDB/SignatureDB.h"
 
@@ -160,6 +162,33 @@ void CCodeWindow::OnProfilerMenu(wxCommandEvent& event)
         wxExecute(OpenCommand, wxEXEC_SYNC);
     }
     break;
+  case IDM_SAMPLE_PROFILE:
+    if (GetParentMenuBar()->IsChecked(IDM_SAMPLE_PROFILE))
+    {
+      Profiler::ClearSamples();
+      Profiler::StartSampling();
+    }
+    else
+    {
+      Profiler::StopSampling();
+    }
+    break;
+  case IDM_WRITE_FOLDED_STACKS:
+  case IDM_WRITE_CHROME_TRACE:
+  {
+    const bool folded = event.GetId() == IDM_WRITE_FOLDED_STACKS;
+    const std::string filename =
+        File::GetUserPath(D_DUMP_IDX) + (folded ? "Debug/samples.folded" : "Debug/samples.json");
+    File::CreateFullPath(filename);
+    const bool written =
+        folded ? Profiler::WriteFoldedStacks(filename) : Profiler::WriteChromeTrace(filename);
+    if (written)
+    {
+      Parent->StatusBarMessage("Wrote %" PRIu64 " samples to %s", Profiler::GetSampleCount(),
+                               filename.c_str());
+    }
+    break;
+  }
   }
 }
 
@@ -457,7 +457,7 @@ void FifoPlayerDlg::OnBeginSearch(wxCommandEvent& event)
   int const frame_idx = m_framesList->GetSelection();
   FifoPlayer& player = FifoPlayer::GetInstance();
   const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-  const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+  const auto fifo_frame = player.GetFile()->GetFrame(frame_idx);
 
   // TODO: Support searching through the last object... How do we know were the cmd data ends?
   // TODO: Support searching for bit patterns
@@ -468,8 +468,8 @@ void FifoPlayerDlg::OnBeginSearch(wxCommandEvent& event)
     return;
   }
 
-  const u8* const start_ptr = &fifo_frame.fifoData[frame.objectStarts[obj_idx]];
-  const u8* const end_ptr = &fifo_frame.fifoData[frame.objectStarts[obj_idx + 1]];
+  const u8* const start_ptr = &fifo_frame->fifoData[frame.objectStarts[obj_idx]];
+  const u8* const end_ptr = &fifo_frame->fifoData[frame.objectStarts[obj_idx + 1]];
 
   for (const u8* ptr = start_ptr; ptr < end_ptr - val_length + 1; ++ptr)
   {
@@ -621,11 +621,11 @@ void FifoPlayerDlg::OnObjectListSelectionChanged(wxCommandEvent& event)
   if (frame_idx != -1 && object_idx != -1)
   {
     const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-    const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
-    const u8* objectdata_start = &fifo_frame.fifoData[frame.objectStarts[object_idx]];
-    const u8* objectdata_end = &fifo_frame.fifoData[frame.objectEnds[object_idx]];
+    const auto fifo_frame = player.GetFile()->GetFrame(frame_idx);
+    const u8* objectdata_start = &fifo_frame->fifoData[frame.objectStarts[object_idx]];
+    const u8* objectdata_end = &fifo_frame->fifoData[frame.objectEnds[object_idx]];
     u8* objectdata = (u8*)objectdata_start;
-    const int obj_offset = objectdata_start - &fifo_frame.fifoData[frame.objectStarts[0]];
+    const int obj_offset = objectdata_start - &fifo_frame->fifoData[frame.objectStarts[0]];
 
     int cmd = *objectdata++;
     int stream_size = Common::swap16(objectdata);
@@ -644,11 +644,11 @@ void FifoPlayerDlg::OnObjectListSelectionChanged(wxCommandEvent& event)
     // Between objectdata_end and next_objdata_start, there are register setting commands
     if (object_idx + 1 < (int)frame.objectStarts.size())
     {
-      const u8* next_objdata_start = &fifo_frame.fifoData[frame.objectStarts[object_idx + 1]];
+      const u8* next_objdata_start = &fifo_frame->fifoData[frame.objectStarts[object_idx + 1]];
       while (objectdata < next_objdata_start)
       {
         m_objectCmdOffsets.push_back(objectdata - objectdata_start);
-        int new_offset = objectdata - &fifo_frame.fifoData[frame.objectStarts[0]];
+        int new_offset = objectdata - &fifo_frame->fifoData[frame.objectStarts[0]];
         int command = *objectdata++;
         switch (command)
         {
@@ -758,9 +758,9 @@ void FifoPlayerDlg::OnObjectCmdListSelectionChanged(wxCommandEvent& event)
 
   FifoPlayer& player = FifoPlayer::GetInstance();
   const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-  const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+  const auto fifo_frame = player.GetFile()->GetFrame(frame_idx);
   const u8* cmddata =
-      &fifo_frame.fifoData[frame.objectStarts[object_idx]] + m_objectCmdOffsets[event.GetInt()];
+      &fifo_frame->fifoData[frame.objectStarts[object_idx]] + m_objectCmdOffsets[event.GetInt()];
 
   // TODO: Not sure whether we should bother translating the descriptions
   wxString newLabel;
@@ -908,10 +908,7 @@ wxString FifoPlayerDlg::CreateRecordingFifoSizeLabel() const
 
   if (file)
   {
-    size_t fifoBytes = 0;
-    for (size_t i = 0; i < file->GetFrameCount(); ++i)
-      fifoBytes += file->GetFrame(i).fifoData.size();
-
+    const size_t fifoBytes = static_cast<size_t>(file->GetAddedFifoDataSize());
     return wxString::Format(_("%zu FIFO bytes"), fifoBytes);
   }
 
@@ -924,14 +921,7 @@ wxString FifoPlayerDlg::CreateRecordingMemSizeLabel() const
 
   if (file)
   {
-    size_t memBytes = 0;
-    for (size_t frameNum = 0; frameNum < file->GetFrameCount(); ++frameNum)
-    {
-      const std::vector<MemoryUpdate>& memUpdates = file->GetFrame(frameNum).memoryUpdates;
-      for (const auto& memUpdate : memUpdates)
-        memBytes += memUpdate.data.size();
-    }
-
+    const size_t memBytes = static_cast<size_t>(file->GetAddedMemoryUpdateSize());
     return wxString::Format(_("%zu memory bytes"), memBytes);
   }
 
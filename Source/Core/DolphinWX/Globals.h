@@ -250,6 +250,9 @@ enum
 
   // Profiler
   IDM_PROFILE_BLOCKS,
+  IDM_SAMPLE_PROFILE,
+  IDM_WRITE_FOLDED_STACKS,
+  IDM_WRITE_CHROME_TRACE,
   IDM_WRITE_PROFILE,
   // --------------------------------------------------------------
 
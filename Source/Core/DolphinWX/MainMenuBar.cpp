@@ -507,6 +507,11 @@ wxMenu* MainMenuBar::CreateProfilerMenu() const
   profiler_menu->AppendCheckItem(IDM_PROFILE_BLOCKS, _("&Profile Blocks"));
   profiler_menu->AppendSeparator();
   profiler_menu->Append(IDM_WRITE_PROFILE, _("&Write to profile.txt, Show"));
+  profiler_menu->AppendSeparator();
+  // i18n: "Sample" is used as a verb, not a noun.
+  profiler_menu->AppendCheckItem(IDM_SAMPLE_PROFILE, _("&Sample Call Stacks"));
+  profiler_menu->Append(IDM_WRITE_FOLDED_STACKS, _("Write Samples as &Folded Stacks"));
+  profiler_menu->Append(IDM_WRITE_CHROME_TRACE, _("Write Samples as &Chrome Trace"));
 
   return profiler_menu;
 }
@@ -251,11 +251,15 @@ wxSizer* NetPlayDialog::CreateBottomGUI(wxWindow* parent)
     m_start_btn->Bind(wxEVT_BUTTON, &NetPlayDialog::OnStart, this);
 
     wxStaticText* buffer_lbl = new wxStaticText(parent, wxID_ANY, _("Buffer:"));
-    wxSpinCtrl* const padbuf_spin =
+    m_padbuf_spin =
         new wxSpinCtrl(parent, wxID_ANY, std::to_string(INITIAL_PAD_BUFFER_SIZE), wxDefaultPosition,
                        wxDefaultSize, wxSP_ARROW_KEYS, 0, 200, INITIAL_PAD_BUFFER_SIZE);
-    padbuf_spin->Bind(wxEVT_SPINCTRL, &NetPlayDialog::OnAdjustBuffer, this);
-    padbuf_spin->SetMinSize(WxUtils::GetTextWidgetMinSize(padbuf_spin));
+    m_padbuf_spin->Bind(wxEVT_SPINCTRL, &NetPlayDialog::OnAdjustBuffer, this);
+    m_padbuf_spin->SetMinSize(WxUtils::GetTextWidgetMinSize(m_padbuf_spin));
+
+    m_auto_buffer = new wxCheckBox(parent, wxID_ANY, _("Auto"));
+    m_auto_buffer->SetToolTip(_("Adjusts the buffer to the measured pings while the game runs."));
+    m_auto_buffer->Bind(wxEVT_CHECKBOX, &NetPlayDialog::OnAutoBuffer, this);
 
     m_memcard_write = new wxCheckBox(parent, wxID_ANY, _("Write save/SD data"));
 
@@ -263,7 +267,8 @@ wxSizer* NetPlayDialog::CreateBottomGUI(wxWindow* parent)
 
     bottom_szr->Add(m_start_btn, 0, wxALIGN_CENTER_VERTICAL);
     bottom_szr->Add(buffer_lbl, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
-    bottom_szr->Add(padbuf_spin, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
+    bottom_szr->Add(m_padbuf_spin, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
+    bottom_szr->Add(m_auto_buffer, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
     bottom_szr->Add(m_memcard_write, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
     bottom_szr->Add(m_copy_wii_save, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
     bottom_szr->AddSpacer(space5);
@@ -271,10 +276,17 @@ wxSizer* NetPlayDialog::CreateBottomGUI(wxWindow* parent)
 
   m_record_chkbox = new wxCheckBox(parent, wxID_ANY, _("Record inputs"));
 
+  m_rollback_chkbox = new wxCheckBox(parent, wxID_ANY, _("Rollback"));
+  m_rollback_chkbox->SetToolTip(
+      _("Predicts late inputs of other players instead of waiting for them, and goes back to fix "
+        "the game if a prediction was wrong. Only for GameCube games in single core mode, and "
+        "not while recording."));
+
   wxButton* quit_btn = new wxButton(parent, wxID_ANY, _("Quit Netplay"));
   quit_btn->Bind(wxEVT_BUTTON, &NetPlayDialog::OnQuit, this);
 
   bottom_szr->Add(m_record_chkbox, 0, wxALIGN_CENTER_VERTICAL);
+  bottom_szr->Add(m_rollback_chkbox, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
   bottom_szr->AddStretchSpacer();
   bottom_szr->Add(quit_btn);
   return bottom_szr;
@@ -424,6 +436,7 @@ void NetPlayDialog::OnMsgStartGame()
   }
 
   m_record_chkbox->Disable();
+  m_rollback_chkbox->Disable();
 }
 
 void NetPlayDialog::OnMsgStopGame()
@@ -439,6 +452,7 @@ void NetPlayDialog::OnMsgStopGame()
     m_player_config_btn->Enable();
   }
   m_record_chkbox->Enable();
+  m_rollback_chkbox->Enable();
 }
 
 void NetPlayDialog::OnAdjustBuffer(wxCommandEvent& event)
@@ -447,6 +461,11 @@ void NetPlayDialog::OnAdjustBuffer(wxCommandEvent& event)
   netplay_server->AdjustPadBufferSize(val);
 }
 
+void NetPlayDialog::OnAutoBuffer(wxCommandEvent& event)
+{
+  netplay_server->SetAutoPadBuffer(event.IsChecked());
+}
+
 void NetPlayDialog::OnPadBufferChanged(u32 buffer)
 {
   m_pad_buffer = buffer;
@@ -592,6 +611,10 @@ void NetPlayDialog::OnThread(wxThreadEvent& event)
   {
     std::string msg = StringFromFormat("Pad buffer: %d", m_pad_buffer);
 
+    // The server may have picked the size on its own.
+    if (m_is_hosting)
+      m_padbuf_spin->SetValue(m_pad_buffer);
+
     if (g_ActiveConfig.bShowNetPlayMessages)
     {
       OSD::AddTypedMessage(OSD::MessageType::NetPlayBuffer, msg, OSD::Duration::NORMAL);
@@ -746,6 +769,11 @@ bool NetPlayDialog::IsRecording()
   return m_record_chkbox->GetValue();
 }
 
+bool NetPlayDialog::IsRollbackEnabled()
+{
+  return m_rollback_chkbox->GetValue();
+}
+
 void NetPlayDialog::OnCopyIP(wxCommandEvent&)
 {
   if (m_host_copy_btn_is_retry)
@@ -32,6 +32,7 @@ class wxCheckBox;
 class wxChoice;
 class wxListBox;
 class wxSizer;
+class wxSpinCtrl;
 class wxStaticText;
 class wxString;
 class wxTextCtrl;
@@ -110,6 +111,7 @@ public:
   static void FillWithGameNames(wxListBox* game_lbox, const GameListCtrl& game_list);
 
   bool IsRecording() override;
+  bool IsRollbackEnabled() override;
 
 private:
   void CreateGUI();
@@ -125,6 +127,7 @@ private:
   void OnChangeGame(wxCommandEvent& event);
   void OnMD5ComputeRequested(wxCommandEvent& event);
   void OnAdjustBuffer(wxCommandEvent& event);
+  void OnAutoBuffer(wxCommandEvent& event);
   void OnAssignPads(wxCommandEvent& event);
   void OnKick(wxCommandEvent& event);
   void OnPlayerSelect(wxCommandEvent& event);
@@ -143,6 +146,9 @@ private:
   wxCheckBox* m_memcard_write;
   wxCheckBox* m_copy_wii_save;
   wxCheckBox* m_record_chkbox;
+  wxCheckBox* m_rollback_chkbox;
+  wxSpinCtrl* m_padbuf_spin;
+  wxCheckBox* m_auto_buffer;
 
   std::string m_selected_game;
   wxButton* m_player_config_btn;
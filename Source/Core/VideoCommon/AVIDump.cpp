@@ -6,13 +6,22 @@
 #define __STDC_CONSTANT_MACROS 1
 #endif
 
+#include <algorithm>
+#include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/mathematics.h>
+#include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 }
 
@@ -20,6 +29,8 @@ extern "C" {
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/SystemTimers.h"
@@ -35,13 +46,222 @@ extern "C" {
 #define av_frame_free avcodec_free_frame
 #endif
 
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 8, 0)
+#define av_packet_unref av_free_packet
+#endif
+
+namespace
+{
+// Converts frames to the pixel format of the encoder in horizontal bands, one per thread. Frames
+// are never scaled, so the bands can be converted separately. Each band is converted with a few
+// rows of its neighbours so that the chroma filters see the same rows as they would for the whole
+// frame, and then only its own rows are kept.
+class FrameConverter final
+{
+public:
+  ~FrameConverter() { Shutdown(); }
+
+  bool Init(int width, int height, AVPixelFormat src_format, AVPixelFormat dst_format,
+            int threads)
+  {
+    Shutdown();
+    m_width = width;
+    m_dst_format = dst_format;
+    m_dst_desc = av_pix_fmt_desc_get(dst_format);
+
+    const int band_count = std::max(1, std::min(threads, height / MIN_BAND_HEIGHT));
+    const int band_height = height / band_count / BAND_ALIGNMENT * BAND_ALIGNMENT;
+    for (int i = 0; i < band_count; ++i)
+    {
+      Band band;
+      band.y = i * band_height;
+      band.height = i == band_count - 1 ? height - band.y : band_height;
+      // A single band is converted straight into the frame.
+      band.input_y = band_count == 1 ? 0 : std::max(0, band.y - BAND_MARGIN);
+      band.input_height = band_count == 1 ?
+                              height :
+                              std::min(height, band.y + band.height + BAND_MARGIN) - band.input_y;
+      band.context = sws_getContext(width, band.input_height, src_format, width,
+                                    band.input_height, dst_format, SWS_BICUBIC, nullptr, nullptr,
+                                    nullptr);
+      m_bands.push_back(band);
+
+      Band& added = m_bands.back();
+      const bool allocated = band_count == 1 || av_image_alloc(added.data, added.linesize, width,
+                                                               added.input_height, dst_format,
+                                                               32) >= 0;
+      if (!added.context || !allocated)
+      {
+        Shutdown();
+        return false;
+      }
+    }
+
+    for (size_t i = 1; i < m_bands.size(); ++i)
+      m_workers.emplace_back(&FrameConverter::WorkerLoop, this, i, m_generation);
+    return true;
+  }
+
+  void Shutdown()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_lock);
+      m_quit = true;
+    }
+    m_work_available.notify_all();
+    for (std::thread& worker : m_workers)
+      worker.join();
+    m_workers.clear();
+    m_quit = false;
+
+    for (Band& band : m_bands)
+    {
+      sws_freeContext(band.context);
+      av_freep(&band.data[0]);
+    }
+    m_bands.clear();
+  }
+
+  // dst must have the size and the pixel format which were given to Init.
+  void Convert(const u8* src, int src_stride, AVFrame* dst)
+  {
+    if (m_bands.empty())
+      return;
+
+    {
+      std::lock_guard<std::mutex> lk(m_lock);
+      m_src = src;
+      m_src_stride = src_stride;
+      m_dst = dst;
+      m_bands_left = m_bands.size() - 1;
+      ++m_generation;
+    }
+    m_work_available.notify_all();
+
+    ConvertBand(m_bands[0]);
+
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_work_done.wait(lk, [this] { return m_bands_left == 0; });
+  }
+
+private:
+  static constexpr int MIN_BAND_HEIGHT = 64;
+  // Keeps the chroma rows and the dithering of the bands lined up with the whole frame.
+  static constexpr int BAND_ALIGNMENT = 16;
+  static constexpr int BAND_MARGIN = 16;
+
+  struct Band
+  {
+    SwsContext* context = nullptr;
+    int y = 0;
+    int height = 0;
+    int input_y = 0;
+    int input_height = 0;
+    // Where the band is converted to, if there is more than one.
+    u8* data[4] = {};
+    int linesize[4] = {};
+  };
+
+  int PlaneRow(int plane, int y) const
+  {
+    return plane == 1 || plane == 2 ? y >> m_dst_desc->log2_chroma_h : y;
+  }
+
+  void ConvertBand(const Band& band)
+  {
+    const u8* const src[4] = {m_src + static_cast<ptrdiff_t>(band.input_y) * m_src_stride};
+    const int src_stride[4] = {m_src_stride};
+
+    if (m_bands.size() == 1)
+    {
+      sws_scale(band.context, src, src_stride, 0, band.input_height, m_dst->data, m_dst->linesize);
+      return;
+    }
+
+    sws_scale(band.context, src, src_stride, 0, band.input_height, band.data, band.linesize);
+
+    // Only keep the rows which belong to this band.
+    const int margin_rows = band.y - band.input_y;
+    const u8* band_rows[4] = {};
+    u8* dst_rows[4] = {};
+    for (int plane = 0; plane < 4 && band.data[plane]; ++plane)
+    {
+      band_rows[plane] = band.data[plane] + PlaneRow(plane, margin_rows) * band.linesize[plane];
+      dst_rows[plane] = m_dst->data[plane] + PlaneRow(plane, band.y) * m_dst->linesize[plane];
+    }
+    av_image_copy(dst_rows, m_dst->linesize, band_rows, band.linesize, m_dst_format, m_width,
+                  band.height);
+  }
+
+  void WorkerLoop(size_t index, u64 generation)
+  {
+    Common::SetCurrentThreadName("FrameDumpConvert");
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lk(m_lock);
+        m_work_available.wait(lk, [&] { return m_quit || m_generation != generation; });
+        if (m_quit)
+          return;
+        generation = m_generation;
+      }
+
+      ConvertBand(m_bands[index]);
+
+      std::lock_guard<std::mutex> lk(m_lock);
+      if (--m_bands_left == 0)
+        m_work_done.notify_one();
+    }
+  }
+
+  int m_width = 0;
+  AVPixelFormat m_dst_format = AV_PIX_FMT_NONE;
+  const AVPixFmtDescriptor* m_dst_desc = nullptr;
+  std::vector<Band> m_bands;
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_lock;
+  std::condition_variable m_work_available;
+  std::condition_variable m_work_done;
+  u64 m_generation = 0;
+  size_t m_bands_left = 0;
+  bool m_quit = false;
+  const u8* m_src = nullptr;
+  int m_src_stride = 0;
+  AVFrame* m_dst = nullptr;
+};
+
+// Encoded packets are written to the file on their own thread, so that the encoder doesn't wait
+// for the disk.
+struct QueuedPacket
+{
+  std::vector<u8> data;
+  s64 pts;
+  s64 dts;
+  s64 duration;
+  int flags;
+};
+}  // Anonymous namespace
+
+// Lossless codecs make big packets, so don't let them pile up without limit.
+static const size_t MAX_QUEUED_PACKETS = 64;
+
 static AVFormatContext* s_format_context = nullptr;
 static AVStream* s_stream = nullptr;
 static AVCodecContext* s_codec_context = nullptr;
-static AVFrame* s_src_frame = nullptr;
 static AVFrame* s_scaled_frame = nullptr;
 static AVPixelFormat s_pix_fmt = AV_PIX_FMT_BGR24;
-static SwsContext* s_sws_context = nullptr;
+static FrameConverter s_converter;
+static std::thread s_mux_thread;
+static std::mutex s_mux_lock;
+static std::condition_variable s_mux_queue_changed;
+static std::deque<QueuedPacket> s_mux_queue;
+static bool s_mux_quit = false;
+// Per-stage timing, in microseconds. The muxing time is only touched by the muxing thread.
+static u64 s_frame_count = 0;
+static u64 s_convert_us = 0;
+static u64 s_encode_us = 0;
+static u64 s_mux_us = 0;
 static int s_width;
 static int s_height;
 static u64 s_last_frame;
@@ -63,6 +283,66 @@ static void InitAVCodec()
   }
 }
 
+static int GetThreadCount()
+{
+  if (g_Config.iFrameDumpThreads > 0)
+    return g_Config.iFrameDumpThreads;
+  return static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+}
+
+static void MuxPackets()
+{
+  Common::SetCurrentThreadName("FrameDumpMux");
+
+  while (true)
+  {
+    QueuedPacket queued;
+    {
+      std::unique_lock<std::mutex> lk(s_mux_lock);
+      s_mux_queue_changed.wait(lk, [] { return !s_mux_queue.empty() || s_mux_quit; });
+      if (s_mux_queue.empty())
+        return;
+      queued = std::move(s_mux_queue.front());
+      s_mux_queue.pop_front();
+    }
+    s_mux_queue_changed.notify_all();
+
+    const u64 mux_start = Common::Timer::GetTimeUs();
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    // Not reference counted, so libavformat makes its own copy if it needs to keep the data.
+    pkt.data = queued.data.data();
+    pkt.size = static_cast<int>(queued.data.size());
+    pkt.pts = queued.pts;
+    pkt.dts = queued.dts;
+    pkt.duration = queued.duration;
+    pkt.flags = queued.flags;
+    pkt.stream_index = s_stream->index;
+    av_interleaved_write_frame(s_format_context, &pkt);
+    s_mux_us += Common::Timer::GetTimeUs() - mux_start;
+  }
+}
+
+static void StartMuxThread()
+{
+  s_mux_quit = false;
+  s_mux_thread = std::thread(MuxPackets);
+}
+
+// Writes the packets which are still queued before returning.
+static void StopMuxThread()
+{
+  if (!s_mux_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lk(s_mux_lock);
+    s_mux_quit = true;
+  }
+  s_mux_queue_changed.notify_all();
+  s_mux_thread.join();
+}
+
 static bool AVStreamCopyContext(AVStream* stream, AVCodecContext* codec_context)
 {
 #if (LIBAVCODEC_VERSION_MICRO >= 100 && LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 33, 100)) ||  \
@@ -85,6 +365,11 @@ bool AVIDump::Start(int w, int h)
   s_last_frame_is_valid = false;
   s_last_pts = 0;
 
+  s_frame_count = 0;
+  s_convert_us = 0;
+  s_encode_us = 0;
+  s_mux_us = 0;
+
   InitAVCodec();
   bool success = CreateVideoFile();
   if (!success)
@@ -179,6 +464,8 @@ bool AVIDump::CreateVideoFile()
   s_codec_context->time_base.den = VideoInterface::GetTargetRefreshRate();
   s_codec_context->gop_size = 12;
   s_codec_context->pix_fmt = g_Config.bUseFFV1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
+  // libavcodec picks frame or slice threading, whichever the encoder supports.
+  s_codec_context->thread_count = GetThreadCount();
 
   if (output_format->flags & AVFMT_GLOBALHEADER)
     s_codec_context->flags |= CODEC_FLAG_GLOBAL_HEADER;
@@ -189,7 +476,6 @@ bool AVIDump::CreateVideoFile()
     return false;
   }
 
-  s_src_frame = av_frame_alloc();
   s_scaled_frame = av_frame_alloc();
 
   s_scaled_frame->format = s_codec_context->pix_fmt;
@@ -204,6 +490,12 @@ bool AVIDump::CreateVideoFile()
     return false;
 #endif
 
+  if (!s_converter.Init(s_width, s_height, s_pix_fmt, s_codec_context->pix_fmt, GetThreadCount()))
+  {
+    ERROR_LOG(VIDEO, "Could not create the pixel format converter");
+    return false;
+  }
+
   s_stream = avformat_new_stream(s_format_context, codec);
   if (!s_stream || !AVStreamCopyContext(s_stream, s_codec_context))
   {
@@ -219,6 +511,8 @@ bool AVIDump::CreateVideoFile()
     return false;
   }
 
+  StartMuxThread();
+
   OSD::AddMessage(StringFromFormat("Dumping Frames to \"%s\" (%dx%d)", s_format_context->filename,
                                    s_width, s_height));
 
@@ -278,8 +572,17 @@ static void WritePacket(AVPacket& pkt)
   if (s_codec_context->coded_frame->key_frame)
     pkt.flags |= AV_PKT_FLAG_KEY;
 #endif
-  pkt.stream_index = s_stream->index;
-  av_interleaved_write_frame(s_format_context, &pkt);
+
+  QueuedPacket queued{std::vector<u8>(pkt.data, pkt.data + pkt.size), pkt.pts, pkt.dts,
+                      pkt.duration, pkt.flags};
+  av_packet_unref(&pkt);
+
+  {
+    std::unique_lock<std::mutex> lk(s_mux_lock);
+    s_mux_queue_changed.wait(lk, [] { return s_mux_queue.size() < MAX_QUEUED_PACKETS; });
+    s_mux_queue.push_back(std::move(queued));
+  }
+  s_mux_queue_changed.notify_all();
 }
 
 void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const Frame& state)
@@ -293,21 +596,16 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
   }
 
   CheckResolution(width, height);
-  s_src_frame->data[0] = const_cast<u8*>(data);
-  s_src_frame->linesize[0] = stride;
-  s_src_frame->format = s_pix_fmt;
-  s_src_frame->width = s_width;
-  s_src_frame->height = s_height;
 
-  // Convert image from {BGR24, RGBA} to desired pixel format
-  s_sws_context =
-      sws_getCachedContext(s_sws_context, width, height, s_pix_fmt, s_width, s_height,
-                           s_codec_context->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr);
-  if (s_sws_context)
+  // Convert image from {BGR24, RGBA} to desired pixel format. The resolution only differs when the
+  // frame is empty, in which case the last frame is encoded again.
+  if (width == s_width && height == s_height)
   {
-    sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0, height,
-              s_scaled_frame->data, s_scaled_frame->linesize);
+    const u64 convert_start = Common::Timer::GetTimeUs();
+    s_converter.Convert(data, stride, s_scaled_frame);
+    s_convert_us += Common::Timer::GetTimeUs() - convert_start;
   }
+  s_frame_count++;
 
   // Encode and write the image.
   AVPacket pkt;
@@ -341,7 +639,9 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
   {
     s_last_frame = state.ticks;
     s_last_pts = pts_in_ticks;
+    const u64 encode_start = Common::Timer::GetTimeUs();
     error = SendFrameAndReceivePacket(s_codec_context, &pkt, s_scaled_frame, &got_packet);
+    s_encode_us += Common::Timer::GetTimeUs() - encode_start;
   }
   if (!error && got_packet)
   {
@@ -376,7 +676,16 @@ static void HandleDelayedPackets()
 void AVIDump::Stop()
 {
   HandleDelayedPackets();
+  StopMuxThread();
   av_write_trailer(s_format_context);
+  if (s_frame_count != 0)
+  {
+    NOTICE_LOG(VIDEO,
+               "Frame dump timing per frame: converting %" PRIu64 " us, encoding %" PRIu64
+               " us, writing %" PRIu64 " us",
+               s_convert_us / s_frame_count, s_encode_us / s_frame_count,
+               s_mux_us / s_frame_count);
+  }
   CloseVideoFile();
   s_file_index = 0;
   NOTICE_LOG(VIDEO, "Stopping frame dump");
@@ -385,7 +694,8 @@ void AVIDump::Stop()
 
 void AVIDump::CloseVideoFile()
 {
-  av_frame_free(&s_src_frame);
+  StopMuxThread();
+  s_converter.Shutdown();
   av_frame_free(&s_scaled_frame);
 
   avcodec_free_context(&s_codec_context);
@@ -396,12 +706,6 @@ void AVIDump::CloseVideoFile()
   }
   avformat_free_context(s_format_context);
   s_format_context = nullptr;
-
-  if (s_sws_context)
-  {
-    sws_freeContext(s_sws_context);
-    s_sws_context = nullptr;
-  }
 }
 
 void AVIDump::DoState()
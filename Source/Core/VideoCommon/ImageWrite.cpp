@@ -2,14 +2,20 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <list>
 #include <string>
+#include <utility>
 #include <vector>
+#include <zlib.h>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/Thread.h"
 #include "VideoCommon/ImageWrite.h"
 #include "png.h"
 
@@ -35,7 +41,7 @@ data      : This is an array of RGBA with 8 bits per channel. 4 bytes for each p
 row_stride: Determines the amount of bytes per row of pixels.
 */
 bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
-                  int height, bool saveAlpha)
+                  int height, bool saveAlpha, int compression_level, bool fast_filter)
 {
   if (!data)
     return false;
@@ -90,6 +96,14 @@ bool TextureToPng(const u8* data, int row_stride, const std::string& filename, i
 
   png_init_io(png_ptr, fp.GetHandle());
 
+  if (compression_level >= 0)
+    png_set_compression_level(png_ptr, compression_level);
+  if (fast_filter)
+  {
+    png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+    png_set_compression_strategy(png_ptr, Z_RLE);
+  }
+
   // Write header (8 bit color depth)
   png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
                PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
@@ -144,3 +158,205 @@ finalise:
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
+
+namespace
+{
+struct QoiPixel
+{
+  u8 r, g, b, a;
+
+  bool operator==(const QoiPixel& other) const
+  {
+    return r == other.r && g == other.g && b == other.b && a == other.a;
+  }
+};
+
+void AppendBigEndian32(std::vector<u8>* out, u32 value)
+{
+  out->push_back(static_cast<u8>(value >> 24));
+  out->push_back(static_cast<u8>(value >> 16));
+  out->push_back(static_cast<u8>(value >> 8));
+  out->push_back(static_cast<u8>(value));
+}
+}  // Anonymous namespace
+
+std::vector<u8> EncodeQoi(const u8* data, int row_stride, int width, int height, bool saveAlpha)
+{
+  enum : u8
+  {
+    QOI_OP_INDEX = 0x00,
+    QOI_OP_DIFF = 0x40,
+    QOI_OP_LUMA = 0x80,
+    QOI_OP_RUN = 0xc0,
+    QOI_OP_RGB = 0xfe,
+    QOI_OP_RGBA = 0xff,
+  };
+  constexpr int MAX_RUN = 62;
+
+  std::vector<u8> out;
+  // Most frames compress well, so don't reserve for the worst case of 5 bytes per pixel.
+  out.reserve(static_cast<size_t>(width) * height * 2 + 22);
+
+  out.insert(out.end(), {'q', 'o', 'i', 'f'});
+  AppendBigEndian32(&out, static_cast<u32>(width));
+  AppendBigEndian32(&out, static_cast<u32>(height));
+  out.push_back(saveAlpha ? 4 : 3);
+  // sRGB with linear alpha
+  out.push_back(0);
+
+  std::array<QoiPixel, 64> index{};
+  QoiPixel previous{0, 0, 0, 255};
+  int run = 0;
+
+  for (int y = 0; y < height; ++y)
+  {
+    const u8* row = data + static_cast<ptrdiff_t>(y) * row_stride;
+    for (int x = 0; x < width; ++x)
+    {
+      const QoiPixel pixel{row[x * 4], row[x * 4 + 1], row[x * 4 + 2],
+                           saveAlpha ? row[x * 4 + 3] : static_cast<u8>(255)};
+
+      if (pixel == previous)
+      {
+        if (++run == MAX_RUN)
+        {
+          out.push_back(QOI_OP_RUN | (run - 1));
+          run = 0;
+        }
+        continue;
+      }
+
+      if (run != 0)
+      {
+        out.push_back(QOI_OP_RUN | (run - 1));
+        run = 0;
+      }
+
+      const u8 index_position =
+          (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+      if (index[index_position] == pixel)
+      {
+        out.push_back(QOI_OP_INDEX | index_position);
+      }
+      else if (pixel.a != previous.a)
+      {
+        out.insert(out.end(), {QOI_OP_RGBA, pixel.r, pixel.g, pixel.b, pixel.a});
+      }
+      else
+      {
+        const s8 dr = static_cast<s8>(pixel.r - previous.r);
+        const s8 dg = static_cast<s8>(pixel.g - previous.g);
+        const s8 db = static_cast<s8>(pixel.b - previous.b);
+        const int dr_dg = dr - dg;
+        const int db_dg = db - dg;
+
+        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+        {
+          out.push_back(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+        }
+        else if (dr_dg >= -8 && dr_dg <= 7 && dg >= -32 && dg <= 31 && db_dg >= -8 && db_dg <= 7)
+        {
+          out.push_back(QOI_OP_LUMA | (dg + 32));
+          out.push_back(static_cast<u8>((dr_dg + 8) << 4 | (db_dg + 8)));
+        }
+        else
+        {
+          out.insert(out.end(), {QOI_OP_RGB, pixel.r, pixel.g, pixel.b});
+        }
+      }
+
+      index[index_position] = pixel;
+      previous = pixel;
+    }
+  }
+
+  if (run != 0)
+    out.push_back(QOI_OP_RUN | (run - 1));
+
+  out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+  return out;
+}
+
+bool TextureToQoi(const u8* data, int row_stride, const std::string& filename, int width,
+                  int height, bool saveAlpha)
+{
+  if (!data)
+    return false;
+
+  const std::vector<u8> encoded = EncodeQoi(data, row_stride, width, height, saveAlpha);
+  File::IOFile fp(filename, "wb");
+  if (!fp.WriteBytes(encoded.data(), encoded.size()))
+  {
+    PanicAlertT("Screenshot failed: Could not write file \"%s\" (error %d)", filename.c_str(),
+                errno);
+    return false;
+  }
+  return true;
+}
+
+ImageWriter::ImageWriter(int threads, int png_compression_level, bool png_fast_filter)
+    : m_png_compression_level(png_compression_level), m_png_fast_filter(png_fast_filter)
+{
+  if (threads <= 0)
+    threads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+  m_max_queued_images = static_cast<size_t>(threads) * 2;
+
+  for (int i = 0; i < threads; ++i)
+    m_workers.emplace_back(&ImageWriter::WorkerLoop, this);
+}
+
+ImageWriter::~ImageWriter()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_lock);
+    m_quit = true;
+  }
+  m_queue_changed.notify_all();
+  for (std::thread& worker : m_workers)
+    worker.join();
+}
+
+void ImageWriter::Write(Image image)
+{
+  {
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_queue_changed.wait(lk, [this] { return m_queue.size() < m_max_queued_images; });
+    m_queue.push_back(std::move(image));
+  }
+  m_queue_changed.notify_all();
+}
+
+void ImageWriter::WorkerLoop()
+{
+  Common::SetCurrentThreadName("ImageWriter");
+
+  while (true)
+  {
+    Image image;
+    {
+      std::unique_lock<std::mutex> lk(m_lock);
+      m_queue_changed.wait(lk, [this] { return !m_queue.empty() || m_quit; });
+      if (m_queue.empty())
+        return;
+      image = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+    m_queue_changed.notify_all();
+
+    bool written;
+    if (image.format == ImageFormat::QOI)
+    {
+      written = TextureToQoi(image.data.data(), image.row_stride, image.filename, image.width,
+                             image.height, image.save_alpha);
+    }
+    else
+    {
+      written = TextureToPng(image.data.data(), image.row_stride, image.filename, image.width,
+                             image.height, image.save_alpha, m_png_compression_level,
+                             m_png_fast_filter);
+    }
+
+    if (image.on_written)
+      image.on_written(written);
+  }
+}
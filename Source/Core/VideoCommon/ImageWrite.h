@@ -4,9 +4,77 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 
 bool SaveData(const std::string& filename, const std::string& data);
+// compression_level is a zlib level from 0 to 9, or -1 for zlib's default. The fast filter only
+// uses one PNG filter and compresses runs, which is a lot faster but makes slightly bigger files.
 bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
+                  int height, bool saveAlpha = true, int compression_level = -1,
+                  bool fast_filter = false);
+
+// The Quite OK Image format (https://qoiformat.org/): lossless like PNG, bigger, but many times
+// faster to write.
+std::vector<u8> EncodeQoi(const u8* data, int row_stride, int width, int height,
+                          bool saveAlpha = true);
+bool TextureToQoi(const u8* data, int row_stride, const std::string& filename, int width,
                   int height, bool saveAlpha = true);
+
+enum class ImageFormat
+{
+  PNG,
+  QOI,
+};
+
+// Writes images on a pool of threads, so that frame dumps and screenshots don't have to wait for
+// them to be encoded. Images aren't necessarily written in the order they were queued in.
+class ImageWriter final
+{
+public:
+  struct Image
+  {
+    // RGBA8
+    std::vector<u8> data;
+    int width;
+    int height;
+    int row_stride;
+    bool save_alpha;
+    std::string filename;
+    ImageFormat format;
+    // Called on the writing thread, with whether the image could be written.
+    std::function<void(bool)> on_written;
+  };
+
+  // 0 threads means one per core. The PNG options are the ones of TextureToPng.
+  ImageWriter(int threads, int png_compression_level, bool png_fast_filter);
+  // Writes the images which are still queued first.
+  ~ImageWriter();
+
+  ImageWriter(const ImageWriter&) = delete;
+  ImageWriter& operator=(const ImageWriter&) = delete;
+
+  // Waits if a couple of images per thread are already queued.
+  void Write(Image image);
+
+private:
+  void WorkerLoop();
+
+  int m_png_compression_level;
+  bool m_png_fast_filter;
+  size_t m_max_queued_images;
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_lock;
+  std::condition_variable m_queue_changed;
+  std::deque<Image> m_queue;
+  bool m_quit = false;
+};
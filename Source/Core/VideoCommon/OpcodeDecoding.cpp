@@ -25,6 +25,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/PhaseTimer.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoCommon.h"
@@ -83,6 +84,7 @@ void Init()
 template <bool is_preprocess>
 u8* Run(DataReader src, u32* cycles, bool in_display_list)
 {
+  PhaseTimer::ScopedPhase phase(PhaseTimer::Phase::OpcodeDecode);
   u32 totalCycles = 0;
   u8* opcodeStart;
   while (true)
@@ -0,0 +1,78 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/PhaseTimer.h"
+
+#include <chrono>
+
+namespace PhaseTimer
+{
+std::atomic<bool> g_enabled{false};
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Phases are added up on the thread running the GPU, and read from the CPU thread once the GPU
+// is idle.
+std::array<std::atomic<u64>, NUM_PHASES> s_totals;
+
+// The innermost phase of the current thread and when it was last entered or resumed.
+thread_local Phase s_current = Phase::Count;
+thread_local Clock::time_point s_current_start;
+
+void StopCurrent(Clock::time_point now)
+{
+  if (s_current == Phase::Count)
+    return;
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - s_current_start);
+  s_totals[static_cast<size_t>(s_current)].fetch_add(elapsed.count(), std::memory_order_relaxed);
+}
+}  // Anonymous namespace
+
+const char* GetPhaseName(Phase phase)
+{
+  static const char* const names[NUM_PHASES] = {
+      "opcode_decode", "vertex_loading", "texture_decode", "backend_submit",
+  };
+  return names[static_cast<size_t>(phase)];
+}
+
+void SetEnabled(bool enabled)
+{
+  if (enabled)
+  {
+    for (auto& total : s_totals)
+      total.store(0, std::memory_order_relaxed);
+  }
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Totals GetTotals()
+{
+  Totals totals;
+  for (size_t i = 0; i < NUM_PHASES; ++i)
+    totals[i] = s_totals[i].load(std::memory_order_relaxed);
+  return totals;
+}
+
+void ScopedPhase::Enter(Phase phase)
+{
+  const Clock::time_point now = Clock::now();
+  StopCurrent(now);
+  m_parent = s_current;
+  m_active = true;
+  s_current = phase;
+  s_current_start = now;
+}
+
+void ScopedPhase::Leave()
+{
+  const Clock::time_point now = Clock::now();
+  StopCurrent(now);
+  s_current = m_parent;
+  s_current_start = now;
+}
+}
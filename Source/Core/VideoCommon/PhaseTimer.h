@@ -0,0 +1,63 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Splits the time the GPU emulation spends into a few broad phases, for benchmarking. Phases nest:
+// time spent in an inner phase is not counted towards the outer one.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+namespace PhaseTimer
+{
+enum class Phase
+{
+  OpcodeDecode,   // Reading the FIFO and handling register loads and display lists
+  VertexLoading,  // Converting vertices to the native format
+  TextureDecode,  // Looking up, decoding and uploading textures
+  BackendSubmit,  // Flushing draws to the backend
+  Count
+};
+
+constexpr size_t NUM_PHASES = static_cast<size_t>(Phase::Count);
+
+// Nanoseconds spent in each phase since the timer was enabled.
+using Totals = std::array<u64, NUM_PHASES>;
+
+const char* GetPhaseName(Phase phase);
+
+void SetEnabled(bool enabled);
+Totals GetTotals();
+
+extern std::atomic<bool> g_enabled;
+
+class ScopedPhase final
+{
+public:
+  explicit ScopedPhase(Phase phase)
+  {
+    if (g_enabled.load(std::memory_order_relaxed))
+      Enter(phase);
+  }
+  ~ScopedPhase()
+  {
+    if (m_active)
+      Leave();
+  }
+
+  ScopedPhase(const ScopedPhase&) = delete;
+  ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+  void Enter(Phase phase);
+  void Leave();
+
+  Phase m_parent = Phase::Count;
+  bool m_active = false;
+};
+}
@@ -14,8 +14,10 @@
 
 #include "VideoCommon/RenderBase.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -729,7 +731,8 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
   }
 
   // TODO: merge more generic parts into VideoCommon
-  SwapImpl(xfbAddr, fbWidth, fbStride, fbHeight, rc, ticks, Gamma);
+  if (!m_output_suppressed.IsSet())
+    SwapImpl(xfbAddr, fbWidth, fbStride, fbHeight, rc, ticks, Gamma);
 
   if (m_xfb_written)
     m_fps_counter.Update();
@@ -747,6 +750,11 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
   m_xfb_written = false;
 }
 
+void Renderer::SetOutputSuppressed(bool suppressed)
+{
+  m_output_suppressed.Set(suppressed);
+}
+
 bool Renderer::IsFrameDumping()
 {
   if (m_screenshot_request.IsSet())
@@ -799,21 +807,29 @@ void Renderer::FinishFrameData()
   m_frame_dump_frame_running = false;
 }
 
+static void CopyFrameData(const u8* data, int width, int height, int stride,
+                          std::vector<u8>* buffer)
+{
+  const size_t row_size = static_cast<size_t>(width) * 4;
+  buffer->resize(row_size * height);
+  for (int y = 0; y < height; ++y)
+    std::memcpy(&(*buffer)[y * row_size], data + y * stride, row_size);
+}
+
 void Renderer::RunFrameDumps()
 {
   Common::SetCurrentThreadName("FrameDumping");
-  bool dump_to_avi = !g_ActiveConfig.bDumpFramesAsImages;
-  bool frame_dump_started = false;
 
-// If Dolphin was compiled without libav, we only support dumping to images.
-#if !defined(HAVE_FFMPEG)
-  if (dump_to_avi)
+  m_image_writer = std::make_unique<ImageWriter>(g_ActiveConfig.iFrameDumpThreads,
+                                                 g_ActiveConfig.iPNGCompressionLevel,
+                                                 g_ActiveConfig.bPNGFastFilter);
+
   {
-    WARN_LOG(VIDEO, "AVI frame dump requested, but Dolphin was compiled without libav. "
-                    "Frame dump will be saved as images instead.");
-    dump_to_avi = false;
+    std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+    m_frame_dump_queue_closed = false;
   }
-#endif
+  m_frame_dump_stats = {};
+  std::thread encoder_thread(&Renderer::RunFrameDumpEncoder, this);
 
   while (true)
   {
@@ -832,42 +848,163 @@ void Renderer::RunFrameDumps()
     // Save screenshot
     if (m_screenshot_request.TestAndClear())
     {
-      std::lock_guard<std::mutex> lk(m_screenshot_lock);
-
-      if (TextureToPng(config.data, config.stride, m_screenshot_name, config.width, config.height,
-                       false))
-        OSD::AddMessage("Screenshot saved to " + m_screenshot_name);
+      std::string filename;
+      {
+        std::lock_guard<std::mutex> lk(m_screenshot_lock);
+        filename = m_screenshot_name;
+        // Reset settings
+        m_screenshot_name.clear();
+      }
 
-      // Reset settings
-      m_screenshot_name.clear();
-      m_screenshot_completed.Set();
+      ImageWriter::Image image{{},    config.width, config.height,    config.width * 4,
+                               false, filename,     ImageFormat::PNG, nullptr};
+      CopyFrameData(config.data, config.width, config.height, config.stride, &image.data);
+      image.on_written = [this, filename](bool written) {
+        if (written)
+          OSD::AddMessage("Screenshot saved to " + filename);
+        m_screenshot_completed.Set();
+      };
+      m_image_writer->Write(std::move(image));
     }
 
     if (SConfig::GetInstance().m_DumpFrames)
+      QueueFrameDump(config);
+
+    m_frame_dump_done.Set();
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+    m_frame_dump_queue_closed = true;
+  }
+  m_frame_dump_queue_changed.notify_all();
+  encoder_thread.join();
+  m_frame_dump_spare_buffers.clear();
+  m_image_writer.reset();
+
+  const FrameDumpStats& stats = m_frame_dump_stats;
+  if (stats.frames != 0)
+  {
+    NOTICE_LOG(VIDEO,
+               "Frame dump: %" PRIu64 " frames, %" PRIu64 " dropped. Per frame: copying %" PRIu64
+               " us, waiting for the encoder %" PRIu64 " us, encoding %" PRIu64 " us",
+               stats.frames, stats.dropped_frames, stats.copy_us / stats.frames,
+               stats.wait_us / stats.frames, stats.encode_us / stats.frames);
+  }
+}
+
+bool Renderer::QueueFrameDump(const FrameDumpConfig& config)
+{
+  const size_t max_queued_frames =
+      static_cast<size_t>(std::max(g_ActiveConfig.iFrameDumpQueueSize, 1));
+  std::vector<u8> buffer;
+
+  {
+    std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+    if (m_frame_dump_queue.size() >= max_queued_frames)
     {
-      if (!frame_dump_started)
+      if (g_ActiveConfig.bFrameDumpDropFrames)
       {
-        if (dump_to_avi)
-          frame_dump_started = StartFrameDumpToAVI(config);
-        else
-          frame_dump_started = StartFrameDumpToImage(config);
-
-        // Stop frame dumping if we fail to start.
-        if (!frame_dump_started)
-          SConfig::GetInstance().m_DumpFrames = false;
+        const u64 dropped_frames = ++m_frame_dump_stats.dropped_frames;
+        if (dropped_frames == 1 || dropped_frames % 100 == 0)
+        {
+          WARN_LOG(VIDEO, "The frame dump encoder can't keep up, %" PRIu64 " frames dropped so far",
+                   dropped_frames);
+        }
+        return false;
       }
 
-      // If we failed to start frame dumping, don't write a frame.
-      if (frame_dump_started)
-      {
-        if (dump_to_avi)
-          DumpFrameToAVI(config);
-        else
-          DumpFrameToImage(config);
-      }
+      const u64 wait_start = Common::Timer::GetTimeUs();
+      m_frame_dump_queue_changed.wait(
+          lk, [&] { return m_frame_dump_queue.size() < max_queued_frames; });
+      m_frame_dump_stats.wait_us += Common::Timer::GetTimeUs() - wait_start;
     }
 
-    m_frame_dump_done.Set();
+    if (!m_frame_dump_spare_buffers.empty())
+    {
+      buffer = std::move(m_frame_dump_spare_buffers.back());
+      m_frame_dump_spare_buffers.pop_back();
+    }
+  }
+
+  const u64 copy_start = Common::Timer::GetTimeUs();
+  CopyFrameData(config.data, config.width, config.height, config.stride, &buffer);
+  m_frame_dump_stats.copy_us += Common::Timer::GetTimeUs() - copy_start;
+
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+    m_frame_dump_queue.push_back(
+        QueuedFrame{std::move(buffer), config.width, config.height, config.state});
+    m_frame_dump_stats.frames++;
+  }
+  m_frame_dump_queue_changed.notify_all();
+  return true;
+}
+
+void Renderer::RunFrameDumpEncoder()
+{
+  Common::SetCurrentThreadName("FrameDumpEncoder");
+  bool dump_to_avi = !g_ActiveConfig.bDumpFramesAsImages;
+  bool frame_dump_started = false;
+
+// If Dolphin was compiled without libav, we only support dumping to images.
+#if !defined(HAVE_FFMPEG)
+  if (dump_to_avi)
+  {
+    WARN_LOG(VIDEO, "AVI frame dump requested, but Dolphin was compiled without libav. "
+                    "Frame dump will be saved as images instead.");
+    dump_to_avi = false;
+  }
+#endif
+
+  while (true)
+  {
+    QueuedFrame frame;
+    {
+      std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+      m_frame_dump_queue_changed.wait(
+          lk, [this] { return !m_frame_dump_queue.empty() || m_frame_dump_queue_closed; });
+      // Frames which are still queued when dumping stops are written anyway.
+      if (m_frame_dump_queue.empty())
+        break;
+      frame = std::move(m_frame_dump_queue.front());
+      m_frame_dump_queue.pop_front();
+    }
+    m_frame_dump_queue_changed.notify_all();
+
+    const FrameDumpConfig config{frame.data.data(), frame.width, frame.height, frame.width * 4,
+                                 false, frame.state};
+    const u64 encode_start = Common::Timer::GetTimeUs();
+
+    if (!frame_dump_started)
+    {
+      if (dump_to_avi)
+        frame_dump_started = StartFrameDumpToAVI(config);
+      else
+        frame_dump_started = StartFrameDumpToImage(config);
+
+      // Stop frame dumping if we fail to start.
+      if (!frame_dump_started)
+        SConfig::GetInstance().m_DumpFrames = false;
+    }
+
+    // If we failed to start frame dumping, don't write a frame.
+    if (frame_dump_started)
+    {
+      if (dump_to_avi)
+        DumpFrameToAVI(config);
+      else
+        DumpFrameToImage(std::move(frame));
+    }
+
+    m_frame_dump_stats.encode_us += Common::Timer::GetTimeUs() - encode_start;
+
+    // Images keep their buffer until they have been written.
+    if (frame.data.capacity() != 0)
+    {
+      std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+      m_frame_dump_spare_buffers.push_back(std::move(frame.data));
+    }
   }
 
   if (frame_dump_started)
@@ -912,10 +1049,16 @@ void Renderer::StopFrameDumpToAVI()
 
 #endif  // defined(HAVE_FFMPEG)
 
+static ImageFormat GetFrameDumpImageFormat()
+{
+  return g_ActiveConfig.sDumpImageFormat == "qoi" ? ImageFormat::QOI : ImageFormat::PNG;
+}
+
 std::string Renderer::GetFrameDumpNextImageFileName() const
 {
-  return StringFromFormat("%sframedump_%u.png", File::GetUserPath(D_DUMPFRAMES_IDX).c_str(),
-                          m_frame_dump_image_counter);
+  return StringFromFormat("%sframedump_%u.%s", File::GetUserPath(D_DUMPFRAMES_IDX).c_str(),
+                          m_frame_dump_image_counter,
+                          GetFrameDumpImageFormat() == ImageFormat::QOI ? "qoi" : "png");
 }
 
 bool Renderer::StartFrameDumpToImage(const FrameDumpConfig& config)
@@ -937,10 +1080,11 @@ bool Renderer::StartFrameDumpToImage(const FrameDumpConfig& config)
   return true;
 }
 
-void Renderer::DumpFrameToImage(const FrameDumpConfig& config)
+void Renderer::DumpFrameToImage(QueuedFrame frame)
 {
-  std::string filename = GetFrameDumpNextImageFileName();
-  TextureToPng(config.data, config.stride, filename, config.width, config.height, false);
+  const int stride = frame.width * 4;
+  m_image_writer->Write({std::move(frame.data), frame.width, frame.height, stride, false,
+                         GetFrameDumpNextImageFileName(), GetFrameDumpImageFormat(), nullptr});
   m_frame_dump_image_counter++;
 }
 
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -31,6 +32,7 @@
 #include "VideoCommon/FPSCounter.h"
 #include "VideoCommon/VideoCommon.h"
 
+class ImageWriter;
 class PostProcessingShaderImplementation;
 enum class EFBAccessType;
 
@@ -135,6 +137,9 @@ public:
   virtual void SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight,
                         const EFBRectangle& rc, u64 ticks, float Gamma = 1.0f) = 0;
 
+  // While set, Swap doesn't show (or dump) frames, e.g. when frames are replayed after a rollback.
+  void SetOutputSuppressed(bool suppressed);
+
   PEControl::PixelFormat GetPrevPixelFormat() const { return m_prev_efb_format; }
   void StorePixelFormat(PEControl::PixelFormat new_format) { m_prev_efb_format = new_format; }
   PostProcessingShaderImplementation* GetPostProcessor() const { return m_post_processor.get(); }
@@ -155,6 +160,7 @@ protected:
                      bool swap_upside_down = false);
   void FinishFrameData();
 
+  Common::Flag m_output_suppressed;
   Common::Flag m_screenshot_request;
   Common::Event m_screenshot_completed;
   std::mutex m_screenshot_lock;
@@ -197,6 +203,10 @@ private:
   int m_last_window_request_height = 0;
 
   // frame dumping
+  // Frame dumping is a pipeline: the frame dumping thread copies each frame out of the backend's
+  // buffer, so that the backend can reuse it right away, and queues the copy for the encoding
+  // thread, which writes the video or the images. When the queue is full, the frame dumping thread
+  // either waits (which makes emulation wait for the encoder) or drops the frame.
   std::thread m_frame_dump_thread;
   Common::Event m_frame_dump_start;
   Common::Event m_frame_dump_done;
@@ -213,13 +223,41 @@ private:
     AVIDump::Frame state;
   } m_frame_dump_config;
 
-  // NOTE: The methods below are called on the framedumping thread.
+  struct QueuedFrame
+  {
+    std::vector<u8> data;
+    int width;
+    int height;
+    AVIDump::Frame state;
+  };
+  std::mutex m_frame_dump_queue_lock;
+  std::condition_variable m_frame_dump_queue_changed;
+  std::deque<QueuedFrame> m_frame_dump_queue;
+  // Buffers of frames which have been encoded, so that they don't have to be allocated again.
+  std::vector<std::vector<u8>> m_frame_dump_spare_buffers;
+  bool m_frame_dump_queue_closed = false;
+  // Writes the images of frame dumps and the screenshots.
+  std::unique_ptr<ImageWriter> m_image_writer;
+
+  struct FrameDumpStats
+  {
+    u64 frames = 0;
+    u64 dropped_frames = 0;
+    u64 copy_us = 0;
+    u64 wait_us = 0;
+    u64 encode_us = 0;
+  } m_frame_dump_stats;
+
+  void RunFrameDumpEncoder();
+  bool QueueFrameDump(const FrameDumpConfig& config);
+
+  // NOTE: The methods below are called on the encoding thread.
   bool StartFrameDumpToAVI(const FrameDumpConfig& config);
   void DumpFrameToAVI(const FrameDumpConfig& config);
   void StopFrameDumpToAVI();
   std::string GetFrameDumpNextImageFileName() const;
   bool StartFrameDumpToImage(const FrameDumpConfig& config);
-  void DumpFrameToImage(const FrameDumpConfig& config);
+  void DumpFrameToImage(QueuedFrame frame);
 };
 
 extern std::unique_ptr<Renderer> g_renderer;
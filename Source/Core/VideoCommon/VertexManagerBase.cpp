@@ -21,6 +21,7 @@
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PerfQueryBase.h"
+#include "VideoCommon/PhaseTimer.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/TextureCacheBase.h"
@@ -189,6 +190,8 @@ void VertexManagerBase::Flush()
   if (m_is_flushed)
     return;
 
+  PhaseTimer::ScopedPhase phase(PhaseTimer::Phase::BackendSubmit);
+
   // loading a state will invalidate BP, so check for it
   g_video_backend->CheckInvalidState();
 
@@ -77,6 +77,12 @@ void VideoConfig::Refresh()
   sDumpPath = Config::Get(Config::GFX_DUMP_PATH);
   iBitrateKbps = Config::Get(Config::GFX_BITRATE_KBPS);
   bInternalResolutionFrameDumps = Config::Get(Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS);
+  iFrameDumpQueueSize = Config::Get(Config::GFX_FRAME_DUMP_QUEUE_SIZE);
+  bFrameDumpDropFrames = Config::Get(Config::GFX_FRAME_DUMP_DROP_FRAMES);
+  iFrameDumpThreads = Config::Get(Config::GFX_FRAME_DUMP_THREADS);
+  sDumpImageFormat = Config::Get(Config::GFX_DUMP_IMAGE_FORMAT);
+  iPNGCompressionLevel = Config::Get(Config::GFX_PNG_COMPRESSION_LEVEL);
+  bPNGFastFilter = Config::Get(Config::GFX_PNG_FAST_FILTER);
   bEnableGPUTextureDecoding = Config::Get(Config::GFX_ENABLE_GPU_TEXTURE_DECODING);
   bEnablePixelLighting = Config::Get(Config::GFX_ENABLE_PIXEL_LIGHTING);
   bFastDepthCalc = Config::Get(Config::GFX_FAST_DEPTH_CALC);
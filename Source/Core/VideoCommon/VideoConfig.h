@@ -113,6 +113,17 @@ struct VideoConfig final
   std::string sDumpFormat;
   std::string sDumpPath;
   bool bInternalResolutionFrameDumps;
+  // How many frames can wait to be encoded, and whether to drop frames rather than slow down
+  // emulation when the queue is full.
+  int iFrameDumpQueueSize;
+  bool bFrameDumpDropFrames;
+  // For the colour conversion and the encoder, or the images. 0 means one per core.
+  int iFrameDumpThreads;
+  // "png" or "qoi", for frame dumps to images
+  std::string sDumpImageFormat;
+  // For frame dumps and screenshots
+  int iPNGCompressionLevel;
+  bool bPNGFastFilter;
   bool bFreeLook;
   bool bBorderlessFullscreen;
   bool bEnableGPUTextureDecoding;
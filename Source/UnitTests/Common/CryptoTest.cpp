@@ -0,0 +1,143 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mbedtls/aes.h>
+#include <mbedtls/sha1.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Crypto/SHA1.h"
+
+namespace
+{
+std::vector<u8> RandomData(size_t size, u32 seed)
+{
+  std::mt19937 generator(seed);
+  std::vector<u8> data(size);
+  for (u8& byte : data)
+    byte = static_cast<u8>(generator());
+  return data;
+}
+
+const std::array<u8, 16> KEY = {{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15,
+                                 0x88, 0x09, 0xcf, 0x4f, 0x3c}};
+
+std::vector<u8> CryptMbedTLS(u8* iv, const std::vector<u8>& src, Common::AES::Mode mode)
+{
+  std::vector<u8> dst(src.size());
+  mbedtls_aes_context context;
+  mbedtls_aes_init(&context);
+  if (mode == Common::AES::Mode::Encrypt)
+    mbedtls_aes_setkey_enc(&context, KEY.data(), 128);
+  else
+    mbedtls_aes_setkey_dec(&context, KEY.data(), 128);
+  mbedtls_aes_crypt_cbc(&context,
+                        mode == Common::AES::Mode::Encrypt ? MBEDTLS_AES_ENCRYPT :
+                                                             MBEDTLS_AES_DECRYPT,
+                        src.size(), iv, src.data(), dst.data());
+  mbedtls_aes_free(&context);
+  return dst;
+}
+}  // Anonymous namespace
+
+TEST(SHA1, KnownDigest)
+{
+  const u8 message[] = {'a', 'b', 'c'};
+  const Common::SHA1::Digest expected = {{0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81,
+                                          0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78, 0x50,
+                                          0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d}};
+  EXPECT_EQ(expected, Common::SHA1::CalculateDigest(message, sizeof(message)));
+}
+
+TEST(SHA1, MatchesMbedTLS)
+{
+  const std::vector<u8> data = RandomData(0x10000 + 300, 1);
+  // Every way the padding can fall, and a few sizes of many blocks.
+  std::vector<size_t> sizes;
+  for (size_t size = 0; size <= 200; ++size)
+    sizes.push_back(size);
+  sizes.insert(sizes.end(), {0x400, 0x7c00, 0x10000 + 300});
+
+  for (size_t size : sizes)
+  {
+    Common::SHA1::Digest expected;
+    mbedtls_sha1(data.data(), size, expected.data());
+    EXPECT_EQ(expected, Common::SHA1::CalculateDigest(data.data(), size)) << "size " << size;
+  }
+}
+
+TEST(AES, KnownCiphertext)
+{
+  // From NIST SP 800-38A, F.2.1.
+  std::array<u8, 16> iv = {{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+                            0x0b, 0x0c, 0x0d, 0x0e, 0x0f}};
+  const std::array<u8, 16> plaintext = {{0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9,
+                                         0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a}};
+  const std::vector<u8> expected = {0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46,
+                                    0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d};
+  EXPECT_EQ(expected, Common::AES::Encrypt(KEY.data(), iv.data(), plaintext.data(), 16));
+}
+
+TEST(AES, MatchesMbedTLS)
+{
+  // The biggest size is decrypted on several threads.
+  for (size_t size : {16, 48, 64, 80, 0x4000, 0x4010, 3 * 1024 * 1024 + 0x30})
+  {
+    const std::vector<u8> data = RandomData(size, static_cast<u32>(size));
+    for (const Common::AES::Mode mode : {Common::AES::Mode::Decrypt, Common::AES::Mode::Encrypt})
+    {
+      std::array<u8, 16> expected_iv = {{1, 2, 3}};
+      std::array<u8, 16> iv = expected_iv;
+      const std::vector<u8> expected = CryptMbedTLS(expected_iv.data(), data, mode);
+      EXPECT_EQ(expected, Common::AES::DecryptEncrypt(KEY.data(), iv.data(), data.data(),
+                                                      data.size(), mode))
+          << "size " << size;
+      // The IV has to be the same too, so that streams can be continued.
+      EXPECT_EQ(expected_iv, iv) << "size " << size;
+    }
+  }
+}
+
+TEST(AES, RoundTrip)
+{
+  const std::vector<u8> data = RandomData(0x1000, 2);
+  std::array<u8, 16> iv{};
+  const std::vector<u8> encrypted = Common::AES::Encrypt(KEY.data(), iv.data(), data.data(),
+                                                         data.size());
+  iv = {};
+  EXPECT_EQ(data, Common::AES::Decrypt(KEY.data(), iv.data(), encrypted.data(), encrypted.size()));
+}
+
+TEST(AES, Batch)
+{
+  const std::vector<u8> data = RandomData(0x40000, 3);
+  constexpr size_t PIECE_SIZE = 0x4000;
+  std::vector<u8> output(data.size());
+  std::vector<Common::AES::BatchEntry> batch;
+  for (size_t offset = 0; offset < data.size(); offset += PIECE_SIZE)
+  {
+    Common::AES::BatchEntry entry{&data[offset], &output[offset], PIECE_SIZE};
+    entry.iv[0] = static_cast<u8>(offset / PIECE_SIZE);
+    batch.push_back(entry);
+  }
+  Common::AES::DecryptEncryptBatch(KEY.data(), &batch, Common::AES::Mode::Decrypt);
+
+  for (size_t i = 0; i < batch.size(); ++i)
+  {
+    std::array<u8, 16> iv{};
+    iv[0] = static_cast<u8>(i);
+    const std::vector<u8> piece(data.begin() + i * PIECE_SIZE,
+                                data.begin() + (i + 1) * PIECE_SIZE);
+    const std::vector<u8> expected = CryptMbedTLS(iv.data(), piece, Common::AES::Mode::Decrypt);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), output.begin() + i * PIECE_SIZE))
+        << "piece " << i;
+    EXPECT_EQ(iv, batch[i].iv) << "piece " << i;
+  }
+}
@@ -0,0 +1,120 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mbedtls/md5.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/MD5.h"
+#include "Common/StringUtil.h"
+
+namespace
+{
+using Hash = std::array<u8, 16>;
+
+Hash Md5(u8 prefix, const u8* data, size_t size)
+{
+  Hash hash;
+  mbedtls_md5_context ctx;
+  mbedtls_md5_init(&ctx);
+  mbedtls_md5_starts(&ctx);
+  mbedtls_md5_update(&ctx, &prefix, 1);
+  mbedtls_md5_update(&ctx, data, size);
+  mbedtls_md5_finish(&ctx, hash.data());
+  mbedtls_md5_free(&ctx);
+  return hash;
+}
+
+Hash Node(const Hash& left, const Hash& right)
+{
+  std::array<u8, 32> children;
+  std::copy(left.begin(), left.end(), children.begin());
+  std::copy(right.begin(), right.end(), children.begin() + 16);
+  return Md5(1, children.data(), children.size());
+}
+
+std::string ToString(const Hash& hash)
+{
+  std::string result;
+  for (u8 n : hash)
+    result += StringFromFormat("%02x", n);
+  return result;
+}
+
+class MD5TreeSumTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_dir = File::CreateTempDir();
+    m_path = m_dir + "/data.bin";
+  }
+  void TearDown() override { File::DeleteDirRecursively(m_dir); }
+
+  void WriteData(const std::vector<u8>& data)
+  {
+    File::IOFile file(m_path, "wb");
+    ASSERT_TRUE(file.WriteBytes(data.data(), data.size()));
+  }
+
+  std::string m_dir;
+  std::string m_path;
+};
+}  // namespace
+
+TEST_F(MD5TreeSumTest, MatchesReferenceTree)
+{
+  // Three chunks and a bit: the fourth leaf is moved up a level unchanged.
+  constexpr u64 CHUNK = MD5::TREE_CHUNK_SIZE;
+  std::vector<u8> data(3 * CHUNK + 123);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<u8>(i * 7 + (i >> 13));
+  WriteData(data);
+
+  Hash leaves[4];
+  for (u64 i = 0; i < 4; ++i)
+    leaves[i] = Md5(0, &data[i * CHUNK], std::min<u64>(CHUNK, data.size() - i * CHUNK));
+  const Hash root = Node(Node(leaves[0], leaves[1]), Node(leaves[2], leaves[3]));
+
+  int last_progress = -1;
+  const std::string sum = MD5::MD5TreeSum(m_path, [&](int progress) {
+    EXPECT_GT(progress, last_progress);
+    last_progress = progress;
+    return true;
+  });
+  EXPECT_EQ(ToString(root), sum);
+  EXPECT_EQ(100, last_progress);
+
+  data[2 * CHUNK + 5] ^= 1;
+  WriteData(data);
+  EXPECT_NE(sum, MD5::MD5TreeSum(m_path, [](int) { return true; }));
+}
+
+TEST_F(MD5TreeSumTest, OddLeafIsMovedUp)
+{
+  constexpr u64 CHUNK = MD5::TREE_CHUNK_SIZE;
+  std::vector<u8> data(2 * CHUNK + 1, 0x5a);
+  WriteData(data);
+
+  const Hash root = Node(Node(Md5(0, data.data(), CHUNK), Md5(0, &data[CHUNK], CHUNK)),
+                         Md5(0, &data[2 * CHUNK], 1));
+  EXPECT_EQ(ToString(root), MD5::MD5TreeSum(m_path, [](int) { return true; }));
+}
+
+TEST_F(MD5TreeSumTest, MissingFile)
+{
+  EXPECT_EQ("", MD5::MD5TreeSum(m_path, [](int) { return true; }));
+}
+
+TEST_F(MD5TreeSumTest, Abort)
+{
+  WriteData(std::vector<u8>(3 * MD5::TREE_CHUNK_SIZE));
+  EXPECT_EQ("", MD5::MD5TreeSum(m_path, [](int) { return false; }));
+}
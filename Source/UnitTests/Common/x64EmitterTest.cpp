@@ -1018,6 +1018,21 @@ AVX_RRM_TEST(VPANDN, "dqword")
 AVX_RRM_TEST(VPOR, "dqword")
 AVX_RRM_TEST(VPXOR, "dqword")
 
+// for AVX instructions that take the form op reg, reg, r/m, imm
+#define AVX_RRMI_TEST(Name, sizename)                                                              \
+  TEST_F(x64EmitterTest, Name)                                                                     \
+  {                                                                                                \
+    for (const auto& r : xmmnames)                                                                 \
+    {                                                                                              \
+      emitter->Name(r.reg, XMM0, R(XMM0), 1);                                                      \
+      emitter->Name(XMM0, r.reg, MatR(R12), 2);                                                    \
+      ExpectDisassembly(#Name " " + r.name + ", xmm0, xmm0, 0x01 " #Name " xmm0, " + r.name +     \
+                        ", " sizename " ptr ds:[r12], 0x02");                                      \
+    }                                                                                              \
+  }
+
+AVX_RRMI_TEST(VBLENDPD, "dqword")
+
 #define FMA3_TEST(Name, P, packed)                                                                 \
   AVX_RRM_TEST(Name##132##P##S, packed ? "dqword" : "dword")                                       \
   AVX_RRM_TEST(Name##213##P##S, packed ? "dqword" : "dword")                                       \
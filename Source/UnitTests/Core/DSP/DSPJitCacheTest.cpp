@@ -0,0 +1,278 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// The emitter has a TEST instruction, and this file only uses TEST_F.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/MemoryUtil.h"
+#include "Common/MsgHandler.h"
+#include "Common/PcapFile.h"
+#include "Core/Config/Config.h"
+#include "Core/ConfigManager.h"
+#include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCaptureLogger.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPTables.h"
+#include "Core/DSP/Jit/DSPEmitter.h"
+#include "UICommon/UICommon.h"
+
+#include "DSPTestBinary.h"
+#include "HermesBinary.h"
+
+// Replays the ucode uploads of a DSPCaptureLogger dump and compiles the code each ucode can
+// branch to, like the dispatcher would when running it. Set DOLPHIN_DSP_CAPTURE to the path of
+// a dump to replay it instead of a generated one.
+
+namespace
+{
+// Copied from DSPCaptureLogger.cpp.
+constexpr u8 DMA_PACKET_MAGIC = 1;
+constexpr size_t DMA_PACKET_HEADER_SIZE = 11;
+constexpr size_t PCAP_HEADER_SIZE = 24;
+constexpr size_t PCAP_RECORD_HEADER_SIZE = 16;
+
+constexpr int UPLOADS = 32;
+
+struct UCodeUpload
+{
+  u16 dsp_address;
+  std::vector<u16> code;
+};
+
+bool RefuseAlerts(const char* caption, const char* text, bool yes_no, int style)
+{
+  return false;
+}
+
+void WriteCapture(const std::string& path, const std::vector<const std::vector<u16>*>& ucodes)
+{
+  DSP::PCAPDSPCaptureLogger logger(path);
+  for (int i = 0; i < UPLOADS; ++i)
+  {
+    const std::vector<u16>& ucode = *ucodes[i % ucodes.size()];
+    logger.LogDMA(DSP::DSP_CR_IMEM | DSP::DSP_CR_FROM_CPU, 0x80000000, 0,
+                  static_cast<u16>(ucode.size() * sizeof(u16)),
+                  reinterpret_cast<const u8*>(ucode.data()));
+  }
+}
+
+std::vector<UCodeUpload> ReadUCodeUploads(const std::string& path)
+{
+  std::vector<UCodeUpload> uploads;
+  std::string data;
+  if (!File::ReadFileToString(path, data) || data.size() < PCAP_HEADER_SIZE)
+    return uploads;
+
+  size_t offset = PCAP_HEADER_SIZE;
+  while (offset + PCAP_RECORD_HEADER_SIZE <= data.size())
+  {
+    u32 size;
+    std::memcpy(&size, &data[offset + 8], sizeof(size));
+    offset += PCAP_RECORD_HEADER_SIZE;
+    if (offset + size > data.size())
+      break;
+
+    const u8* packet = reinterpret_cast<const u8*>(&data[offset]);
+    offset += size;
+    if (size < DMA_PACKET_HEADER_SIZE || packet[0] != DMA_PACKET_MAGIC)
+      continue;
+
+    u16 control, dsp_address, length;
+    std::memcpy(&control, packet + 1, sizeof(control));
+    std::memcpy(&dsp_address, packet + 7, sizeof(dsp_address));
+    std::memcpy(&length, packet + 9, sizeof(length));
+    if ((control & 3) != (DSP::DSP_CR_IMEM | DSP::DSP_CR_FROM_CPU) ||
+        size < DMA_PACKET_HEADER_SIZE + length)
+    {
+      continue;
+    }
+
+    UCodeUpload upload;
+    upload.dsp_address = dsp_address / 2;
+    upload.code.resize(length / 2);
+    std::memcpy(upload.code.data(), packet + DMA_PACKET_HEADER_SIZE, upload.code.size() * 2);
+    uploads.push_back(std::move(upload));
+  }
+  return uploads;
+}
+
+// Whatever the ucode can reach through immediate branches, starting from its entry point.
+std::vector<u16> FindBranchTargets()
+{
+  std::vector<u16> targets{0};
+  for (u16 address = 0; address < DSP::DSP_IRAM_SIZE - 1; ++address)
+  {
+    if (!(DSP::Analyzer::GetCodeFlags(address) & DSP::Analyzer::CODE_START_OF_INST))
+      continue;
+
+    const DSP::DSPOPCTemplate* opcode = DSP::GetOpTemplate(DSP::g_dsp.iram[address]);
+    if (!opcode->branch || opcode->size != 2 || opcode->params[0].type != DSP::P_ADDR_I)
+      continue;
+
+    const u16 target = DSP::g_dsp.iram[address + 1];
+    if (target < DSP::DSP_IRAM_SIZE &&
+        DSP::Analyzer::GetCodeFlags(target) & DSP::Analyzer::CODE_START_OF_INST)
+    {
+      targets.push_back(target);
+    }
+  }
+  return targets;
+}
+}  // namespace
+
+class DSPJitCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+
+    // The ROMs aren't needed to compile IRAM, so don't ask about them.
+    RegisterMsgAlertHandler(RefuseAlerts);
+    DSP::DSPInitOptions opts;
+    opts.irom_contents.fill(0);
+    opts.coef_contents.fill(0);
+    opts.core_type = DSP::DSPInitOptions::CORE_JIT;
+    DSP::InitInstructionTable();
+    ASSERT_TRUE(DSP::DSPCore_Init(opts));
+  }
+
+  void TearDown() override
+  {
+    DSP::DSPCore_Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  // Does what an IRAM DMA and the dispatcher would.
+  void Upload(const UCodeUpload& upload)
+  {
+    Common::UnWriteProtectMemory(DSP::g_dsp.iram, DSP::DSP_IRAM_BYTE_SIZE, false);
+    std::memcpy(DSP::g_dsp.iram + upload.dsp_address, upload.code.data(),
+                upload.code.size() * sizeof(u16));
+    Common::WriteProtectMemory(DSP::g_dsp.iram, DSP::DSP_IRAM_BYTE_SIZE, false);
+
+    DSP::g_dsp_jit->ClearIRAM();
+    DSP::Analyzer::Analyze();
+    if (DSP::g_dsp.reset_dspjit_codespace)
+      DSP::g_dsp_jit->ClearIRAMandDSPJITCodespaceReset();
+  }
+
+  // Blocks waiting for a destination are thrown away once it gets compiled, so this goes over the
+  // targets until they all stay compiled.
+  static void CompileReachable(const std::vector<u16>& targets)
+  {
+    bool compiled = true;
+    while (compiled)
+    {
+      compiled = false;
+      for (u16 target : targets)
+      {
+        if (!DSP::g_dsp_jit->IsBlockCompiled(target))
+        {
+          DSP::g_dsp_jit->CompileWithLinks(target);
+          compiled = true;
+        }
+      }
+    }
+  }
+
+  static bool AllCompiled(const std::vector<u16>& targets)
+  {
+    for (u16 target : targets)
+    {
+      if (!DSP::g_dsp_jit->IsBlockCompiled(target))
+        return false;
+    }
+    return true;
+  }
+
+  // Returns the time spent compiling. Clearing the code space after every upload is what the
+  // JIT used to do.
+  std::chrono::nanoseconds Replay(const std::vector<UCodeUpload>& uploads, bool clear_code_space)
+  {
+    std::chrono::nanoseconds total{0};
+    for (const UCodeUpload& upload : uploads)
+    {
+      Upload(upload);
+      if (clear_code_space)
+        DSP::g_dsp_jit->ClearIRAMandDSPJITCodespaceReset();
+
+      const std::vector<u16> targets = FindBranchTargets();
+      const auto start = std::chrono::high_resolution_clock::now();
+      CompileReachable(targets);
+      total += std::chrono::high_resolution_clock::now() - start;
+    }
+    return total;
+  }
+
+  std::string m_profile_path;
+};
+
+TEST_F(DSPJitCacheTest, ReloadedUCodeReusesBlocks)
+{
+  const UCodeUpload hermes{0, s_hermes_bin};
+  const UCodeUpload test_binary{0, s_dsp_test_bin};
+
+  Upload(hermes);
+  const std::vector<u16> hermes_targets = FindBranchTargets();
+  CompileReachable(hermes_targets);
+  EXPECT_TRUE(AllCompiled(hermes_targets));
+
+  Upload(test_binary);
+  EXPECT_FALSE(DSP::g_dsp_jit->IsBlockCompiled(0));
+  CompileReachable(FindBranchTargets());
+
+  Upload(hermes);
+  EXPECT_TRUE(AllCompiled(hermes_targets));
+
+  // Any change to IRAM must make it compile again.
+  UCodeUpload patched = hermes;
+  patched.code.back() ^= 1;
+  Upload(patched);
+  EXPECT_FALSE(DSP::g_dsp_jit->IsBlockCompiled(0));
+}
+
+TEST_F(DSPJitCacheTest, ReplayCapture)
+{
+  std::string capture_path;
+  if (const char* path = std::getenv("DOLPHIN_DSP_CAPTURE"))
+  {
+    capture_path = path;
+  }
+  else
+  {
+    capture_path = m_profile_path + "/ucodes.pcap";
+    WriteCapture(capture_path, {&s_hermes_bin, &s_dsp_test_bin});
+  }
+
+  const std::vector<UCodeUpload> uploads = ReadUCodeUploads(capture_path);
+  ASSERT_FALSE(uploads.empty());
+
+  const std::chrono::nanoseconds uncached = Replay(uploads, true);
+  DSP::g_dsp_jit->ClearIRAMandDSPJITCodespaceReset();
+  const std::chrono::nanoseconds cached = Replay(uploads, false);
+
+  printf("DSP JIT compile time for %zu ucode uploads:\n", uploads.size());
+  printf("clearing the code space  %llu us\n",
+         static_cast<unsigned long long>(uncached.count() / 1000));
+  printf("with the ucode cache     %llu us\n",
+         static_cast<unsigned long long>(cached.count() / 1000));
+}
@@ -0,0 +1,100 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+
+namespace
+{
+FifoFrameInfo MakeFrame(u32 seed)
+{
+  FifoFrameInfo frame;
+  frame.fifoStart = 0x1000 * seed;
+  frame.fifoEnd = frame.fifoStart + 0x800;
+  frame.fifoData.resize(0x4000 + seed * 16);
+  for (size_t i = 0; i < frame.fifoData.size(); ++i)
+    frame.fifoData[i] = static_cast<u8>((i / 8) * seed);
+
+  for (u32 i = 0; i < 3; ++i)
+  {
+    MemoryUpdate update;
+    update.fifoPosition = i * 0x100;
+    update.address = 0x80000000 + seed * 0x10000 + i * 0x1000;
+    update.type = MemoryUpdate::TEXTURE_MAP;
+    update.data.resize(0x200 * (i + 1), static_cast<u8>(seed + i));
+    frame.memoryUpdates.push_back(std::move(update));
+  }
+  return frame;
+}
+
+void ExpectFramesEqual(const FifoFrameInfo& expected, const FifoFrameInfo& actual)
+{
+  EXPECT_EQ(expected.fifoStart, actual.fifoStart);
+  EXPECT_EQ(expected.fifoEnd, actual.fifoEnd);
+  EXPECT_EQ(expected.fifoData, actual.fifoData);
+  ASSERT_EQ(expected.memoryUpdates.size(), actual.memoryUpdates.size());
+  for (size_t i = 0; i < expected.memoryUpdates.size(); ++i)
+  {
+    EXPECT_EQ(expected.memoryUpdates[i].fifoPosition, actual.memoryUpdates[i].fifoPosition);
+    EXPECT_EQ(expected.memoryUpdates[i].address, actual.memoryUpdates[i].address);
+    EXPECT_EQ(expected.memoryUpdates[i].type, actual.memoryUpdates[i].type);
+    EXPECT_EQ(expected.memoryUpdates[i].data, actual.memoryUpdates[i].data);
+  }
+}
+}  // namespace
+
+TEST(FifoDataFile, SaveAndLoad)
+{
+  constexpr u32 FRAME_COUNT = 12;
+  std::vector<FifoFrameInfo> frames;
+  auto file = std::make_unique<FifoDataFile>();
+  u64 fifo_size = 0;
+  u64 memory_size = 0;
+  for (u32 i = 0; i < FRAME_COUNT; ++i)
+  {
+    frames.push_back(MakeFrame(i + 1));
+    file->AddFrame(frames.back());
+    fifo_size += frames.back().fifoData.size();
+    for (const MemoryUpdate& update : frames.back().memoryUpdates)
+      memory_size += update.data.size();
+  }
+
+  ASSERT_EQ(FRAME_COUNT, file->GetFrameCount());
+  EXPECT_EQ(fifo_size, file->GetAddedFifoDataSize());
+  EXPECT_EQ(memory_size, file->GetAddedMemoryUpdateSize());
+  // More frames than are cached, in an order which evicts them.
+  for (u32 i = 0; i < FRAME_COUNT; ++i)
+    ExpectFramesEqual(frames[i], *file->GetFrame(i));
+  ExpectFramesEqual(frames[0], *file->GetFrame(0));
+
+  const std::string dir = File::CreateTempDir();
+  const std::string path = dir + "/test.dff";
+  file->SetIsWii(true);
+  ASSERT_TRUE(file->Save(path));
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(path, false);
+  ASSERT_TRUE(loaded);
+  EXPECT_TRUE(loaded->GetIsWii());
+  ASSERT_EQ(FRAME_COUNT, loaded->GetFrameCount());
+  for (u32 i = FRAME_COUNT; i-- > 0;)
+    ExpectFramesEqual(frames[i], *loaded->GetFrame(i));
+
+  // Saving a loaded file copies the compressed frames.
+  const std::string copy_path = dir + "/copy.dff";
+  ASSERT_TRUE(loaded->Save(copy_path));
+  const std::unique_ptr<FifoDataFile> copy = FifoDataFile::Load(copy_path, false);
+  ASSERT_TRUE(copy);
+  ASSERT_EQ(FRAME_COUNT, copy->GetFrameCount());
+  for (u32 i = 0; i < FRAME_COUNT; ++i)
+    ExpectFramesEqual(frames[i], *copy->GetFrame(i));
+
+  File::DeleteDirRecursively(dir);
+}
@@ -0,0 +1,182 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/IOS/FS/BufferedFile.h"
+
+using IOS::HLE::BufferedFile;
+
+namespace
+{
+std::vector<u8> MakeData(size_t size, u8 seed)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<u8>(i * 31 + seed);
+  return data;
+}
+
+class BufferedFileTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_dir = File::CreateTempDir();
+    m_path = m_dir + "/file.bin";
+    WriteHostFile(MakeData(4 * BufferedFile::BLOCK_SIZE, 1));
+    m_file = std::make_unique<BufferedFile>(m_path);
+  }
+
+  void TearDown() override
+  {
+    m_file.reset();
+    File::DeleteDirRecursively(m_dir);
+  }
+
+  void WriteHostFile(const std::vector<u8>& data)
+  {
+    File::IOFile file(m_path, "wb");
+    ASSERT_TRUE(file.WriteBytes(data.data(), data.size()));
+  }
+
+  std::vector<u8> ReadHostFile()
+  {
+    std::string contents;
+    EXPECT_TRUE(File::ReadFileToString(m_path, contents));
+    return std::vector<u8>(contents.begin(), contents.end());
+  }
+
+  std::string m_dir;
+  std::string m_path;
+  std::unique_ptr<BufferedFile> m_file;
+};
+}  // Anonymous namespace
+
+TEST_F(BufferedFileTest, SmallReadsAreReadAhead)
+{
+  const std::vector<u8> expected = MakeData(4 * BufferedFile::BLOCK_SIZE, 1);
+  ASSERT_TRUE(m_file->IsOpen());
+  ASSERT_EQ(expected.size(), m_file->GetSize());
+
+  std::vector<u8> data(expected.size());
+  for (size_t offset = 0; offset < data.size(); offset += 0x40)
+  {
+    size_t bytes_read;
+    ASSERT_TRUE(m_file->Read(offset, &data[offset], 0x40, &bytes_read));
+    ASSERT_EQ(0x40u, bytes_read);
+  }
+  EXPECT_EQ(expected, data);
+
+  const BufferedFile::Stats& stats = m_file->GetStats();
+  EXPECT_EQ(data.size() / 0x40, stats.reads);
+  EXPECT_EQ(4u, stats.host_reads);
+  // Reading on from where the last read ended doesn't need a seek.
+  EXPECT_EQ(0u, stats.host_seeks);
+}
+
+TEST_F(BufferedFileTest, ReadStopsAtEndOfFile)
+{
+  const u64 size = m_file->GetSize();
+  std::vector<u8> data(0x100);
+  size_t bytes_read;
+  ASSERT_TRUE(m_file->Read(size - 0x10, data.data(), data.size(), &bytes_read));
+  EXPECT_EQ(0x10u, bytes_read);
+  ASSERT_TRUE(m_file->Read(size, data.data(), data.size(), &bytes_read));
+  EXPECT_EQ(0u, bytes_read);
+}
+
+TEST_F(BufferedFileTest, SmallWritesAreCoalesced)
+{
+  const std::vector<u8> data = MakeData(BufferedFile::BLOCK_SIZE, 2);
+  for (size_t offset = 0; offset < data.size(); offset += 0x20)
+    ASSERT_TRUE(m_file->Write(0x100 + offset, &data[offset], 0x20));
+
+  EXPECT_EQ(0u, m_file->GetStats().host_writes);
+  ASSERT_TRUE(m_file->Flush());
+  EXPECT_EQ(1u, m_file->GetStats().host_writes);
+
+  std::vector<u8> expected = MakeData(4 * BufferedFile::BLOCK_SIZE, 1);
+  std::copy(data.begin(), data.end(), expected.begin() + 0x100);
+  EXPECT_EQ(expected, ReadHostFile());
+}
+
+TEST_F(BufferedFileTest, WritesAreVisibleToReads)
+{
+  const std::vector<u8> data = MakeData(0x80, 3);
+  ASSERT_TRUE(m_file->Write(0x1000, data.data(), data.size()));
+
+  std::vector<u8> read(0x100);
+  size_t bytes_read;
+  ASSERT_TRUE(m_file->Read(0xfc0, read.data(), read.size(), &bytes_read));
+  ASSERT_EQ(read.size(), bytes_read);
+
+  const std::vector<u8> original = MakeData(4 * BufferedFile::BLOCK_SIZE, 1);
+  EXPECT_TRUE(std::equal(read.begin(), read.begin() + 0x40, original.begin() + 0xfc0));
+  EXPECT_TRUE(std::equal(read.begin() + 0x40, read.begin() + 0xc0, data.begin()));
+  EXPECT_TRUE(std::equal(read.begin() + 0xc0, read.end(), original.begin() + 0x1080));
+}
+
+TEST_F(BufferedFileTest, AppendsGrowTheFile)
+{
+  const u64 size = m_file->GetSize();
+  const std::vector<u8> data = MakeData(0x30, 4);
+  ASSERT_TRUE(m_file->Write(size, data.data(), data.size()));
+  EXPECT_EQ(size + data.size(), m_file->GetSize());
+
+  std::vector<u8> read(data.size());
+  size_t bytes_read;
+  ASSERT_TRUE(m_file->Read(size, read.data(), read.size(), &bytes_read));
+  ASSERT_EQ(data.size(), bytes_read);
+  EXPECT_EQ(data, read);
+
+  // Destroying the file writes back what it has buffered.
+  m_file.reset();
+  EXPECT_EQ(size + data.size(), ReadHostFile().size());
+}
+
+TEST_F(BufferedFileTest, BigAccessesGoToTheHost)
+{
+  const std::vector<u8> data = MakeData(2 * BufferedFile::BLOCK_SIZE, 5);
+  ASSERT_TRUE(m_file->Write(0x10, data.data(), data.size()));
+  EXPECT_EQ(1u, m_file->GetStats().host_writes);
+  EXPECT_TRUE(std::equal(data.begin(), data.end(), ReadHostFile().begin() + 0x10));
+
+  std::vector<u8> read(data.size());
+  size_t bytes_read;
+  ASSERT_TRUE(m_file->Read(0x10, read.data(), read.size(), &bytes_read));
+  ASSERT_EQ(read.size(), bytes_read);
+  EXPECT_EQ(data, read);
+  EXPECT_EQ(1u, m_file->GetStats().host_reads);
+}
+
+TEST_F(BufferedFileTest, AlternatingReadsAndWrites)
+{
+  std::vector<u8> expected = MakeData(4 * BufferedFile::BLOCK_SIZE, 1);
+  for (size_t i = 0; i < 64; ++i)
+  {
+    const u64 offset = (i * 0x1234) % (expected.size() - 0x20);
+    const std::vector<u8> data = MakeData(0x20, static_cast<u8>(i));
+    ASSERT_TRUE(m_file->Write(offset, data.data(), data.size()));
+    std::copy(data.begin(), data.end(), expected.begin() + offset);
+
+    std::vector<u8> read(0x40);
+    const u64 read_offset = (i * 0x777) % (expected.size() - read.size());
+    size_t bytes_read;
+    ASSERT_TRUE(m_file->Read(read_offset, read.data(), read.size(), &bytes_read));
+    ASSERT_EQ(read.size(), bytes_read);
+    EXPECT_TRUE(std::equal(read.begin(), read.end(), expected.begin() + read_offset));
+  }
+
+  ASSERT_TRUE(m_file->Flush());
+  EXPECT_EQ(expected, ReadHostFile());
+}
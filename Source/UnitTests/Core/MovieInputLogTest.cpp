@@ -0,0 +1,151 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/MovieInputLog.h"
+
+using Movie::InputLog;
+
+namespace
+{
+std::vector<u8> MakeData(size_t size, u8 seed)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<u8>(i * 31 + seed);
+  return data;
+}
+
+std::vector<u8> ReadAll(InputLog& log)
+{
+  std::vector<u8> data(static_cast<size_t>(log.GetSize()));
+  EXPECT_TRUE(log.Read(0, data.data(), data.size()));
+  return data;
+}
+
+class MovieInputLogTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_dir = File::CreateTempDir();
+    m_log.Reset(m_dir + "/input.bin");
+  }
+
+  void TearDown() override
+  {
+    m_log.Clear();
+    File::DeleteDirRecursively(m_dir);
+  }
+
+  // Appends the data in pieces of the size of a controller state, like a recording does.
+  void Append(const std::vector<u8>& data)
+  {
+    for (size_t i = 0; i < data.size(); i += 8)
+      m_log.Write(m_log.GetSize(), &data[i], std::min<size_t>(8, data.size() - i));
+  }
+
+  std::string m_dir;
+  InputLog m_log;
+};
+}  // Anonymous namespace
+
+TEST_F(MovieInputLogTest, AppendsAndReadsAcrossChunks)
+{
+  const std::vector<u8> data = MakeData(3 * InputLog::CHUNK_SIZE + 100, 1);
+  Append(data);
+
+  ASSERT_EQ(data.size(), m_log.GetSize());
+  EXPECT_EQ(data, ReadAll(m_log));
+
+  // A read which starts in one chunk and ends in the next.
+  u8 bytes[16];
+  ASSERT_TRUE(m_log.Read(InputLog::CHUNK_SIZE - 8, bytes, sizeof(bytes)));
+  EXPECT_TRUE(std::equal(bytes, bytes + sizeof(bytes), &data[InputLog::CHUNK_SIZE - 8]));
+
+  EXPECT_FALSE(m_log.Read(data.size() - 4, bytes, 8));
+}
+
+TEST_F(MovieInputLogTest, TruncatesIntoAFlushedChunk)
+{
+  std::vector<u8> data = MakeData(2 * InputLog::CHUNK_SIZE + 40, 2);
+  Append(data);
+
+  const size_t size = InputLog::CHUNK_SIZE + 24;
+  m_log.Truncate(size);
+  data.resize(size);
+  ASSERT_EQ(size, m_log.GetSize());
+  EXPECT_EQ(data, ReadAll(m_log));
+
+  // Recording goes on from there.
+  const std::vector<u8> more = MakeData(InputLog::CHUNK_SIZE, 3);
+  Append(more);
+  data.insert(data.end(), more.begin(), more.end());
+  EXPECT_EQ(data, ReadAll(m_log));
+}
+
+TEST_F(MovieInputLogTest, OverwritesFlushedAndUnflushedData)
+{
+  std::vector<u8> data = MakeData(2 * InputLog::CHUNK_SIZE, 4);
+  Append(data);
+
+  const std::vector<u8> patch = MakeData(InputLog::CHUNK_SIZE, 5);
+  const size_t offset = InputLog::CHUNK_SIZE / 2;
+  m_log.Write(offset, patch.data(), patch.size());
+  std::copy(patch.begin(), patch.end(), data.begin() + offset);
+
+  ASSERT_EQ(data.size(), m_log.GetSize());
+  EXPECT_EQ(data, ReadAll(m_log));
+}
+
+TEST_F(MovieInputLogTest, CopiesFromAndToFiles)
+{
+  const std::vector<u8> header = MakeData(256, 6);
+  const std::vector<u8> data = MakeData(2 * InputLog::CHUNK_SIZE + 8, 7);
+  const std::string path = m_dir + "/movie.dtm";
+  {
+    File::IOFile file(path, "wb");
+    ASSERT_TRUE(file.WriteBytes(header.data(), header.size()));
+    ASSERT_TRUE(file.WriteBytes(data.data(), data.size()));
+  }
+
+  {
+    File::IOFile file(path, "rb");
+    ASSERT_TRUE(file.Seek(header.size(), SEEK_SET));
+    ASSERT_TRUE(m_log.ReadFrom(file, data.size()));
+  }
+  EXPECT_EQ(data, ReadAll(m_log));
+
+  const std::string copy_path = m_dir + "/copy.bin";
+  {
+    File::IOFile file(copy_path, "wb");
+    ASSERT_TRUE(m_log.WriteTo(file));
+  }
+  std::string copy;
+  ASSERT_TRUE(File::ReadFileToString(copy_path, copy));
+  EXPECT_EQ(std::string(data.begin(), data.end()), copy);
+}
+
+TEST(MovieInputLog, KeepsEverythingInMemoryWithoutAScratchFile)
+{
+  InputLog log;
+  const std::vector<u8> data = MakeData(2 * InputLog::CHUNK_SIZE + 8, 8);
+  log.Write(0, data.data(), data.size());
+
+  ASSERT_EQ(data.size(), log.GetSize());
+  EXPECT_EQ(data, ReadAll(log));
+
+  log.Truncate(10);
+  ASSERT_EQ(10u, log.GetSize());
+  log.Clear();
+  EXPECT_TRUE(log.IsEmpty());
+}
@@ -0,0 +1,536 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <SFML/Network/Packet.hpp>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayInput.h"
+#include "Core/NetPlayProto.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace
+{
+// Size of the old pad packet: message ID, mapping and the nine pad fields.
+constexpr size_t UNBATCHED_PAD_PACKET_SIZE = 12;
+
+// A reliable, ordered link with latency, jitter and loss, like an ENet channel with reliable
+// packets: a lost packet is sent again after a timeout, and nothing behind it is delivered before
+// it arrives.
+class SimulatedLink
+{
+public:
+  SimulatedLink(double latency_ms, double jitter_ms, double loss, u32 seed)
+      : m_latency_ms(latency_ms), m_jitter(0.0, jitter_ms), m_loss(loss), m_rng(seed)
+  {
+  }
+
+  void Send(double now_ms, const sf::Packet& packet)
+  {
+    const double retransmit_timeout_ms = 2 * (m_latency_ms + m_jitter.b());
+    double sent_ms = now_ms;
+    while (m_loss(m_rng))
+    {
+      sent_ms += retransmit_timeout_ms;
+      ++m_lost_packets;
+    }
+
+    const double arrival_ms =
+        std::max(sent_ms + m_latency_ms + m_jitter(m_rng), m_last_arrival_ms);
+    m_last_arrival_ms = arrival_ms;
+    m_in_flight.emplace_back(arrival_ms, packet);
+    ++m_sent_packets;
+    m_sent_bytes += packet.getDataSize();
+  }
+
+  std::vector<sf::Packet> Receive(double now_ms)
+  {
+    std::vector<sf::Packet> received;
+    while (!m_in_flight.empty() && m_in_flight.front().first <= now_ms)
+    {
+      received.push_back(std::move(m_in_flight.front().second));
+      m_in_flight.pop_front();
+    }
+    return received;
+  }
+
+  bool IsEmpty() const { return m_in_flight.empty(); }
+  size_t GetSentPackets() const { return m_sent_packets; }
+  size_t GetSentBytes() const { return m_sent_bytes; }
+  size_t GetLostPackets() const { return m_lost_packets; }
+
+private:
+  double m_latency_ms;
+  std::uniform_real_distribution<double> m_jitter;
+  std::bernoulli_distribution m_loss;
+  std::mt19937 m_rng;
+
+  std::deque<std::pair<double, sf::Packet>> m_in_flight;
+  double m_last_arrival_ms = 0;
+  size_t m_sent_packets = 0;
+  size_t m_sent_bytes = 0;
+  size_t m_lost_packets = 0;
+};
+
+// Moves the sticks a little and presses buttons now and then, like a player would.
+GCPadStatus NextPadState(const GCPadStatus& pad, std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> step(-3, 3);
+  std::uniform_int_distribution<int> percent(0, 99);
+  const auto move = [&](u8 value) {
+    return static_cast<u8>(std::min(255, std::max(0, value + step(rng))));
+  };
+
+  GCPadStatus next = pad;
+  if (percent(rng) < 40)
+  {
+    next.stickX = move(pad.stickX);
+    next.stickY = move(pad.stickY);
+  }
+  if (percent(rng) < 5)
+    next.substickX = move(pad.substickX);
+  if (percent(rng) < 10)
+  {
+    next.button ^= 1 << (percent(rng) % 12);
+    next.analogA = (next.button & PAD_BUTTON_A) ? 0xFF : 0;
+  }
+  return next;
+}
+
+void ExpectPadsEqual(const GCPadStatus& expected, const GCPadStatus& actual)
+{
+  EXPECT_EQ(expected.button, actual.button);
+  EXPECT_EQ(expected.stickX, actual.stickX);
+  EXPECT_EQ(expected.stickY, actual.stickY);
+  EXPECT_EQ(expected.substickX, actual.substickX);
+  EXPECT_EQ(expected.substickY, actual.substickY);
+  EXPECT_EQ(expected.triggerLeft, actual.triggerLeft);
+  EXPECT_EQ(expected.triggerRight, actual.triggerRight);
+  EXPECT_EQ(expected.analogA, actual.analogA);
+  EXPECT_EQ(expected.analogB, actual.analogB);
+}
+
+GCPadStatus MakeNeutralPad()
+{
+  GCPadStatus pad{};
+  pad.stickX = pad.stickY = 0x80;
+  pad.substickX = pad.substickY = 0x80;
+  return pad;
+}
+}  // namespace
+
+// Two players send their pads through a server, which checks and relays them to a third client,
+// all over lossy links. The third client has to see exactly the states that were sent.
+TEST(NetPlayInput, PadsSurviveRelayOverLossyLinks)
+{
+  constexpr int FRAMES = 3600;
+  constexpr double FRAME_MS = 1000.0 / 60;
+  constexpr u32 BUFFER = 6;
+
+  std::mt19937 rng(1234);
+  std::array<SimulatedLink, 2> uplinks = {
+      {SimulatedLink(40, 15, 0.03, 1), SimulatedLink(70, 25, 0.05, 2)}};
+  SimulatedLink downlink(55, 20, 0.04, 3);
+
+  // Player 0 has one pad, player 1 has pads 1 and 2.
+  const std::array<std::vector<PadMapping>, 2> owned_pads = {{{0}, {1, 2}}};
+  std::array<NetPlay::InputCodec, 2> client_encoders;
+  std::array<NetPlay::InputCodec, 2> server_decoders;
+  NetPlay::InputCodec server_encoder;
+  NetPlay::InputCodec receiver_decoder;
+
+  std::array<GCPadStatus, 3> pads;
+  pads.fill(MakeNeutralPad());
+  std::array<std::vector<GCPadStatus>, 3> sent;
+  std::array<std::vector<GCPadStatus>, 3> received;
+  size_t unbatched_packets = 0;
+
+  // The server checks the pads and relays them.
+  const auto relay = [&](size_t player, sf::Packet& packet, double now) {
+    MessageId mid;
+    u16 count;
+    packet >> mid >> count;
+    ASSERT_EQ(NP_MSG_PAD_DATA, mid);
+
+    sf::Packet relayed;
+    relayed << mid << count;
+    for (u16 i = 0; i < count; ++i)
+    {
+      PadMapping map;
+      GCPadStatus pad;
+      ASSERT_TRUE(server_decoders[player].DecodePad(packet, &map, &pad));
+      ASSERT_NE(owned_pads[player].end(),
+                std::find(owned_pads[player].begin(), owned_pads[player].end(), map));
+      server_encoder.EncodePad(relayed, map, pad);
+    }
+    EXPECT_TRUE(packet.endOfPacket());
+    downlink.Send(now, relayed);
+  };
+  const auto receive = [&](sf::Packet& packet) {
+    MessageId mid;
+    u16 count;
+    packet >> mid >> count;
+    for (u16 i = 0; i < count; ++i)
+    {
+      PadMapping map;
+      GCPadStatus pad;
+      ASSERT_TRUE(receiver_decoder.DecodePad(packet, &map, &pad));
+      received[map].push_back(pad);
+    }
+  };
+
+  for (int frame = 0; frame < FRAMES; ++frame)
+  {
+    const double now = frame * FRAME_MS;
+    for (size_t player = 0; player < owned_pads.size(); ++player)
+    {
+      sf::Packet packet;
+      std::vector<std::pair<PadMapping, GCPadStatus>> batch;
+      for (PadMapping map : owned_pads[player])
+      {
+        pads[map] = NextPadState(pads[map], rng);
+        // The first poll fills the buffer.
+        const u32 copies = frame == 0 ? BUFFER : 1;
+        for (u32 i = 0; i < copies; ++i)
+          batch.emplace_back(map, pads[map]);
+      }
+
+      packet << static_cast<MessageId>(NP_MSG_PAD_DATA) << static_cast<u16>(batch.size());
+      for (const auto& entry : batch)
+      {
+        client_encoders[player].EncodePad(packet, entry.first, entry.second);
+        sent[entry.first].push_back(entry.second);
+      }
+      uplinks[player].Send(now, packet);
+      unbatched_packets += batch.size();
+    }
+
+    for (size_t player = 0; player < uplinks.size(); ++player)
+    {
+      for (sf::Packet& packet : uplinks[player].Receive(now))
+        relay(player, packet, now);
+    }
+    for (sf::Packet& packet : downlink.Receive(now))
+      receive(packet);
+  }
+
+  // Let everything arrive.
+  const double end = FRAMES * FRAME_MS + 10000;
+  for (size_t player = 0; player < uplinks.size(); ++player)
+  {
+    for (sf::Packet& packet : uplinks[player].Receive(end))
+      relay(player, packet, end);
+  }
+  for (sf::Packet& packet : downlink.Receive(2 * end))
+    receive(packet);
+  EXPECT_TRUE(downlink.IsEmpty());
+  EXPECT_GT(downlink.GetLostPackets(), 0u);
+
+  for (size_t map = 0; map < sent.size(); ++map)
+  {
+    ASSERT_EQ(sent[map].size(), received[map].size());
+    for (size_t i = 0; i < sent[map].size(); ++i)
+      ExpectPadsEqual(sent[map][i], received[map][i]);
+  }
+
+  // One packet per player and poll instead of one per pad state, and far fewer bytes.
+  const size_t sent_packets = uplinks[0].GetSentPackets() + uplinks[1].GetSentPackets();
+  const size_t sent_bytes = uplinks[0].GetSentBytes() + uplinks[1].GetSentBytes();
+  EXPECT_EQ(2u * FRAMES, sent_packets);
+  EXPECT_LT(sent_packets, unbatched_packets);
+  EXPECT_LT(sent_bytes * 2, unbatched_packets * UNBATCHED_PAD_PACKET_SIZE);
+}
+
+TEST(NetPlayInput, WiimoteReportsKeepTheirSize)
+{
+  NetPlay::InputCodec encoder;
+  NetPlay::InputCodec decoder;
+  std::mt19937 rng(99);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  std::vector<NetWiimote> reports;
+  NetWiimote nw = {0xa1, 0x33, 0x00, 0x00, 0x80, 0x80, 0x80};
+  for (int i = 0; i < 200; ++i)
+  {
+    // Switch reporting modes now and then, which changes the size.
+    if (i % 50 == 25)
+      nw.resize(nw.size() == 7 ? 23 : 7, 0xff);
+    nw[2 + i % 3] = static_cast<u8>(byte(rng));
+    reports.push_back(nw);
+  }
+
+  sf::Packet packet;
+  for (const NetWiimote& report : reports)
+    encoder.EncodeWiimote(packet, 3, report);
+
+  for (const NetWiimote& report : reports)
+  {
+    PadMapping map;
+    NetWiimote decoded;
+    ASSERT_TRUE(decoder.DecodeWiimote(packet, &map, &decoded));
+    EXPECT_EQ(3, map);
+    EXPECT_EQ(report, decoded);
+  }
+  EXPECT_TRUE(packet.endOfPacket());
+}
+
+TEST(NetPlayInput, ResetStartsOver)
+{
+  NetPlay::InputCodec encoder;
+  NetPlay::InputCodec decoder;
+  GCPadStatus pad = MakeNeutralPad();
+  pad.button = PAD_BUTTON_START;
+
+  sf::Packet first;
+  encoder.EncodePad(first, 1, pad);
+  // Unchanged pads only cost the mapping and an empty change mask.
+  sf::Packet second;
+  encoder.EncodePad(second, 1, pad);
+  EXPECT_EQ(3u, second.getDataSize());
+
+  encoder.Reset();
+  sf::Packet third;
+  encoder.EncodePad(third, 1, pad);
+  EXPECT_EQ(first.getDataSize(), third.getDataSize());
+
+  PadMapping map;
+  GCPadStatus decoded;
+  ASSERT_TRUE(decoder.DecodePad(first, &map, &decoded));
+  decoder.Reset();
+  ASSERT_TRUE(decoder.DecodePad(third, &map, &decoded));
+  ExpectPadsEqual(pad, decoded);
+}
+
+TEST(NetPlayInput, RejectsBadInput)
+{
+  NetPlay::InputCodec decoder;
+  PadMapping map;
+  GCPadStatus pad;
+  NetWiimote nw;
+
+  sf::Packet bad_map;
+  bad_map << static_cast<PadMapping>(4) << static_cast<u16>(0);
+  EXPECT_FALSE(decoder.DecodePad(bad_map, &map, &pad));
+
+  sf::Packet truncated;
+  truncated << static_cast<PadMapping>(0) << static_cast<u16>(0x1ff);
+  EXPECT_FALSE(decoder.DecodePad(truncated, &map, &pad));
+
+  sf::Packet negative_map;
+  negative_map << static_cast<PadMapping>(-1) << static_cast<u8>(0);
+  EXPECT_FALSE(decoder.DecodeWiimote(negative_map, &map, &nw));
+}
+
+TEST(NetPlayInputBufferEstimator, FollowsTheSlowestPlayer)
+{
+  NetPlay::BufferEstimator estimator;
+  u32 size = 0;
+  EXPECT_EQ(0u, estimator.GetTarget());
+  EXPECT_FALSE(estimator.Update(5, &size));
+
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> jitter(-8, 8);
+  for (int i = 0; i < 60; ++i)
+  {
+    estimator.AddSample(2, static_cast<u32>(20 + jitter(rng)));
+    estimator.AddSample(3, static_cast<u32>(80 + jitter(rng)));
+  }
+
+  // About 80 ms plus the variation, in 1/120 s steps.
+  const u32 target = estimator.GetTarget();
+  EXPECT_GE(target, 10u);
+  EXPECT_LE(target, 15u);
+
+  // Growing happens at once.
+  ASSERT_TRUE(estimator.Update(5, &size));
+  EXPECT_EQ(target, size);
+
+  // Shrinking needs a few samples that agree.
+  estimator.RemovePlayer(3);
+  const u32 smaller = estimator.GetTarget();
+  EXPECT_LT(smaller, target);
+  for (u32 i = 1; i < NetPlay::BufferEstimator::DECREASE_SAMPLES; ++i)
+    EXPECT_FALSE(estimator.Update(target, &size));
+  ASSERT_TRUE(estimator.Update(target, &size));
+  EXPECT_EQ(smaller, size);
+
+  // Huge pings are capped.
+  for (int i = 0; i < 10; ++i)
+    estimator.AddSample(4, 2000);
+  EXPECT_EQ(NetPlay::BufferEstimator::MAX_BUFFER, estimator.GetTarget());
+}
+
+TEST(NetPlayRollbackInputs, ReplaysMispredictionsToTheRightState)
+{
+  // A "game" whose state is a hash of every pad state it polled, with pad 0 local and pad 1
+  // remote. Now and then, remote states arrive a few frames late, and the game predicts them
+  // instead of waiting, rolling back to a snapshot when a prediction was wrong.
+  constexpr u64 FRAMES = 3000;
+  constexpr size_t MAX_SNAPSHOTS = NetPlay::RollbackInputs::MAX_PREDICTED_POLLS + 2;
+
+  std::mt19937 rng(7);
+  std::bernoulli_distribution late(0.1);
+  std::uniform_int_distribution<u64> delay(1, 12);
+  std::array<std::vector<GCPadStatus>, 2> actual;
+  std::array<GCPadStatus, 2> pads = {{MakeNeutralPad(), MakeNeutralPad()}};
+  std::vector<u64> arrival;
+  for (u64 i = 0; i < FRAMES; ++i)
+  {
+    for (size_t p = 0; p < pads.size(); ++p)
+    {
+      pads[p] = NextPadState(pads[p], rng);
+      actual[p].push_back(pads[p]);
+    }
+    arrival.push_back(
+        std::max(arrival.empty() ? 0 : arrival.back(), i + (late(rng) ? delay(rng) : 0)));
+  }
+
+  const auto step = [](u64 state, const GCPadStatus& a, const GCPadStatus& b) {
+    for (const GCPadStatus& status : {a, b})
+    {
+      state = state * 31 + status.button;
+      state = state * 31 + status.stickX;
+      state = state * 31 + status.triggerRight;
+    }
+    return state;
+  };
+  u64 expected = 1;
+  for (u64 i = 0; i < FRAMES; ++i)
+    expected = step(expected, actual[0][i], actual[1][i]);
+
+  struct Snapshot
+  {
+    NetPlay::RollbackInputs::PollCounts polls;
+    u64 state;
+  };
+  std::deque<Snapshot> snapshots;
+  NetPlay::RollbackInputs inputs;
+  u64 state = 1;
+  u64 arrived = 0;
+  u64 received = 0;
+  u32 rollbacks = 0;
+  u32 predictions = 0;
+
+  for (u64 now = 0; now < 10 * FRAMES; ++now)
+  {
+    while (arrived < FRAMES && arrival[arrived] <= now)
+      ++arrived;
+    while (inputs.HasUnconfirmed(1) && received < arrived)
+      inputs.Confirm(1, actual[1][received++]);
+
+    // The safe point.
+    if (inputs.NeedsRollback())
+    {
+      const auto& limit = inputs.GetRollbackLimit();
+      while (!snapshots.empty() &&
+             (snapshots.back().polls[0] > limit[0] || snapshots.back().polls[1] > limit[1]))
+      {
+        snapshots.pop_back();
+      }
+      ASSERT_FALSE(snapshots.empty());
+      state = snapshots.back().state;
+      inputs.Rewind(snapshots.back().polls);
+      ++rollbacks;
+    }
+    else
+    {
+      if (snapshots.size() == MAX_SNAPSHOTS)
+        snapshots.pop_front();
+      snapshots.push_back({inputs.GetPollCounts(), state});
+      inputs.Forget(snapshots.front().polls);
+    }
+
+    const u64 poll = inputs.GetPollCounts()[1];
+    if (poll == FRAMES)
+    {
+      if (!inputs.HasUnconfirmed(1) && !inputs.NeedsRollback())
+        break;
+      continue;
+    }
+
+    GCPadStatus remote;
+    if (inputs.IsReplaying(1))
+    {
+      remote = inputs.Replay(1);
+    }
+    else if (received < arrived)
+    {
+      remote = actual[1][received++];
+      inputs.AddConfirmed(1, remote);
+    }
+    else if (inputs.CanPredict(1) && snapshots.front().polls[1] <= inputs.GetConfirmedCounts()[1])
+    {
+      remote = inputs.Predict(1);
+      ++predictions;
+    }
+    else
+    {
+      // Waits, like NetPlay without rollback.
+      continue;
+    }
+
+    GCPadStatus local;
+    if (inputs.IsReplaying(0))
+    {
+      local = inputs.Replay(0);
+    }
+    else
+    {
+      local = actual[0][inputs.GetPollCounts()[0]];
+      inputs.AddConfirmed(0, local);
+    }
+
+    state = step(state, local, remote);
+  }
+
+  EXPECT_EQ(FRAMES, inputs.GetPollCounts()[1]);
+  EXPECT_EQ(expected, state);
+  EXPECT_GT(predictions, 0u);
+  EXPECT_GT(rollbacks, 0u);
+}
+
+TEST(NetPlayRollbackInputs, LimitsPredictions)
+{
+  NetPlay::RollbackInputs inputs;
+  EXPECT_FALSE(inputs.CanPredict(1));
+
+  const GCPadStatus first = MakeNeutralPad();
+  GCPadStatus second = first;
+  second.button = PAD_BUTTON_A;
+  second.analogA = 0xFF;
+
+  inputs.AddConfirmed(1, first);
+  for (u32 i = 0; i < NetPlay::RollbackInputs::MAX_PREDICTED_POLLS; ++i)
+  {
+    ASSERT_TRUE(inputs.CanPredict(1));
+    ExpectPadsEqual(first, inputs.Predict(1));
+  }
+  EXPECT_FALSE(inputs.CanPredict(1));
+
+  // A right prediction doesn't need a rollback.
+  inputs.Confirm(1, first);
+  EXPECT_FALSE(inputs.NeedsRollback());
+  EXPECT_TRUE(inputs.CanPredict(1));
+
+  // A wrong one does, back to the poll that used it.
+  inputs.Confirm(1, second);
+  ASSERT_TRUE(inputs.NeedsRollback());
+  EXPECT_EQ(2u, inputs.GetRollbackLimit()[1]);
+
+  inputs.Rewind({{0, 2, 0, 0}});
+  EXPECT_FALSE(inputs.NeedsRollback());
+  for (u32 i = 2; i <= NetPlay::RollbackInputs::MAX_PREDICTED_POLLS; ++i)
+  {
+    ASSERT_TRUE(inputs.IsReplaying(1));
+    ExpectPadsEqual(second, inputs.Replay(1));
+  }
+  EXPECT_FALSE(inputs.IsReplaying());
+}
@@ -0,0 +1,94 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+
+using PPCAnalyst::ExitLiveness;
+using PPCAnalyst::ExitLivenessCache;
+
+static ExitLiveness MakeLiveness(u32 physical_address, u32 instructions)
+{
+  ExitLiveness liveness;
+  liveness.deadGPRs = BitSet32{3};
+  liveness.translated = true;
+  liveness.physical_address = physical_address;
+  for (u32 i = 0; i < instructions; ++i)
+    liveness.physical_addresses.insert(physical_address + i * 4);
+  return liveness;
+}
+
+TEST(ExitLivenessCache, FindChecksTranslation)
+{
+  ExitLivenessCache cache;
+  cache.Insert(0x80001000, MakeLiveness(0x1000, 8));
+
+  const ExitLiveness* liveness = cache.Find(0x80001000, 0x1000, true);
+  ASSERT_NE(nullptr, liveness);
+  EXPECT_EQ(BitSet32{3}, liveness->deadGPRs);
+
+  EXPECT_EQ(nullptr, cache.Find(0x80001000, 0x2000, true));
+  EXPECT_EQ(nullptr, cache.Find(0x80001000, 0x1000, false));
+  EXPECT_EQ(nullptr, cache.Find(0x80001004, 0x1004, true));
+}
+
+TEST(ExitLivenessCache, InvalidateKeepsNeighboursIndexed)
+{
+  ExitLivenessCache cache;
+  cache.Insert(0x80001000, MakeLiveness(0x1000, 8));
+  cache.Insert(0x80001040, MakeLiveness(0x1040, 8));
+
+  // Only the entry derived from the invalidated line goes away.
+  cache.InvalidatePhysicalRange(0x1000, 32);
+  EXPECT_EQ(nullptr, cache.Find(0x80001000, 0x1000, true));
+  EXPECT_NE(nullptr, cache.Find(0x80001040, 0x1040, true));
+
+  // The other entry in the same region must still be found by a later invalidation.
+  cache.InvalidatePhysicalRange(0x1040, 32);
+  EXPECT_EQ(nullptr, cache.Find(0x80001040, 0x1040, true));
+}
+
+TEST(ExitLivenessCache, InvalidateEntrySpanningRegions)
+{
+  ExitLivenessCache cache;
+  cache.Insert(0x800010F0, MakeLiveness(0x10F0, 16));
+  cache.InvalidatePhysicalRange(0x1120, 4);
+  EXPECT_EQ(nullptr, cache.Find(0x800010F0, 0x10F0, true));
+
+  cache.Insert(0x800010F0, MakeLiveness(0x10F0, 16));
+  cache.InvalidatePhysicalRange(0x10F0, 4);
+  EXPECT_EQ(nullptr, cache.Find(0x800010F0, 0x10F0, true));
+
+  // Reinserting after an invalidation through the other region must index it again.
+  cache.Insert(0x800010F0, MakeLiveness(0x10F0, 16));
+  cache.InvalidatePhysicalRange(0x1100, 0x100);
+  EXPECT_EQ(nullptr, cache.Find(0x800010F0, 0x10F0, true));
+}
+
+TEST(ExitLivenessCache, InsertReplacesStaleEntry)
+{
+  ExitLivenessCache cache;
+  cache.Insert(0x80001000, MakeLiveness(0x1000, 8));
+
+  // The destination got remapped to different physical code.
+  cache.Insert(0x80001000, MakeLiveness(0x5000, 8));
+  cache.InvalidatePhysicalRange(0x1000, 32);
+  EXPECT_NE(nullptr, cache.Find(0x80001000, 0x5000, true));
+
+  cache.InvalidatePhysicalRange(0x5000, 32);
+  EXPECT_EQ(nullptr, cache.Find(0x80001000, 0x5000, true));
+}
+
+TEST(ExitLivenessCache, InvalidateOutsideRangeKeepsEntry)
+{
+  ExitLivenessCache cache;
+  cache.Insert(0x80001000, MakeLiveness(0x1000, 8));
+  cache.InvalidatePhysicalRange(0x1020, 0x100);
+  EXPECT_NE(nullptr, cache.Find(0x80001000, 0x1000, true));
+
+  cache.Clear();
+  EXPECT_EQ(nullptr, cache.Find(0x80001000, 0x1000, true));
+}
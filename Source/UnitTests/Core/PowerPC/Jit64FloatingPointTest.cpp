@@ -0,0 +1,335 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// The emitter has a TEST instruction, and this file only uses TEST_F.
+#undef TEST
+
+#include "Common/BitSet.h"
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/x64ABI.h"
+#include "Core/Config/Config.h"
+#include "Core/ConfigManager.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/Jit64/Jit.h"
+#include "Core/PowerPC/Jit64Common/Jit64PowerPCState.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+// Compares the code Jit64 emits for floating point and paired single instructions against the
+// interpreter, over random inputs mixed with NaNs, infinities, zeroes and denormals.
+
+using namespace Gen;
+
+namespace
+{
+using JitHandler = void (Jit64::*)(UGeckoInstruction);
+using InterpreterHandler = void (*)(UGeckoInstruction);
+
+// Compiles single instructions into functions which operate directly on PowerPC::ppcState.
+class TestJit64 : public Jit64
+{
+public:
+  using Function = void (*)();
+
+  // The dispatcher is generated from g_jit's block cache.
+  TestJit64()
+  {
+    g_jit = this;
+    Init();
+  }
+  ~TestJit64()
+  {
+    Shutdown();
+    g_jit = nullptr;
+  }
+
+  Function Compile(JitHandler handler, UGeckoInstruction inst, BitSet32 fregs_in, bool preload)
+  {
+    m_op = {};
+    m_op.inst = inst;
+    m_op.fregsIn = fregs_in;
+    js.op = &m_op;
+    js.compilerPC = 0;
+    js.instructionsLeft = 0;
+
+    const u8* start = AlignCode16();
+    ABI_PushRegistersAndAdjustStack(ABI_ALL_CALLEE_SAVED, 8, 16);
+    MOV(64, R(RPPCSTATE), ImmPtr(reinterpret_cast<u8*>(&PowerPC::ppcState) + 0x80));
+
+    gpr.Start();
+    fpr.Start();
+    // Binding the inputs first makes the instruction use register operands instead of memory.
+    if (preload)
+    {
+      for (int i : fregs_in)
+        fpr.BindToRegister(i, true, false);
+    }
+    (this->*handler)(inst);
+    gpr.Flush();
+    fpr.Flush();
+
+    ABI_PopRegistersAndAdjustStack(ABI_ALL_CALLEE_SAVED, 8, 16);
+    RET();
+    return reinterpret_cast<Function>(const_cast<u8*>(start));
+  }
+
+private:
+  PPCAnalyst::CodeOp m_op;
+};
+
+struct Instruction
+{
+  const char* name;
+  u32 opcd;
+  u32 subop5;
+  JitHandler jit;
+  InterpreterHandler interpreter;
+  bool reads_b;
+  // The JIT computes nmsub as b - a*c rather than -(a*c - b), which gives exact zeroes the
+  // opposite sign.
+  bool zero_sign_may_differ;
+};
+
+// clang-format off
+const Instruction INSTRUCTIONS[] = {
+    {"ps_sum0",  4, 10, &Jit64::ps_sum,  Interpreter::ps_sum0,  true,  false},
+    {"ps_sum1",  4, 11, &Jit64::ps_sum,  Interpreter::ps_sum1,  true,  false},
+    {"ps_muls0", 4, 12, &Jit64::ps_muls, Interpreter::ps_muls0, false, false},
+    {"ps_muls1", 4, 13, &Jit64::ps_muls, Interpreter::ps_muls1, false, false},
+    {"ps_sel",   4, 23, &Jit64::fselx,   Interpreter::ps_sel,   true,  false},
+    {"fsel",    63, 23, &Jit64::fselx,   Interpreter::fselx,    true,  false},
+    {"ps_nmsub", 4, 30, &Jit64::fmaddXX, Interpreter::ps_nmsub, true,  true},
+    {"fnmsub",  63, 30, &Jit64::fmaddXX, Interpreter::fnmsubx,  true,  true},
+};
+
+// d, a, b, c; covers the output aliasing each of the inputs.
+const u32 REGISTER_LAYOUTS[][4] = {
+    {1, 2, 3, 4},
+    {2, 2, 3, 4},
+    {3, 2, 3, 4},
+    {4, 2, 3, 4},
+    {1, 2, 2, 2},
+};
+
+const u64 SPECIAL_VALUES[] = {
+    0x0000000000000000,  // +0
+    0x8000000000000000,  // -0
+    0x3FF0000000000000,  // 1.0
+    0xBFF0000000000000,  // -1.0
+    0x7FF0000000000000,  // +inf
+    0xFFF0000000000000,  // -inf
+    0x7FF8000000000000,  // QNaN
+    0xFFF8000000000123,  // negative QNaN with a payload
+    0x7FF4000000000000,  // SNaN
+    0x0000000000000001,  // smallest double denormal
+    0x800FFFFFFFFFFFFF,  // largest negative double denormal
+    0x3800000000000000,  // 2^-127, a single precision denormal
+    0x36A0000000000000,  // 2^-149, the smallest single precision denormal
+    0x47EFFFFFE0000000,  // FLT_MAX
+};
+// clang-format on
+
+constexpr int ITERATIONS = 2000;
+
+UGeckoInstruction Encode(const Instruction& instruction, const u32 (&layout)[4])
+{
+  UGeckoInstruction inst;
+  inst.hex = (instruction.opcd << 26) | (layout[0] << 21) | (layout[1] << 16) |
+             (layout[2] << 11) | (layout[3] << 6) | (instruction.subop5 << 1);
+  return inst;
+}
+
+bool IsNaN(u64 bits)
+{
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return std::isnan(value);
+}
+
+bool IsZero(u64 bits)
+{
+  return (bits & ~0x8000000000000000) == 0;
+}
+
+std::string Hex(u64 bits)
+{
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(bits));
+  return buffer;
+}
+}  // namespace
+
+class Jit64FloatingPointTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    m_saved_cpu_info = cpu_info;
+    // FMA rounds once instead of twice, so it can't be compared bit for bit.
+    cpu_info.bFMA = false;
+  }
+
+  void TearDown() override
+  {
+    cpu_info = m_saved_cpu_info;
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  u64 RandomValue()
+  {
+    const u32 kind = m_rng() % 8;
+    if (kind < 2)
+      return SPECIAL_VALUES[m_rng() % (sizeof(SPECIAL_VALUES) / sizeof(SPECIAL_VALUES[0]))];
+    if (kind == 2)
+      return (static_cast<u64>(m_rng()) << 32) | m_rng();
+
+    // A normal number with a moderate exponent, so that results are mostly finite.
+    const u64 sign = static_cast<u64>(m_rng() & 1) << 63;
+    const u64 exponent = static_cast<u64>(1023 - 40 + m_rng() % 80) << 52;
+    const u64 mantissa = ((static_cast<u64>(m_rng()) << 32) | m_rng()) & 0x000FFFFFFFFFFFFF;
+    return sign | exponent | mantissa;
+  }
+
+  // Returns false after reporting the first mismatching register.
+  static bool Compare(const Instruction& instruction, const u32 (&layout)[4],
+                      const u64 (&inputs)[32][2], const u64 (&expected)[32][2], bool exact_nans,
+                      const char* reference)
+  {
+    for (u32 reg = 0; reg < 32; ++reg)
+    {
+      for (u32 slot = 0; slot < 2; ++slot)
+      {
+        const u64 actual = PowerPC::ppcState.ps[reg][slot];
+        const u64 wanted = expected[reg][slot];
+        if (actual == wanted)
+          continue;
+        if (IsNaN(wanted) && IsNaN(actual) && !exact_nans)
+          continue;
+        if (IsZero(wanted) && IsZero(actual) && instruction.zero_sign_may_differ)
+          continue;
+
+        ADD_FAILURE() << instruction.name << " f" << layout[0] << ", f" << layout[1] << ", f"
+                      << layout[2] << ", f" << layout[3] << ": ps" << slot << " of f" << reg
+                      << " is " << Hex(actual) << ", " << reference << " gives " << Hex(wanted)
+                      << " (inputs a=" << Hex(inputs[layout[1]][0]) << "/"
+                      << Hex(inputs[layout[1]][1]) << " b=" << Hex(inputs[layout[2]][0]) << "/"
+                      << Hex(inputs[layout[2]][1]) << " c=" << Hex(inputs[layout[3]][0]) << "/"
+                      << Hex(inputs[layout[3]][1]) << ")";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void RunInstruction(const Instruction& instruction, bool accurate_nans, bool preload)
+  {
+    SConfig::GetInstance().bAccurateNaNs = accurate_nans;
+    // The block cache makes Jit64 far too large for the stack.
+    auto jit = std::make_unique<TestJit64>();
+    const bool avx = cpu_info.bAVX;
+
+    for (const auto& layout : REGISTER_LAYOUTS)
+    {
+      const UGeckoInstruction inst = Encode(instruction, layout);
+      BitSet32 fregs_in;
+      fregs_in[layout[1]] = true;
+      fregs_in[layout[3]] = true;
+      if (instruction.reads_b)
+        fregs_in[layout[2]] = true;
+
+      // The AVX code must behave exactly like the SSE code, including NaN payloads.
+      cpu_info.bAVX = false;
+      const TestJit64::Function sse = jit->Compile(instruction.jit, inst, fregs_in, preload);
+      cpu_info.bAVX = avx;
+      const TestJit64::Function function = jit->Compile(instruction.jit, inst, fregs_in, preload);
+
+      for (int i = 0; i < ITERATIONS; ++i)
+      {
+        u64 inputs[32][2];
+        for (auto& ps : inputs)
+        {
+          ps[0] = RandomValue();
+          ps[1] = RandomValue();
+        }
+
+        std::memcpy(PowerPC::ppcState.ps, inputs, sizeof(inputs));
+        PowerPC::ppcState.fpscr = 0;
+        instruction.interpreter(inst);
+        u64 expected[32][2];
+        std::memcpy(expected, PowerPC::ppcState.ps, sizeof(expected));
+
+        std::memcpy(PowerPC::ppcState.ps, inputs, sizeof(inputs));
+        sse();
+        u64 expected_sse[32][2];
+        std::memcpy(expected_sse, PowerPC::ppcState.ps, sizeof(expected_sse));
+
+        std::memcpy(PowerPC::ppcState.ps, inputs, sizeof(inputs));
+        function();
+
+        if (avx && !Compare(instruction, layout, inputs, expected_sse, true, "SSE"))
+          return;
+
+        // With accurate NaNs, HandleNaNs takes NaNs from the same slot of the result and the
+        // inputs. That is wrong for ps_sum and ps_muls, which mix slots, and SNaNs are not
+        // quieted, so only the AVX code is checked against the SSE code in that mode.
+        if (accurate_nans)
+          continue;
+        if (!Compare(instruction, layout, inputs, expected, false, "the interpreter"))
+          return;
+      }
+    }
+  }
+
+  void RunAll()
+  {
+    for (const Instruction& instruction : INSTRUCTIONS)
+    {
+      for (bool accurate_nans : {false, true})
+      {
+        for (bool preload : {false, true})
+        {
+          SCOPED_TRACE(testing::Message() << instruction.name << " accurate_nans=" << accurate_nans
+                                          << " preload=" << preload);
+          RunInstruction(instruction, accurate_nans, preload);
+        }
+      }
+    }
+  }
+
+  std::string m_profile_path;
+  CPUInfo m_saved_cpu_info;
+  std::mt19937 m_rng{0x1234};
+};
+
+TEST_F(Jit64FloatingPointTest, SSE)
+{
+  cpu_info.bAVX = false;
+  RunAll();
+}
+
+TEST_F(Jit64FloatingPointTest, AVX)
+{
+  if (!cpu_info.bAVX)
+    return;
+  RunAll();
+}
@@ -0,0 +1,155 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/ImageWrite.h"
+
+namespace
+{
+u32 ReadBigEndian32(const u8* data)
+{
+  return static_cast<u32>(data[0]) << 24 | static_cast<u32>(data[1]) << 16 |
+         static_cast<u32>(data[2]) << 8 | data[3];
+}
+
+// A straightforward decoder written from the specification, always producing RGBA8.
+bool DecodeQoi(const std::vector<u8>& in, int* width, int* height, int* channels,
+               std::vector<u8>* out)
+{
+  if (in.size() < 14 + 8 || in[0] != 'q' || in[1] != 'o' || in[2] != 'i' || in[3] != 'f')
+    return false;
+  *width = static_cast<int>(ReadBigEndian32(&in[4]));
+  *height = static_cast<int>(ReadBigEndian32(&in[8]));
+  *channels = in[12];
+
+  std::array<std::array<u8, 4>, 64> index{};
+  std::array<u8, 4> pixel{{0, 0, 0, 255}};
+  const size_t pixel_count = static_cast<size_t>(*width) * *height;
+  const size_t end = in.size() - 8;
+  size_t pos = 14;
+  int run = 0;
+
+  out->clear();
+  for (size_t i = 0; i < pixel_count; ++i)
+  {
+    if (run > 0)
+    {
+      --run;
+    }
+    else
+    {
+      if (pos >= end)
+        return false;
+      const u8 op = in[pos++];
+      if (op == 0xfe)
+      {
+        pixel = {{in[pos], in[pos + 1], in[pos + 2], pixel[3]}};
+        pos += 3;
+      }
+      else if (op == 0xff)
+      {
+        pixel = {{in[pos], in[pos + 1], in[pos + 2], in[pos + 3]}};
+        pos += 4;
+      }
+      else if ((op & 0xc0) == 0x00)
+      {
+        pixel = index[op];
+      }
+      else if ((op & 0xc0) == 0x40)
+      {
+        pixel[0] += ((op >> 4) & 3) - 2;
+        pixel[1] += ((op >> 2) & 3) - 2;
+        pixel[2] += (op & 3) - 2;
+      }
+      else if ((op & 0xc0) == 0x80)
+      {
+        const int dg = (op & 0x3f) - 32;
+        const u8 next = in[pos++];
+        pixel[0] += dg - 8 + (next >> 4);
+        pixel[1] += dg;
+        pixel[2] += dg - 8 + (next & 0xf);
+      }
+      else
+      {
+        run = op & 0x3f;
+      }
+    }
+
+    index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64] = pixel;
+    out->insert(out->end(), pixel.begin(), pixel.end());
+  }
+
+  const std::vector<u8> end_marker{0, 0, 0, 0, 0, 0, 0, 1};
+  return pos == end && std::equal(end_marker.begin(), end_marker.end(), in.begin() + end);
+}
+
+// Runs, repeated colours, small and large differences, and alpha changes.
+std::vector<u8> MakeTestImage(int width, int height)
+{
+  std::vector<u8> image(static_cast<size_t>(width) * height * 4);
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      u8* pixel = &image[(y * width + x) * 4];
+      if (y % 4 == 0)
+      {
+        pixel[0] = pixel[1] = pixel[2] = 0x40;
+        pixel[3] = 0xff;
+      }
+      else
+      {
+        pixel[0] = static_cast<u8>(x * (y + 1));
+        pixel[1] = static_cast<u8>(x + y * 3);
+        pixel[2] = static_cast<u8>((x * 37) ^ (y * 11));
+        pixel[3] = static_cast<u8>(x % 8 == 0 ? 0x80 : 0xff);
+      }
+    }
+  }
+  return image;
+}
+}  // Anonymous namespace
+
+TEST(ImageWrite, QoiRoundTripsWithAlpha)
+{
+  const int width = 97, height = 23;
+  const std::vector<u8> image = MakeTestImage(width, height);
+
+  const std::vector<u8> encoded = EncodeQoi(image.data(), width * 4, width, height, true);
+  int decoded_width, decoded_height, channels;
+  std::vector<u8> decoded;
+  ASSERT_TRUE(DecodeQoi(encoded, &decoded_width, &decoded_height, &channels, &decoded));
+  EXPECT_EQ(width, decoded_width);
+  EXPECT_EQ(height, decoded_height);
+  EXPECT_EQ(4, channels);
+  EXPECT_EQ(image, decoded);
+}
+
+TEST(ImageWrite, QoiDropsAlphaAndHonoursStride)
+{
+  const int width = 64, height = 70;
+  const int stride = width * 4 + 12;
+  const std::vector<u8> image = MakeTestImage(width, height);
+  std::vector<u8> padded(static_cast<size_t>(stride) * height, 0xcc);
+  for (int y = 0; y < height; ++y)
+    std::copy_n(&image[y * width * 4], width * 4, &padded[y * stride]);
+
+  const std::vector<u8> encoded = EncodeQoi(padded.data(), stride, width, height, false);
+  int decoded_width, decoded_height, channels;
+  std::vector<u8> decoded;
+  ASSERT_TRUE(DecodeQoi(encoded, &decoded_width, &decoded_height, &channels, &decoded));
+  EXPECT_EQ(3, channels);
+
+  std::vector<u8> expected = image;
+  for (size_t i = 3; i < expected.size(); i += 4)
+    expected[i] = 0xff;
+  EXPECT_EQ(expected, decoded);
+}